@@ -0,0 +1,78 @@
+/**
+ * @file encryptor_bench.cpp
+ * @brief Micro-benchmark for the Encryptor FFT codec
+ *
+ * Reports encrypted and decrypted blocks per second for a payload that spans
+ * many N-sized blocks, which is the shape Saver::save and Saver::load see for
+ * large repository snapshots. Every butterfly ISA the CPU supports is measured,
+ * for both the complex and the real-input transform. A block is always N input
+ * values, so the rates of the two transforms compare directly.
+ *
+ * Usage: encryptor_bench [blocks] [rounds] [threads]
+ */
+
+#include "fvm/encryptor.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+
+int main(int argc, char** argv) {
+    int blocks = argc > 1 ? std::atoi(argv[1]) : 512;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 1;
+
+    const int block_size = Encryptor::N;
+
+    // Leave room for the length header stored in the first block
+    std::vector<int> input(static_cast<size_t>(blocks) * block_size - 1);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<int>((i * 17 + 43) % 256);
+    }
+
+    const struct {
+        Encryptor::Transform transform;
+        const char* name;
+    } transforms[] = {{Encryptor::Transform::COMPLEX, "complex"},
+                      {Encryptor::Transform::REAL, "real"}};
+    const fvm::fft::Isa isas[] = {fvm::fft::Isa::SCALAR, fvm::fft::Isa::SSE2,
+                                  fvm::fft::Isa::AVX2, fvm::fft::Isa::AVX512};
+
+    for (const auto& t : transforms) {
+        Encryptor encryptor(t.transform);
+        encryptor.set_thread_count(threads);
+        std::printf("transform=%s blocks=%d block_size=%d threads=%zu\n", t.name, blocks,
+                    block_size, encryptor.get_thread_count());
+
+        for (fvm::fft::Isa isa : isas) {
+            if (!encryptor.set_isa(isa)) continue;
+
+            std::vector<std::pair<double, double>> encrypted;
+            std::vector<int> decrypted;
+            double best_enc = 0, best_dec = 0;
+
+            for (int r = 0; r < rounds; r++) {
+                auto t0 = std::chrono::steady_clock::now();
+                encryptor.encrypt_sequence(input, encrypted);
+                auto t1 = std::chrono::steady_clock::now();
+                encryptor.decrypt_sequence(encrypted, decrypted);
+                auto t2 = std::chrono::steady_clock::now();
+
+                double enc = blocks / std::chrono::duration<double>(t1 - t0).count();
+                double dec = blocks / std::chrono::duration<double>(t2 - t1).count();
+                if (enc > best_enc) best_enc = enc;
+                if (dec > best_dec) best_dec = dec;
+            }
+
+            if (decrypted != input) {
+                std::fprintf(stderr, "%s/%s: round trip mismatch\n", t.name, fvm::fft::isa_name(isa));
+                return 1;
+            }
+
+            std::printf("%-7s encrypt: %.0f blocks/sec  decrypt: %.0f blocks/sec  stored pairs: %zu\n",
+                        fvm::fft::isa_name(isa), best_enc, best_dec, encrypted.size());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file hash_bench.cpp
+ * @brief Micro-benchmark for the record hashers
+ *
+ * Reports GB/s of the legacy polynomial hash and of XXH3 for several payload
+ * sizes, both over raw bytes and over the one-byte-per-int sequences that
+ * Saver::save and Saver::load hash for every record. Rates are input bytes
+ * per second, i.e. one element of an integer sequence counts as one byte.
+ *
+ * Usage: hash_bench [max_bytes] [rounds]
+ */
+
+#include "fvm/hasher.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <class Input>
+double measure(const fvm::interfaces::IHasher& hasher, const Input& input, size_t bytes, int rounds,
+               unsigned long long& sink) {
+    // Repeat small inputs so every sample covers at least 64 MB
+    const size_t repeat = bytes < (64u << 20) ? (64u << 20) / bytes : 1;
+    double best = 0;
+    for (int r = 0; r < rounds; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repeat; i++) {
+            sink += hasher.hash(input);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double rate = bytes * repeat / std::chrono::duration<double>(t1 - t0).count() / 1e9;
+        if (rate > best) best = rate;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t max_bytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (16u << 20);
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    const fvm::PolynomialHasher polynomial;
+    const fvm::Xxh3Hasher xxh3;
+    unsigned long long sink = 0;
+
+    std::printf("%10s %14s %14s %14s %14s\n", "bytes", "poly bytes", "xxh3 bytes", "poly ints", "xxh3 ints");
+    for (size_t bytes = 64; bytes <= max_bytes; bytes *= 16) {
+        std::string text(bytes, '\0');
+        std::vector<int> sequence(bytes);
+        for (size_t i = 0; i < bytes; i++) {
+            text[i] = static_cast<char>((i * 17 + 43) % 256);
+            sequence[i] = static_cast<int>((i * 17 + 43) % 256);
+        }
+
+        std::printf("%10zu %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s\n", bytes,
+                    measure(polynomial, text, bytes, rounds, sink),
+                    measure(xxh3, text, bytes, rounds, sink),
+                    measure(polynomial, sequence, bytes, rounds, sink),
+                    measure(xxh3, sequence, bytes, rounds, sink));
+    }
+    return sink == 42 ? 1 : 0;  // Keep the results observable
+}
@@ -0,0 +1,63 @@
+#ifndef FVM_BYTE_ORDER_H
+#define FVM_BYTE_ORDER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace fvm {
+
+/**
+ * @brief
+ * Little-endian encoding of the integers and floating-point values in the
+ * binary WAL and data files, whatever the host byte order.
+ */
+inline void put_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+inline void put_u64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+inline uint32_t get_u32(const char* p) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    return value;
+}
+
+inline uint64_t get_u64(const char* p) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    return value;
+}
+
+inline void put_double(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u64(out, bits);
+}
+
+inline void put_float(std::string& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u32(out, bits);
+}
+
+inline double get_double(const char* p) {
+    uint64_t bits = get_u64(p);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline float get_float(const char* p) {
+    uint32_t bits = get_u32(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace fvm
+
+#endif // FVM_BYTE_ORDER_H
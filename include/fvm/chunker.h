@@ -0,0 +1,59 @@
+#ifndef FVM_CHUNKER_H
+#define FVM_CHUNKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fvm {
+
+/**
+ * @brief Content-defined chunking (FastCDC)
+ *
+ * Cuts data where a gear rolling hash over the last 64 bytes matches a mask, so the
+ * boundaries follow the content rather than the offsets: an edit only changes the
+ * chunks around it, and the chunks after it are found again unchanged.
+ *
+ * Normalized chunking is used: a stricter mask before the average size and a looser
+ * one after it keep chunk sizes close to the average. Chunks are at least a quarter
+ * and at most eight times the average size, except for the last one.
+ */
+class Chunker {
+public:
+    static constexpr size_t DEFAULT_AVERAGE = 8192;
+    static constexpr size_t MIN_AVERAGE = 64;
+    static constexpr size_t MAX_AVERAGE = 1 << 22;
+
+    /**
+     * @param average Target chunk size, rounded down to a power of two within
+     *                [MIN_AVERAGE, MAX_AVERAGE]
+     */
+    explicit Chunker(size_t average = DEFAULT_AVERAGE);
+
+    /**
+     * @brief Length of the chunk that starts at data
+     * @param size Bytes left in the input; the result is never larger
+     */
+    size_t cut(const char* data, size_t size) const;
+
+    /**
+     * @brief Lengths of the chunks data is split into, in order; none for empty data
+     */
+    std::vector<size_t> split(const std::string& data) const;
+
+    size_t get_average() const { return average_; }
+    size_t get_min() const { return min_; }
+    size_t get_max() const { return max_; }
+
+private:
+    size_t average_;
+    size_t min_;
+    size_t max_;
+    uint64_t mask_small_;  // Before the average size: harder to match
+    uint64_t mask_large_;  // After it: easier to match
+};
+
+} // namespace fvm
+
+#endif // FVM_CHUNKER_H
@@ -0,0 +1,22 @@
+#ifndef FVM_CRC32C_H
+#define FVM_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fvm {
+
+/**
+ * @brief CRC-32C (Castagnoli) checksum, as used by iSCSI, ext4 and LevelDB
+ *
+ * Uses the SSE4.2 crc32 instruction when the CPU has it and a table-driven
+ * slicing-by-8 loop otherwise; both give the same result.
+ *
+ * @param crc Checksum of the preceding bytes, to extend it over data; 0 to start
+ * @return crc32c("123456789") == 0xE3069283
+ */
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+} // namespace fvm
+
+#endif // FVM_CRC32C_H
@@ -2,37 +2,67 @@
 #define FVM_DATA_SERIALIZER_H
 
 #include "fvm/interfaces/IDataSerializer.h"
-#include "fvm/saver_constants.h"
-#include <sstream>
+#include "fvm/record_view.h"
+#include "fvm/hasher.h"
 
 namespace fvm {
 
 /**
- * @brief Optimized data serializer using stringstream for efficiency
+ * @brief Data serializer with a compact binary wire format
  *
- * Improvements over original Saver implementation:
- * - Single-pass serialization using stringstream (O(n) instead of O(n²))
- * - Move semantics to reduce copies
- * - Pre-allocation of vectors
+ * Binary format (version 1):
+ *     0xF5 version block_num [data_num [data_len data_bytes]...]...
+ * where every count and length is an unsigned LEB128 varint and the data
+ * bytes are raw. The leading 0xF5 never starts the legacy text format below,
+ * which is how the two are told apart.
+ *
+ * Legacy text format, still accepted by deserialize:
+ *     block_num [data_num [data_len data_string]...]...
+ * with decimal numbers separated by spaces.
+ *
+ * Both the byte and the integer sequence APIs produce the same format; the
+ * integer form holds one byte per element, as the encryptors consume it.
  */
 class DataSerializer : public interfaces::IDataSerializer {
 public:
-    // Serialize vvs to integer sequence (optimized - no string copies)
+    static constexpr uint8_t BINARY_MAGIC = 0xF5;
+    static constexpr uint8_t BINARY_VERSION = 1;
+
+    // Serialize vvs to integer sequence (one byte per element)
     bool serialize(const interfaces::vvs& content, std::vector<int>& sequence) override;
+    bool serialize(const interfaces::vvs& content, std::vector<uint8_t>& bytes) override;
 
-    // Deserialize integer sequence back to vvs
+    // Deserialize either format back to vvs
     bool deserialize(const std::vector<int>& sequence, interfaces::vvs& content) override;
+    bool deserialize(const uint8_t* data, size_t size, interfaces::vvs& content) override;
+
+    // Deserialize either format into cells that share one buffer
+    bool deserialize(const std::vector<int>& sequence, RecordView& view) override;
 
-    // Calculate hash using standard polynomial rolling hash
+    // Calculate hash with the configured hasher (XXH3 unless set otherwise)
     unsigned long long calculate_hash(const std::vector<int>& data) override;
     unsigned long long calculate_hash(const std::string& data) override;
+    unsigned get_hash_version() const override { return hasher_->get_version(); }
+
+    // Choose the hasher; it must outlive the serializer
+    void set_hasher(const interfaces::IHasher& hasher) { hasher_ = &hasher; }
 
 private:
-    // Helper: Parse integer from string (removes parsed portion)
-    int parse_int(std::string& s);
+    // Helper: Exact size of the binary encoding, so output is allocated once
+    static size_t binary_size(const interfaces::vvs& content);
+
+    // Helper: Append the binary encoding to a byte or integer sequence
+    template <class Sequence>
+    static void write_binary(const interfaces::vvs& content, Sequence& out);
+
+    // Helpers: Parse each format from a byte or integer sequence, handing
+    // rows and cells to a sink that either copies or views them
+    template <class T, class Sink>
+    static bool read_binary(const T* data, size_t size, Sink& sink);
+    template <class T, class Sink>
+    static bool read_legacy(const T* data, size_t size, Sink& sink);
 
-    // Hash seed constant
-    static constexpr unsigned long long HASH_SEED = DEFAULT_HASH_SEED;
+    const interfaces::IHasher* hasher_ = &default_hasher();
 };
 
 } // namespace fvm
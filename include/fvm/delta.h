@@ -0,0 +1,29 @@
+#ifndef FVM_DELTA_H
+#define FVM_DELTA_H
+
+#include <string>
+
+namespace fvm {
+namespace delta {
+
+/**
+ * @brief
+ * Binary diff of target against base, in the style of xdelta: a sequence of copies
+ * from base and literal insertions.
+ *
+ * Blocks of base are indexed by hash and looked up with a rolling hash at every
+ * offset of target, so moved and repeated text is found as well as edits in place.
+ * The delta records the sizes and the CRC-32C of target, which decode() verifies.
+ */
+std::string encode(const std::string& base, const std::string& target);
+
+/**
+ * @brief Rebuild the target a delta was encoded from
+ * @return false if the delta is malformed or was not made against this base
+ */
+bool decode(const std::string& base, const std::string& delta, std::string& target);
+
+} // namespace delta
+} // namespace fvm
+
+#endif // FVM_DELTA_H
@@ -2,6 +2,11 @@
 #define FVM_ENCRYPTOR_H
 
 #include "fvm/interfaces/IEncryptor.h"
+#include "fvm/fft_kernels.h"
+#include "fvm/thread_pool.h"
+#include "fvm/record_format.h"
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include <utility>
 
@@ -30,6 +35,20 @@ struct Complex {
  * representation.
  * This process is also called discrete Fourier transform, and we accelerate this process
  * through FFT.
+ *
+ * Blocks are kept as separate real and imaginary arrays so the butterflies can be
+ * vectorized. The widest SIMD kernel the CPU supports is picked at construction; every
+ * kernel produces bit-identical output, so the choice never changes what is stored.
+ *
+ * Blocks are transformed independently, so a sequence can be spread over several
+ * threads (see set_thread_count). Each thread works on its own scratch block and writes
+ * straight into the pre-sized result, so the output does not depend on the thread count.
+ *
+ * The input is real, so its spectrum is Hermitian-symmetric and half of it is redundant.
+ * In Transform::REAL mode a block holds 2N values: they are packed pairwise into one
+ * N-point complex FFT, and the result is unpacked into spectrum bins 0 .. N, which are
+ * all that is stored. This does half the work and takes half the space per value of
+ * Transform::COMPLEX, which stores the full N-point spectrum of N values.
  */
 class Encryptor : public fvm::interfaces::IEncryptor {
 
@@ -41,10 +60,51 @@ public:
      */
     static const int N = 1 << 10;
 
+    /**
+     * @brief
+     * How input values are mapped onto the transform. Each mode has its own format tag,
+     * since their outputs are not interchangeable.
+     */
+    enum class Transform {
+        COMPLEX,  // N values per block, full spectrum stored (fvm::CODEC_FFT)
+        REAL      // 2N values per block, half spectrum stored (fvm::CODEC_FFT_REAL)
+    };
+
+    explicit Encryptor(Transform transform = Transform::COMPLEX);
+
+    Transform get_transform() const { return transform_; }
+
+    /**
+     * @brief
+     * Force the instruction set used by the butterflies, e.g. to compare kernels.
+     *
+     * @return false
+     * The running CPU does not support the given ISA; the current one is kept.
+     */
+    bool set_isa(fvm::fft::Isa isa);
+    fvm::fft::Isa get_isa() const { return isa_; }
+
+    /**
+     * @brief
+     * Set how many threads encrypt_sequence and decrypt_sequence, and their byte forms,
+     * may use.
+     * 1 (the default) keeps all work on the calling thread.
+     */
+    void set_thread_count(size_t threads);
+    size_t get_thread_count() const { return pool_ ? pool_->size() : 1; }
+
     // Implement IEncryptor interface
     bool encrypt_sequence(const std::vector<int> &sequence, std::vector<std::pair<double, double>> &res) override;
-    bool decrypt_sequence(std::vector<std::pair<double, double>> &sequence, std::vector<int> &res) override;
+    bool decrypt_sequence(const std::vector<std::pair<double, double>> &sequence, std::vector<int> &res) override;
+    bool encrypt_bytes(const std::string &bytes, std::vector<std::pair<double, double>> &res) override;
+    bool decrypt_bytes(const std::vector<std::pair<double, double>> &sequence, std::vector<uint8_t> &res) override;
     int get_block_size() const override { return N; }
+    unsigned get_format_tag() const override {
+        return transform_ == Transform::REAL ? fvm::CODEC_FFT_REAL : fvm::CODEC_FFT;
+    }
+
+    class Encoder;
+    class Decoder;
 
 private:
     /**
@@ -58,54 +118,312 @@ private:
 
     /**
      * @brief
-     * The buf array is used as a buffer for the FFT function.
+     * Precomputed tables for the fixed N-point transform.
+     *
+     * Everything the FFT needs that depends only on N is computed once here instead
+     * of on every call: the bit-reversal permutation and, for each radix-4 stage, the
+     * three twiddle factors w^j, w^2j, w^3j of every butterfly, laid out so that a
+     * stage walks its table linearly.
      *
-     * This block array is suitable for storing the data you want to encrypt.
+     * The stage whose sub-transforms have length q keeps its twiddles at offset q - 1,
+     * as three runs of q values (w^j, then w^2j, then w^3j), so the tables of all
+     * stages together occupy N - 1 entries.
+     *
+     * real_re and real_im hold e^(i*pi*k/N), the twiddles that split the packed
+     * transform of Transform::REAL into the spectrum of the 2N real values.
+     */
+    struct FftPlan {
+        int rev[N];
+        double twiddle_re[2][N];  // [0] forward transform, [1] inverse transform
+        double twiddle_im[2][N];
+        double real_re[N];
+        double real_im[N];
+
+        FftPlan();
+    };
+
+    /**
+     * @brief
+     * Get the plan shared by all Encryptor instances. It is built on first use.
+     */
+    static const FftPlan& plan();
+
+    /**
+     * @brief
+     * Minimum number of blocks handed to one thread. Smaller sequences are not worth
+     * the hand-off and stay on the calling thread.
+     */
+    static const size_t BLOCKS_PER_TASK = 4;
+
+    /**
+     * @brief
+     * This block is suitable for storing the data you want to encrypt, with the real
+     * parts in re and the imaginary parts in im. Points are written to their
+     * bit-reversed positions (FftPlan::rev) as the block is filled, which saves the
+     * FFT a separate permutation pass.
      * An encryption sequence may be very long, but here it will be split into small
      * data blocks, each of which has a length of N, and then this data block is spliced
      * together to form the encrypted sequence.
+     *
+     * Blocks are scratch space owned by the thread transforming them, which keeps
+     * Encryptor reentrant.
+     */
+    struct Block {
+        alignas(64) double re[N];
+        alignas(64) double im[N];
+    };
+
+    Transform transform_;
+
+    /**
+     * @brief
+     * The instruction set and the matching radix-4 stage kernel.
      */
-    Complex buf[N], block[N];
+    fvm::fft::Isa isa_;
+    fvm::fft::StageKernel stage_;
 
     /**
      * @brief
-     * This function performs discrete Fourier transform on the sequence in array a.
-     *
-     * @param a
-     * The sequence you want to encrypt is stored in this array.
+     * Workers for block-parallel transforms; null when running single-threaded.
+     */
+    std::unique_ptr<fvm::ThreadPool> pool_;
+
+    /**
+     * @brief
+     * This function performs discrete Fourier transform on the N points in re and im.
+     * It is an in-place radix-4 decimation-in-time FFT driven by plan(). The input
+     * must already be in bit-reversed order; the output is in natural order.
      *
-     * @param n
-     * The current length to be encrypted.
+     * @param re, im
+     * The sequence you want to encrypt is stored in these arrays.
      *
      * @param type
      * The value here can only be 1 or -1.
      * 1 represents forward transform, -1 represents inverse transform.
      */
-    void fft(Complex a[], int n, int type);
+    void fft(double re[], double im[], int type) const;
+
+    /**
+     * @brief
+     * Number of stream values carried by one block of N pairs.
+     */
+    size_t values_per_block() const { return transform_ == Transform::REAL ? 2 * N : N; }
+
+    /**
+     * @brief
+     * Put value i of a block into scratch, at the position the transform reads it from.
+     */
+    void set_value(Block &scratch, size_t i, double value) const;
 
     /**
      * @brief
-     * Encrypt the sequence stored in the block.
+     * Transform a block filled by set_value and save its N encrypted pairs in res.
+     * scratch is clobbered.
+     */
+    void transform_block(Block &scratch, std::pair<double, double> *res) const;
+
+    /**
+     * @brief
+     * Encrypt one block of the sequence.
+     * Block b holds the values_per_block() elements starting at position
+     * b*values_per_block() in the stream made of the sequence length followed by the
+     * sequence itself and PLACEHOLDER padding.
+     *
+     * @param values, length
+     * The whole sequence being encrypted, of int or byte values.
+     *
+     * @param index
+     * The number of the block to encrypt.
+     *
+     * @param scratch
+     * Work space for the transform.
      *
      * @param res
-     * Save the encrypted sequence in this array.
+     * Save the N encrypted pairs of the block here.
+     */
+    template <typename T>
+    void encrypt_block(const T *values, size_t length, size_t index, Block &scratch,
+                       std::pair<double, double> *res) const;
+
+    /**
+     * @brief
+     * Encrypt a whole sequence, its blocks spread over the thread pool.
+     */
+    template <typename T>
+    void encrypt_values(const T *values, size_t length, std::vector<std::pair<double, double>> &res) const;
+
+    /**
+     * @brief
+     * Decrypt a whole sequence, its blocks spread over the thread pool.
      *
-     * @return true
-     * Encryption is successful.
+     * @return false
+     * The data is not a whole number of blocks, or its length header does not fit it.
      */
-    bool encrypt_block(std::vector<std::pair<double, double>> &res);
+    template <typename T>
+    bool decrypt_values(const std::vector<std::pair<double, double>> &sequence, std::vector<T> &res) const;
 
     /**
      * @brief
-     * Decrypt the sequence stored in the block.
+     * Decrypt one block. The decrypted values are left in scratch, still to be
+     * read with copy_values.
      *
-     * @param res
-     * The decrypted sequence will be stored in this array.
+     * @param data
+     * The N encrypted pairs of the block.
      *
-     * @return true
-     * The decryption is successful.
+     * @param scratch
+     * Work space for the transform, which also receives the result.
      */
-    bool decrypt_block(std::vector<int> &res);
+    void decrypt_block(const std::pair<double, double> *data, Block &scratch) const;
+
+    /**
+     * @brief
+     * Round the values first .. first+count-1 of a decrypted block to integers and
+     * store them in out. In Transform::COMPLEX mode value i is scratch.re[i]; in
+     * Transform::REAL mode values 2n and 2n+1 are scratch.re[n] and scratch.im[n].
+     */
+    template <typename T>
+    void copy_values(const Block &scratch, size_t first, size_t count, T *out) const;
+
+    /**
+     * @brief
+     * Round a value produced by the inverse transform back to the integer it encodes.
+     */
+    static int round_value(double value);
+
+    /**
+     * @brief
+     * Run body(begin, end) over the block range [0, blocks), on the thread pool when
+     * one is configured.
+     */
+    void for_each_block_range(size_t blocks, const std::function<void(size_t, size_t)> &body) const;
+};
+
+/**
+ * @brief
+ * Incremental form of Encryptor::encrypt_sequence, for input that is produced or read
+ * in pieces. Values are pushed straight into a single block of scratch space and each
+ * completed block is transformed into a buffer supplied by the caller, so nothing
+ * proportional to the input is ever allocated.
+ *
+ * The length header leads the encrypted stream, so the number of values must be known
+ * up front. The pulled blocks, concatenated, equal what encrypt_sequence produces for
+ * the same values.
+ *
+ * Usage:
+ *     while (!encoder.done()) {
+ *         data += encoder.push(data, end - data);
+ *         if (encoder.ready()) {
+ *             encoder.pull(out);
+ *             out += Encryptor::N;
+ *         }
+ *     }
+ */
+class Encryptor::Encoder {
+public:
+    /**
+     * @param length
+     * The total number of values that will be pushed.
+     */
+    Encoder(const Encryptor &encryptor, size_t length);
+
+    /**
+     * @brief
+     * Take values until the current block is full or all announced values are in.
+     *
+     * @return
+     * The number of values consumed, possibly 0 when a block is waiting to be pulled.
+     */
+    size_t push(const int *data, size_t count);
+
+    /**
+     * @brief
+     * Whether a block can be pulled: it is full, or it is the last one.
+     */
+    bool ready() const;
+
+    /**
+     * @brief
+     * Encrypt the pending block into out, which must hold Encryptor::N pairs.
+     *
+     * @return false
+     * No block is ready.
+     */
+    bool pull(std::pair<double, double> *out);
+
+    /**
+     * @brief
+     * Number of blocks the whole sequence encrypts to.
+     */
+    size_t blocks() const { return blocks_; }
+
+    bool done() const { return emitted_ == blocks_; }
+
+private:
+    const Encryptor &encryptor_;
+    size_t length_;
+    size_t blocks_;
+    size_t fill_;     // Values already in the pending block
+    size_t emitted_;  // Blocks already pulled
+    Block scratch_;
+};
+
+/**
+ * @brief
+ * Incremental form of Encryptor::decrypt_sequence. Encrypted blocks are pushed one at
+ * a time and their values are pulled into a buffer supplied by the caller; only the
+ * block being read is held in memory.
+ *
+ * Usage:
+ *     Encryptor::Decoder decoder(encryptor, data.size() / Encryptor::N);
+ *     while (!decoder.done() && decoder.push(block)) {
+ *         out += decoder.pull(out, capacity);
+ *         block += Encryptor::N;
+ *     }
+ */
+class Encryptor::Decoder {
+public:
+    /**
+     * @param blocks
+     * The number of encrypted blocks there are to push. A length header claiming more
+     * values than they can hold is rejected as corrupted.
+     */
+    Decoder(const Encryptor &encryptor, size_t blocks);
+
+    /**
+     * @brief
+     * Decrypt the next block of N pairs.
+     *
+     * @return false
+     * The values of the previous block have not all been pulled, the sequence is already
+     * complete, or the length header is corrupted or larger than the blocks can hold.
+     */
+    bool push(const std::pair<double, double> *block);
+
+    /**
+     * @brief
+     * Copy up to capacity values of the current block into out.
+     *
+     * @return
+     * The number of values copied; 0 once the current block is drained.
+     */
+    size_t pull(int *out, size_t capacity);
+
+    /**
+     * @brief
+     * Length of the sequence, known once the first block has been pushed, -1 before.
+     */
+    long long length() const { return length_; }
+
+    bool done() const { return length_ >= 0 && delivered_ == static_cast<size_t>(length_); }
+
+private:
+    const Encryptor &encryptor_;
+    size_t blocks_;
+    long long length_;
+    size_t delivered_;  // Values already pulled
+    size_t next_;       // Next value of the current block to pull
+    size_t end_;        // End of the values of the current block
+    Block scratch_;
 };
 
 #endif // FVM_ENCRYPTOR_H
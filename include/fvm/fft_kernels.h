@@ -0,0 +1,61 @@
+#ifndef FVM_FFT_KERNELS_H
+#define FVM_FFT_KERNELS_H
+
+namespace fvm {
+namespace fft {
+
+/**
+ * @brief
+ * Instruction sets a radix-4 stage kernel can be built for.
+ * SCALAR is portable C++; the others exist only on x86 and are chosen at runtime.
+ */
+enum class Isa {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief
+ * One radix-4 decimation-in-time pass over a structure-of-arrays block.
+ *
+ * The block of n points is split into groups of length 4q. Inside a group the four
+ * quarters hold the sub-transforms of the inputs congruent to 0, 2, 1, 3 (mod 4),
+ * which is the order left behind by a bit-reversal permutation.
+ *
+ * @param re, im Real and imaginary parts of the block, transformed in place
+ * @param n Number of points in the block
+ * @param q Length of each sub-transform combined by this pass
+ * @param wr, wi Twiddles of this pass: w^j, w^2j, w^3j for j in [0, q), each run of q
+ * @param type 1 for the forward transform, -1 for the inverse transform
+ */
+using StageKernel = void (*)(double* re, double* im, int n, int q,
+                             const double* wr, const double* wi, int type);
+
+/**
+ * @brief
+ * Every kernel performs the same floating-point operations in the same order as
+ * the scalar one, so all of them produce bit-identical results.
+ */
+StageKernel get_stage_kernel(Isa isa);
+
+/**
+ * @brief Check whether the running CPU can execute kernels for the given ISA
+ */
+bool is_supported(Isa isa);
+
+/**
+ * @brief Pick the widest ISA supported by the running CPU
+ */
+Isa detect_isa();
+
+/**
+ * @brief Human readable name of an ISA, for logs and benchmarks
+ */
+const char* isa_name(Isa isa);
+
+} // namespace fft
+} // namespace fvm
+
+#endif // FVM_FFT_KERNELS_H
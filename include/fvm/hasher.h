@@ -0,0 +1,56 @@
+#ifndef FVM_HASHER_H
+#define FVM_HASHER_H
+
+#include "fvm/interfaces/IHasher.h"
+#include "fvm/record_format.h"
+
+namespace fvm {
+
+/**
+ * @brief The original rolling hash, hash = hash * 13331 + value
+ *
+ * Kept so records and names hashed before HASH_XXH3 existed still verify and
+ * resolve. Each step depends on the previous one, so it runs at about one
+ * byte per multiply latency.
+ */
+class PolynomialHasher : public interfaces::IHasher {
+public:
+    using IHasher::hash;
+
+    unsigned get_version() const override { return HASH_POLYNOMIAL; }
+    unsigned long long hash(const uint8_t* data, size_t size) const override;
+    unsigned long long hash(const std::vector<int>& data) const override;
+};
+
+/**
+ * @brief XXH3-64 with the default secret and seed 0
+ *
+ * Bit-compatible with XXH3_64bits() of the reference xxHash library. Inputs
+ * above 240 bytes are consumed in 64-byte stripes by eight independent 64-bit
+ * lanes, which the SSE2 and AVX2 kernels run two and four at a time; the
+ * widest one the CPU supports is picked at runtime.
+ */
+class Xxh3Hasher : public interfaces::IHasher {
+public:
+    using IHasher::hash;
+
+    unsigned get_version() const override { return HASH_XXH3; }
+    unsigned long long hash(const uint8_t* data, size_t size) const override;
+    unsigned long long hash(const std::vector<int>& data) const override;
+};
+
+/**
+ * @brief Shared hasher for a hash version
+ *
+ * @return nullptr if the version is unknown
+ */
+const interfaces::IHasher* get_hasher(unsigned version);
+
+/**
+ * @brief Shared hasher used for newly written records
+ */
+const interfaces::IHasher& default_hasher();
+
+} // namespace fvm
+
+#endif // FVM_HASHER_H
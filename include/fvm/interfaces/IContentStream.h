@@ -0,0 +1,55 @@
+#ifndef FVM_INTERFACES_ICONTENTSTREAM_H
+#define FVM_INTERFACES_ICONTENTSTREAM_H
+
+#include <cstddef>
+#include <memory>
+
+namespace fvm {
+namespace interfaces {
+
+/**
+ * @brief
+ * Random access to the content of a file without holding all of it in memory.
+ * The content a reader was opened on stays readable until the reader is destroyed,
+ * even if the file is updated or removed meanwhile.
+ *
+ * Only small files may be held whole: FileManager rebuilds a file stored as a delta
+ * when the reader is opened, and keeps deltas to files of at most
+ * FileManager::MAX_DELTA_CONTENT bytes.
+ */
+class IContentReader {
+public:
+    virtual ~IContentReader() = default;
+
+    virtual size_t size() const = 0;
+
+    /**
+     * @brief Copy up to length bytes starting at offset, like pread()
+     * @return The number of bytes copied, 0 at or past the end or on a read error
+     */
+    virtual size_t read_at(size_t offset, char* buffer, size_t length) = 0;
+};
+
+/**
+ * @brief
+ * Builds a new content piece by piece. Nothing changes until commit(); a writer
+ * destroyed without committing drops what was written.
+ */
+class IContentWriter {
+public:
+    virtual ~IContentWriter() = default;
+
+    // Append to the content being written
+    virtual bool write(const char* data, size_t length) = 0;
+
+    /**
+     * @brief Store the content written so far; the writer cannot be used afterwards
+     * @param id Set to what the content is stored under: a file id, a node index
+     */
+    virtual bool commit(unsigned long long& id) = 0;
+};
+
+} // namespace interfaces
+} // namespace fvm
+
+#endif // FVM_INTERFACES_ICONTENTSTREAM_H
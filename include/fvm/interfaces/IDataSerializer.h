@@ -1,10 +1,15 @@
 #ifndef FVM_INTERFACES_IDATASERIALIZER_H
 #define FVM_INTERFACES_IDATASERIALIZER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace fvm {
+
+class RecordView;
+
 namespace interfaces {
 
 // Forward declaration for vvs type used in ISaver
@@ -36,6 +41,31 @@ public:
      */
     virtual bool deserialize(const std::vector<int>& sequence, vvs& content) = 0;
 
+    /**
+     * @brief Serialize vvs content to bytes
+     * @param content The content to serialize
+     * @param bytes Output serialized bytes
+     * @return true if successful
+     */
+    virtual bool serialize(const vvs& content, std::vector<uint8_t>& bytes) = 0;
+
+    /**
+     * @brief Deserialize bytes back to vvs
+     * @param data Start of the serialized bytes
+     * @param size Number of bytes
+     * @param content Output deserialized content
+     * @return true if successful
+     */
+    virtual bool deserialize(const uint8_t* data, size_t size, vvs& content) = 0;
+
+    /**
+     * @brief Deserialize integer sequence into a view without per-cell allocations
+     * @param sequence The serialized sequence
+     * @param view Output cells, backed by a copy of the sequence owned by the view
+     * @return true if successful; view is left empty otherwise
+     */
+    virtual bool deserialize(const std::vector<int>& sequence, RecordView& view) = 0;
+
     /**
      * @brief Calculate hash of serialized data for integrity verification
      * @param data The data to hash
@@ -49,6 +79,11 @@ public:
      * @return Hash value
      */
     virtual unsigned long long calculate_hash(const std::string& data) = 0;
+
+    /**
+     * @brief Version of the hash calculate_hash computes, see record_format.h
+     */
+    virtual unsigned get_hash_version() const = 0;
 };
 
 } // namespace interfaces
@@ -1,6 +1,8 @@
 #ifndef FVM_INTERFACES_IENCRYPTOR_H
 #define FVM_INTERFACES_IENCRYPTOR_H
 
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <utility>
 
@@ -34,7 +36,31 @@ public:
      * @param res The decrypted integer sequence
      * @return true if decryption succeeded, false otherwise
      */
-    virtual bool decrypt_sequence(std::vector<std::pair<double, double>> &sequence, std::vector<int> &res) = 0;
+    virtual bool decrypt_sequence(const std::vector<std::pair<double, double>> &sequence, std::vector<int> &res) = 0;
+
+    /**
+     * @brief
+     * Encrypt bytes as the sequence of their values, giving what encrypt_sequence gives
+     * for those values. The default widens them into a sequence first; an encryptor
+     * that can read them in place overrides it.
+     */
+    virtual bool encrypt_bytes(const std::string &bytes, std::vector<std::pair<double, double>> &res) {
+        std::vector<int> sequence(reinterpret_cast<const uint8_t *>(bytes.data()),
+                                  reinterpret_cast<const uint8_t *>(bytes.data()) + bytes.size());
+        return encrypt_sequence(sequence, res);
+    }
+
+    /**
+     * @brief
+     * Decrypt a sequence of byte values, each value truncated to a byte. The default
+     * decrypts into a sequence of integers first.
+     */
+    virtual bool decrypt_bytes(const std::vector<std::pair<double, double>> &sequence, std::vector<uint8_t> &res) {
+        std::vector<int> values;
+        if (!decrypt_sequence(sequence, values)) return false;
+        res.assign(values.begin(), values.end());
+        return true;
+    }
 
     /**
      * @brief
@@ -44,6 +70,15 @@ public:
      * @return The block size (N)
      */
     virtual int get_block_size() const = 0;
+
+    /**
+     * @brief
+     * Get the tag identifying this codec in stored records (see fvm/record_format.h).
+     * Records are decrypted by the codec whose tag they carry.
+     *
+     * @return The codec tag
+     */
+    virtual unsigned get_format_tag() const = 0;
 };
 
 } // namespace interfaces
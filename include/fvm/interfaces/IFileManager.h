@@ -1,6 +1,8 @@
 #ifndef FVM_INTERFACES_IFILEMANAGER_H
 #define FVM_INTERFACES_IFILEMANAGER_H
 
+#include "fvm/interfaces/IContentStream.h"
+#include <memory>
 #include <string>
 
 namespace fvm {
@@ -16,6 +18,10 @@ public:
     virtual bool update_content(unsigned long long fid, unsigned long long& new_id, const std::string& content) = 0;
     virtual bool get_content(unsigned long long fid, std::string& content) = 0;
     virtual bool file_exist(unsigned long long fid) = 0;
+
+    // Streaming access; nullptr if the file does not exist. A committed writer gives a new file
+    virtual std::unique_ptr<IContentReader> open_reader(unsigned long long fid) = 0;
+    virtual std::unique_ptr<IContentWriter> open_writer() = 0;
 };
 
 } // namespace interfaces
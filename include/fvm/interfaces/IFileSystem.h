@@ -1,6 +1,8 @@
 #ifndef FVM_INTERFACES_IFILESYSTEM_H
 #define FVM_INTERFACES_IFILESYSTEM_H
 
+#include "fvm/interfaces/IContentStream.h"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -27,6 +29,9 @@ public:
     virtual bool remove_file(const std::string& name) = 0;
     virtual bool update_content(const std::string& name, const std::string& content) = 0;
     virtual bool get_content(const std::string& name, std::string& content) = 0;
+    // Streaming access for large files; nullptr if name is not a file
+    virtual std::unique_ptr<IContentReader> open_reader(const std::string& name) = 0;
+    virtual std::unique_ptr<IContentWriter> open_writer(const std::string& name) = 0;
 
     // Directory operations
     virtual bool make_dir(const std::string& name) = 0;
@@ -0,0 +1,48 @@
+#ifndef FVM_INTERFACES_IHASHER_H
+#define FVM_INTERFACES_IHASHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fvm {
+namespace interfaces {
+
+/**
+ * @brief
+ * Interface for the 64-bit hash used for record names and integrity checks.
+ *
+ * Every implementation has a version number that is stored with the records
+ * it hashed (see record_format.h), so a record keeps verifying with the
+ * function it was written with after the default changes.
+ */
+class IHasher {
+public:
+    virtual ~IHasher() = default;
+
+    /**
+     * @brief Hash version identifier, one of the HASH_* constants in record_format.h
+     */
+    virtual unsigned get_version() const = 0;
+
+    /**
+     * @brief Hash a byte string
+     */
+    virtual unsigned long long hash(const uint8_t* data, size_t size) const = 0;
+
+    /**
+     * @brief Hash an integer sequence holding one byte per element, as the
+     * serializer produces it; equals hash() of the same bytes.
+     */
+    virtual unsigned long long hash(const std::vector<int>& data) const = 0;
+
+    unsigned long long hash(const std::string& data) const {
+        return hash(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+};
+
+} // namespace interfaces
+} // namespace fvm
+
+#endif // FVM_INTERFACES_IHASHER_H
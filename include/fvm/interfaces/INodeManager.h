@@ -1,6 +1,8 @@
 #ifndef FVM_INTERFACES_INODEMANAGER_H
 #define FVM_INTERFACES_INODEMANAGER_H
 
+#include "fvm/interfaces/IContentStream.h"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -32,6 +34,11 @@ public:
     virtual std::string get_create_time(unsigned long long idx) = 0;
     virtual void increase_counter(unsigned long long idx) = 0;
     virtual unsigned long long _get_counter(unsigned long long idx) = 0;
+
+    // Streaming access; nullptr if the node does not exist. Committing a writer works
+    // like update_content() and gives the index of the new node
+    virtual std::unique_ptr<IContentReader> open_reader(unsigned long long idx) = 0;
+    virtual std::unique_ptr<IContentWriter> open_writer(unsigned long long idx) = 0;
 };
 
 } // namespace interfaces
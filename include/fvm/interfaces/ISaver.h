@@ -2,10 +2,14 @@
 #define FVM_INTERFACES_ISAVER_H
 
 #include "IStringUtilities.h"
+#include "IWalManager.h"
 #include <string>
 #include <vector>
 
 namespace fvm {
+
+class RecordView;
+
 namespace interfaces {
 
 // Forward declaration
@@ -13,6 +17,15 @@ class IFileOperations;
 
 using vvs = std::vector<std::vector<std::string>>;
 
+// Counters of the cache of loaded records
+struct LoadCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;  // Records held now
+    size_t bytes = 0;    // Their estimated size
+};
+
 class ISaver : public IStringUtilities {
 public:
     virtual ~ISaver() = default;
@@ -27,14 +40,23 @@ public:
     // Primary save/load interface
     virtual bool save(const std::string& name, vvs& content) = 0;
     virtual bool load(const std::string& name, vvs& content, bool mandatory_access = false) = 0;
+    // Same as load, but cells are views into one buffer owned by the RecordView
+    virtual bool load(const std::string& name, RecordView& view, bool mandatory_access = false) = 0;
+    virtual bool remove(const std::string& name) = 0;  // false if nothing is stored under name
 
     // WAL control methods
-    virtual bool flush() = 0;
-    virtual bool compact() = 0;
+    virtual bool flush() = 0;  // Make every saved entry durable, whatever the sync policy
+    virtual bool set_wal_sync_policy(WalSyncPolicy policy, unsigned interval_ms = 0) = 0;
+    virtual bool checkpoint() = 0;  // Persist changed records and retire the WAL segments they cover
+    virtual bool compact() = 0;     // Same, rewriting the whole data file
     virtual size_t get_wal_size() const = 0;
     virtual bool set_auto_compact(size_t threshold) = 0;
     virtual bool set_wal_enabled(bool enabled) = 0;
 
+    // Keep recently loaded records deserialized, up to about this many bytes; 0 turns it off
+    virtual void set_load_cache_capacity(size_t bytes) = 0;
+    virtual LoadCacheStats get_load_cache_stats() const = 0;
+
     // Configuration getters
     virtual std::string get_data_file() const = 0;
     virtual std::string get_wal_file() const = 0;
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <functional>
 #include <vector>
 #include <utility>
 
@@ -16,14 +18,28 @@ struct DataNode {
     unsigned long long name_hash;
     unsigned long long data_hash;
     int len;
+    unsigned format;  // Record format word, see record_format.h
     std::vector<std::pair<double, double>> data;
 
-    DataNode() : name_hash(0), data_hash(0), len(0) {}
+    // RECORD_FLOAT32 records held by a storage manager: the blocks flagged in
+    // float_blocks are kept in data32, the others in data. Nodes handed out by
+    // retrieve() and for_each() always carry the whole record in data.
+    std::vector<std::pair<float, float>> data32;
+    std::vector<bool> float_blocks;
+
+    DataNode() : name_hash(0), data_hash(0), len(0), format(0) {}
     DataNode(unsigned long long nh, unsigned long long dh,
-             std::vector<std::pair<double, double>> d, int l)
-        : name_hash(nh), data_hash(dh), len(l), data(std::move(d)) {}
+             std::vector<std::pair<double, double>> d, int l, unsigned f = 0)
+        : name_hash(nh), data_hash(dh), len(l), format(f), data(std::move(d)) {}
 };
 
+/**
+ * @brief Shared read-only handle to a stored record
+ *
+ * Stays valid, and unchanged, after the record is replaced or removed.
+ */
+using DataHandle = std::shared_ptr<const DataNode>;
+
 /**
  * @brief Interface for data storage management
  *
@@ -40,11 +56,19 @@ public:
      * @param data_hash Hash of the data content
      * @param data Encrypted data
      * @param len Data length
+     * @param format Record format word describing how data was encoded
      */
     virtual void store(unsigned long long name_hash,
                       unsigned long long data_hash,
                       const std::vector<std::pair<double, double>>& data,
-                      int len) = 0;
+                      int len,
+                      unsigned format = 0) = 0;
+
+    /**
+     * @brief Store a record, taking over its data instead of copying it
+     * @param node Record to store, keyed by its name_hash
+     */
+    virtual void store(DataNode&& node) = 0;
 
     /**
      * @brief Retrieve data from memory
@@ -54,6 +78,13 @@ public:
      */
     virtual bool retrieve(unsigned long long name_hash, DataNode& node) const = 0;
 
+    /**
+     * @brief Retrieve a record without copying it
+     * @param name_hash Hash of the data name
+     * @return Handle to the record, or nullptr if not found
+     */
+    virtual DataHandle retrieve(unsigned long long name_hash) const = 0;
+
     /**
      * @brief Check if data exists
      * @param name_hash Hash of the data name
@@ -77,12 +108,36 @@ public:
     virtual bool load_from_file(const std::string& filename, int block_size) = 0;
 
     /**
-     * @brief Save all data to file
+     * @brief Save all data to file, replacing it
      * @param filename File to save to
      * @return true if successful
      */
     virtual bool save_to_file(const std::string& filename) = 0;
 
+    /**
+     * @brief Persist the records changed since the last checkpoint
+     *
+     * Appends only the changed records to the data file, and rewrites the whole
+     * file instead when superseded records dominate it. The checkpoint is on
+     * stable storage when this returns true.
+     *
+     * @param filename Data file to checkpoint to
+     * @param position Recorded with the checkpoint; the first WAL segment it does not cover
+     * @param full Rewrite the whole file regardless
+     * @return true if successful
+     */
+    virtual bool checkpoint(const std::string& filename, unsigned long long position, bool full = false) = 0;
+
+    /**
+     * @brief Position recorded by the last checkpoint loaded or written, 0 if none
+     */
+    virtual unsigned long long get_checkpoint_position() const = 0;
+
+    /**
+     * @brief Number of records stored or removed since the last checkpoint
+     */
+    virtual size_t get_dirty_count() const = 0;
+
     /**
      * @brief Clear all in-memory data
      */
@@ -93,6 +148,16 @@ public:
      * @return Map of all stored data
      */
     virtual std::map<unsigned long long, DataNode> get_all_data() const = 0;
+
+    /**
+     * @brief Visit every record in name hash order, one at a time
+     *
+     * Unlike get_all_data, never holds more than one record beyond what is stored.
+     * The visitor must not modify the storage manager.
+     *
+     * @param visitor Called once per record
+     */
+    virtual void for_each(const std::function<void(const DataNode&)>& visitor) const = 0;
 };
 
 } // namespace interfaces
@@ -1,6 +1,7 @@
 #ifndef FVM_INTERFACES_IWALMANAGER_H
 #define FVM_INTERFACES_IWALMANAGER_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <functional>
@@ -18,6 +19,17 @@ enum class WalOperation {
     DELETE
 };
 
+/**
+ * @brief When appended WAL entries are forced to stable storage
+ */
+enum class WalSyncPolicy {
+    NONE,        // Left to the OS; survives a process crash, not a power loss
+    PER_COMMIT,  // fdatasync after every group commit, before append_entry returns
+    INTERVAL     // fdatasync once the last one is older than the configured interval.
+                 // Only the writer thread (start_writer()) syncs on a timer; without it the
+                 // interval is checked on the next append, so an idle log may stay unsynced
+};
+
 /**
  * @brief WAL entry structure
  */
@@ -26,15 +38,17 @@ struct WalEntry {
     unsigned long long name_hash;
     unsigned long long data_hash;
     int len;
+    unsigned format;  // Record format word, see record_format.h
     std::vector<std::pair<double, double>> data;
 
-    WalEntry() : op(WalOperation::INSERT), name_hash(0), data_hash(0), len(0) {}
+    WalEntry() : op(WalOperation::INSERT), name_hash(0), data_hash(0), len(0), format(0) {}
 };
 
 /**
  * @brief Interface for Write-Ahead Log management
  *
- * Handles incremental persistence with automatic compaction.
+ * Handles incremental persistence. The log is a series of numbered segment
+ * files; segments are retired once a checkpoint of the data file covers them.
  * Separates WAL concerns from main storage logic.
  */
 class IWalManager {
@@ -50,13 +64,17 @@ public:
 
     /**
      * @brief Load and replay WAL entries
-     * @param replay_callback Function to call for each entry
+     *
+     * Entries fully replace or remove what is stored under their name, so only
+     * the last entry of each name is passed on, in log order.
+     *
+     * @param replay_callback Function to call for each surviving entry
      * @return true if successful
      */
     virtual bool load_and_replay(std::function<void(const WalEntry&)> replay_callback) = 0;
 
     /**
-     * @brief Clear the WAL file
+     * @brief Delete every logged entry, keeping an empty segment to append to
      * @return true if successful
      */
     virtual bool clear() = 0;
@@ -90,6 +108,73 @@ public:
      * @return Current threshold
      */
     virtual size_t get_auto_compact_threshold() const = 0;
+
+    /**
+     * @brief Write out buffered entries and force them to stable storage
+     * @return true if every appended entry is durable
+     */
+    virtual bool sync() = 0;
+
+    /**
+     * @brief Choose when appends are forced to stable storage
+     * @param policy The durability policy
+     * @param interval_ms Longest time between syncs under WalSyncPolicy::INTERVAL,
+     *                    held to only while the writer thread runs
+     */
+    virtual void set_sync_policy(WalSyncPolicy policy, unsigned interval_ms = 0) = 0;
+    virtual WalSyncPolicy get_sync_policy() const = 0;
+
+    /**
+     * @brief Start a new WAL segment for the entries appended from now on
+     *
+     * Entries appended before the call are all in segments numbered below the
+     * returned one. Nothing changes if the current segment is still empty.
+     *
+     * @return Number of the segment now being appended to
+     */
+    virtual uint64_t roll_segment() = 0;
+
+    /**
+     * @brief Delete the segments numbered below before, once a checkpoint covers them
+     * @param before First segment to keep; the current segment is always kept
+     * @return true if successful
+     */
+    virtual bool retire_segments(uint64_t before) = 0;
+
+    /**
+     * @brief Set the size at which the WAL rolls to a new segment on its own
+     * @param bytes Segment size in bytes
+     */
+    virtual void set_segment_size(size_t bytes) = 0;
+    virtual size_t get_segment_size() const = 0;
+
+    /**
+     * @brief Start a background thread that writes submitted entries
+     * @return true if the writer is running
+     */
+    virtual bool start_writer() = 0;
+
+    /**
+     * @brief Write out everything submitted so far and stop the background thread
+     */
+    virtual void stop_writer() = 0;
+
+    /**
+     * @brief Queue an entry for the background writer without waiting for the disk
+     *
+     * Without a running writer the entry is appended synchronously.
+     *
+     * @param entry The entry to write
+     * @return Sequence number to pass to wait(), 0 if there is nothing to wait for
+     */
+    virtual uint64_t submit(const WalEntry& entry) = 0;
+
+    /**
+     * @brief Block until the entry with sequence number seq is on stable storage
+     * @param seq A value returned by submit()
+     * @return true if that entry and every one submitted before it are durable
+     */
+    virtual bool wait(uint64_t seq) = 0;
 };
 
 } // namespace interfaces
@@ -0,0 +1,88 @@
+#ifndef FVM_LOAD_CACHE_H
+#define FVM_LOAD_CACHE_H
+
+#include "fvm/interfaces/ISaver.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fvm {
+
+/**
+ * @brief Bounded LRU cache of deserialized records
+ *
+ * Holds at most one entry per name hash, tagged with the data hash of the record it
+ * was decoded from, so an entry for an older version of a record never hits. Entries
+ * are evicted least recently used first once their estimated size exceeds the
+ * capacity. Safe to use from several threads.
+ */
+class LoadCache {
+public:
+    using Value = std::shared_ptr<const interfaces::vvs>;
+
+    /**
+     * @param capacity_bytes Size budget of the entries; 0 keeps nothing
+     */
+    explicit LoadCache(size_t capacity_bytes = 0);
+
+    /**
+     * @brief Change the size budget, evicting entries that no longer fit
+     */
+    void set_capacity(size_t bytes);
+    size_t get_capacity() const;
+
+    /**
+     * @brief Look up the record stored under name_hash, if it still has data_hash
+     * @return The cached record, or nullptr on a miss
+     */
+    Value get(unsigned long long name_hash, unsigned long long data_hash);
+
+    /**
+     * @brief Cache a record, replacing any entry for the same name
+     *
+     * Records larger than the whole capacity are not kept.
+     */
+    void put(unsigned long long name_hash, unsigned long long data_hash, Value value);
+
+    /**
+     * @brief Drop the entry for a name, e.g. when the record is saved or removed
+     */
+    void invalidate(unsigned long long name_hash);
+
+    void clear();
+
+    interfaces::LoadCacheStats get_stats() const;
+
+    /**
+     * @brief Estimated heap footprint of a record, as counted against the capacity
+     */
+    static size_t footprint(const interfaces::vvs& value);
+
+private:
+    struct Entry {
+        unsigned long long name_hash;
+        unsigned long long data_hash;
+        Value value;
+        size_t bytes;
+    };
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // Most recently used first
+    std::unordered_map<unsigned long long, std::list<Entry>::iterator> index_;
+    size_t capacity_;
+    size_t bytes_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t evictions_ = 0;
+
+    // Drop an entry, or the least recently used ones until the rest fits
+    void erase_locked(std::list<Entry>::iterator it);
+    void evict_locked();
+};
+
+} // namespace fvm
+
+#endif // FVM_LOAD_CACHE_H
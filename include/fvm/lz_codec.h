@@ -0,0 +1,32 @@
+#ifndef FVM_LZ_CODEC_H
+#define FVM_LZ_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fvm {
+namespace lz {
+
+/**
+ * @brief
+ * Fast LZ77 block compression in the style of LZ4: runs of literals and copies of
+ * at least 4 bytes from the last 64 KiB, found through a hash table of 4-byte
+ * sequences. The block starts with the size of the data it decompresses to.
+ *
+ * Gives up as soon as the output stops being smaller than the input, so
+ * incompressible data costs little more than one pass over it.
+ *
+ * @return false if the data does not compress; out is unspecified then
+ */
+bool compress(const uint8_t* data, size_t size, std::string& out);
+
+/**
+ * @return false if the block is malformed
+ */
+bool decompress(const uint8_t* data, size_t size, std::string& out);
+
+} // namespace lz
+} // namespace fvm
+
+#endif // FVM_LZ_CODEC_H
@@ -0,0 +1,113 @@
+#ifndef FVM_MPSC_RING_H
+#define FVM_MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace fvm {
+
+/**
+ * @brief Bounded lock-free queue for many producers and one consumer
+ *
+ * Each slot carries a turn counter (Vyukov's bounded queue): producers claim a
+ * position with a CAS on the head and publish the slot by advancing its turn;
+ * the consumer takes slots strictly in position order. The position a push
+ * claimed therefore doubles as the element's sequence number, and everything
+ * before a popped element has been popped too.
+ *
+ * try_pop, empty and popped may only be called from the consumer thread;
+ * pushed may be called from any thread.
+ */
+template <class T>
+class MpscRing {
+public:
+    /**
+     * @param capacity Number of slots, rounded up to a power of two
+     */
+    explicit MpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots_.reset(new Slot[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            slots_[i].turn.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief Enqueue value unless the ring is full
+     * @param position Set to the position claimed, counting pushes from 0
+     * @return false if the ring is full; value is left untouched then
+     */
+    bool try_push(T& value, uint64_t& position) {
+        uint64_t pos = head_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            uint64_t turn = slot->turn.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(turn - pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // The consumer has not freed this slot yet
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->turn.store(pos + 1, std::memory_order_release);
+        position = pos;
+        return true;
+    }
+
+    /**
+     * @brief Dequeue the next element in position order
+     * @return false if it is not published yet (or nothing was pushed)
+     */
+    bool try_pop(T& value) {
+        Slot& slot = slots_[tail_ & mask_];
+        if (slot.turn.load(std::memory_order_acquire) != tail_ + 1) return false;
+        value = std::move(slot.value);
+        slot.turn.store(tail_ + mask_ + 1, std::memory_order_release);
+        tail_++;
+        return true;
+    }
+
+    /**
+     * @brief True if no position beyond the popped ones has been claimed
+     */
+    bool empty() const { return head_.load(std::memory_order_seq_cst) == tail_; }
+
+    /**
+     * @brief Number of positions claimed so far; the last may not be published yet
+     */
+    uint64_t pushed() const { return head_.load(std::memory_order_seq_cst); }
+
+    /**
+     * @brief Number of elements popped so far, i.e. the next position to pop
+     */
+    uint64_t popped() const { return tail_; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> turn;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<uint64_t> head_{0};  // Next position to claim
+    alignas(64) uint64_t tail_ = 0;              // Next position to pop, consumer only
+};
+
+} // namespace fvm
+
+#endif // FVM_MPSC_RING_H
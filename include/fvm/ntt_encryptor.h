@@ -0,0 +1,69 @@
+#ifndef FVM_NTT_ENCRYPTOR_H
+#define FVM_NTT_ENCRYPTOR_H
+
+#include "fvm/interfaces/IEncryptor.h"
+#include "fvm/record_format.h"
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+namespace fvm {
+
+/**
+ * @brief Exact integer codec based on a number-theoretic transform
+ *
+ * Works like Encryptor, but over the integers modulo P = 998244353 instead of the
+ * complex numbers, so a round trip is exact and needs no rounding step.
+ *
+ * A block transforms M = 2N values. The resulting coefficients are below 2^30,
+ * so they are exactly representable as doubles, and they are packed two per pair:
+ * a block occupies N pairs like an Encryptor block while carrying twice as many
+ * values, which halves the stored size per input value.
+ *
+ * The stream layout matches Encryptor: the sequence length comes first, followed
+ * by the sequence and zero padding. Values are decoded from their residues into
+ * [-MAX_VALUE, MAX_VALUE]; encrypt_sequence() fails on anything outside it, and on
+ * sequences of P values or more, rather than store what would not decode back.
+ */
+class NttEncryptor : public interfaces::IEncryptor {
+public:
+    static constexpr int N = 1 << 10;               // Pairs per block, same as Encryptor::N
+    static constexpr int M = 2 * N;                 // Values transformed per block
+    static constexpr uint32_t P = 998244353;        // 119 * 2^23 + 1, so M divides P - 1
+    static constexpr uint32_t G = 3;                // Primitive root modulo P
+    static constexpr int MAX_VALUE = P / 2;         // Largest magnitude that survives a round trip
+
+    bool encrypt_sequence(const std::vector<int>& sequence, std::vector<std::pair<double, double>>& res) override;
+    bool decrypt_sequence(const std::vector<std::pair<double, double>>& sequence, std::vector<int>& res) override;
+    int get_block_size() const override { return N; }
+    unsigned get_format_tag() const override { return CODEC_NTT; }
+
+private:
+    /**
+     * @brief Bit-reversal permutation and roots of unity for the M-point transform
+     *
+     * roots[dir][h + j] holds w^j for the butterfly stage combining halves of length h,
+     * where w is a primitive 2h-th root of unity (inverted for dir = 1).
+     */
+    struct Plan {
+        uint32_t rev[M];
+        uint32_t roots[2][M];
+        uint32_t inv_m;
+
+        Plan();
+    };
+
+    static const Plan& plan();
+
+    static uint32_t pow_mod(uint64_t base, uint64_t exp);
+
+    /**
+     * @brief In-place transform of M values
+     * @param type 1 for the forward transform, -1 for the inverse transform
+     */
+    static void ntt(uint32_t a[], int type);
+};
+
+} // namespace fvm
+
+#endif // FVM_NTT_ENCRYPTOR_H
@@ -0,0 +1,39 @@
+#ifndef FVM_PRECISION_H
+#define FVM_PRECISION_H
+
+#include <utility>
+
+namespace fvm {
+
+/**
+ * @brief Largest error the float32 narrowing may add to any decoded value
+ *
+ * Decoders round their output to the nearest integer, and Encryptor treats
+ * negative values further than 1e-2 from an integer specially, so the bound
+ * stays well inside that.
+ */
+constexpr double FLOAT32_ERROR_BOUND = 1e-3;
+
+/**
+ * @brief Check whether a block survives being stored as float32 pairs
+ *
+ * The check is a proven bound, not a trial decode. Each inverse transform
+ * output is a weighted sum of the block's coefficients with weights of
+ * magnitude at most 1/N (FFT) or 2/N (real-input FFT, whose half spectrum is
+ * split first). The narrowing error, summed over the coefficients and weighted
+ * that way, must stay below FLOAT32_ERROR_BOUND. NTT coefficients are exact
+ * residues, so they must be exact floats.
+ *
+ * Values already narrowed once have no narrowing error, so a block that passed
+ * still passes after a round trip through float32. Text written with float
+ * max_digits10 narrows back to the same floats.
+ *
+ * @param block The block_size pairs of one block
+ * @param block_size Pairs per block of the codec
+ * @param format Record format word, selects the codec's bound
+ */
+bool fits_float32(const std::pair<double, double>* block, int block_size, unsigned format);
+
+} // namespace fvm
+
+#endif // FVM_PRECISION_H
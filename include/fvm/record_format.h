@@ -0,0 +1,53 @@
+#ifndef FVM_RECORD_FORMAT_H
+#define FVM_RECORD_FORMAT_H
+
+namespace fvm {
+
+/**
+ * @brief Per-record format word
+ *
+ * Every stored record carries a format word describing how its payload was
+ * produced, so records written under different configurations can share one
+ * store and each is decoded the way it was encoded. Records written before the
+ * word existed read back as 0, which is the original FFT codec.
+ *
+ * The low byte identifies the codec (the IEncryptor implementation); the bits
+ * above it are flags.
+ */
+constexpr unsigned RECORD_CODEC_MASK = 0xffu;
+
+// Codec identifiers, see IEncryptor::get_format_tag()
+constexpr unsigned CODEC_FFT = 0;  // Encryptor: complex FFT, one input value per pair
+constexpr unsigned CODEC_NTT = 1;  // NttEncryptor: exact number-theoretic transform
+constexpr unsigned CODEC_FFT_REAL = 2;  // Encryptor, real-input transform: two input values per pair
+
+// Some blocks of the record are held as float32 pairs, see precision.h
+constexpr unsigned RECORD_FLOAT32 = 1u << 8;
+
+// Bits 9-11: version of the hash the record's data_hash was computed with
+constexpr unsigned RECORD_HASH_SHIFT = 9;
+constexpr unsigned RECORD_HASH_MASK = 0x7u << RECORD_HASH_SHIFT;
+
+// Hash versions, see hasher.h
+constexpr unsigned HASH_POLYNOMIAL = 0;  // Rolling hash * 13331 + value, used before versioning
+constexpr unsigned HASH_XXH3 = 1;        // XXH3-64
+
+// Bits 12-15: compression of the serialized record before it was encrypted
+constexpr unsigned RECORD_COMPRESSION_SHIFT = 12;
+constexpr unsigned RECORD_COMPRESSION_MASK = 0xfu << RECORD_COMPRESSION_SHIFT;
+
+// Compression identifiers
+constexpr unsigned COMPRESSION_NONE = 0;  // Stored as serialized, also for data that did not compress
+constexpr unsigned COMPRESSION_LZ = 1;    // lz_codec.h
+
+constexpr unsigned record_codec(unsigned format) { return format & RECORD_CODEC_MASK; }
+constexpr unsigned record_hash_version(unsigned format) {
+    return (format & RECORD_HASH_MASK) >> RECORD_HASH_SHIFT;
+}
+constexpr unsigned record_compression(unsigned format) {
+    return (format & RECORD_COMPRESSION_MASK) >> RECORD_COMPRESSION_SHIFT;
+}
+
+} // namespace fvm
+
+#endif // FVM_RECORD_FORMAT_H
@@ -0,0 +1,96 @@
+#ifndef FVM_RECORD_VIEW_H
+#define FVM_RECORD_VIEW_H
+
+#include <climits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fvm {
+
+/**
+ * @brief Read-only table of deserialized cells that share one buffer
+ *
+ * The vvs form of a record allocates a string per cell and a vector per row.
+ * A RecordView holds the serialized bytes once and exposes every cell as a
+ * std::string_view into them, so deserializing a record costs a handful of
+ * allocations however many cells it has.
+ *
+ * Views stay valid until the RecordView is cleared, refilled or destroyed.
+ */
+class RecordView {
+public:
+    /**
+     * @brief One row of cells, in the shape of a vvs inner vector
+     */
+    class Row {
+    public:
+        Row(const std::string_view* cells, size_t size) : cells_(cells), size_(size) {}
+
+        size_t size() const { return size_; }
+        std::string_view operator[](size_t i) const { return cells_[i]; }
+        const std::string_view* begin() const { return cells_; }
+        const std::string_view* end() const { return cells_ + size_; }
+
+    private:
+        const std::string_view* cells_;
+        size_t size_;
+    };
+
+    size_t size() const { return row_begin_.size(); }
+    bool empty() const { return row_begin_.empty(); }
+
+    Row operator[](size_t i) const {
+        size_t end = i + 1 < row_begin_.size() ? row_begin_[i + 1] : cells_.size();
+        return Row(cells_.data() + row_begin_[i], end - row_begin_[i]);
+    }
+
+    void clear() {
+        buffer_.clear();
+        cells_.clear();
+        row_begin_.clear();
+    }
+
+    /**
+     * @brief Copy the cells out into owning strings
+     */
+    std::vector<std::vector<std::string>> to_vvs() const {
+        std::vector<std::vector<std::string>> res(size());
+        for (size_t i = 0; i < res.size(); i++) {
+            Row row = (*this)[i];
+            res[i].assign(row.begin(), row.end());
+        }
+        return res;
+    }
+
+private:
+    friend class DataSerializer;
+
+    std::string buffer_;                  // Serialized bytes the cells point into
+    std::vector<std::string_view> cells_;  // All cells, row after row
+    std::vector<size_t> row_begin_;        // Index in cells_ of each row's first cell
+};
+
+/**
+ * @brief Parse a cell that must hold a decimal number
+ *
+ * Accepts the same cells as ISaver::is_all_digits and yields the value of
+ * ISaver::str_to_ull (0 on overflow), without needing a std::string.
+ *
+ * @return false if the cell contains anything but digits
+ */
+inline bool parse_ull(std::string_view s, unsigned long long& value) {
+    value = 0;
+    bool overflow = false;
+    for (char ch : s) {
+        if (ch < '0' || ch > '9') return false;
+        if (value > ULLONG_MAX / 10) overflow = true;
+        value = value * 10 + (ch - '0');
+    }
+    if (overflow) value = 0;
+    return true;
+}
+
+} // namespace fvm
+
+#endif // FVM_RECORD_VIEW_H
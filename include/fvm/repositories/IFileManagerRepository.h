@@ -5,18 +5,65 @@
 #include <string>
 #include <vector>
 
-// Forward declaration - fileNode is defined in file_manager.cpp
-// This works because implementation files include file_manager.cpp
-struct fileNode;
-
 namespace fvm {
 namespace repositories {
 
+/**
+ * @brief How a single file is stored
+ *
+ * Either the chunks of its content, or the chunks of a delta (see delta.h) against
+ * the content of another file, its base.
+ */
+struct FileRecord {
+    std::vector<unsigned long long> chunks;
+    bool delta = false;
+    unsigned long long base = 0;
+    unsigned depth = 0;  // Deltas applied to rebuild the content, 0 for a full revision
+};
+
+/**
+ * @brief Index entry of a chunk
+ */
+struct ChunkInfo {
+    static constexpr unsigned long long UNKNOWN_SIZE = ~0ULL;  // Indexes written before sizes were recorded
+
+    unsigned long long refs = 0;  // Occurrences in the chunk lists of files
+    unsigned long long size = UNKNOWN_SIZE;
+};
+
+/**
+ * @brief Persistence of FileManager, one record per file and per chunk
+ *
+ * A file is stored as the list of its chunk ids and a chunk as its bytes, each under
+ * its own key, so a change to one file never rewrites the others. The indexes hold
+ * the reference counts of every file and every chunk and are small. Neither a file's
+ * chunk list nor a chunk's bytes change once saved: new content gets a new id.
+ */
 class IFileManagerRepository {
 public:
     virtual ~IFileManagerRepository() = default;
-    virtual bool save(const std::map<unsigned long long, fileNode>& data) = 0;
-    virtual bool load(std::map<unsigned long long, fileNode>& data) = 0;
+
+    // Reference counts of every file, keyed by file id
+    virtual bool load_index(std::map<unsigned long long, unsigned long long>& counters) = 0;
+    virtual bool save_index(const std::map<unsigned long long, unsigned long long>& counters) = 0;
+
+    // Chunk list of a single file
+    virtual bool load_file(unsigned long long fid, FileRecord& file) = 0;
+    virtual bool save_file(unsigned long long fid, const FileRecord& file) = 0;
+    virtual bool remove_file(unsigned long long fid) = 0;
+
+    // References to and size of every chunk, keyed by chunk id
+    virtual bool load_chunk_index(std::map<unsigned long long, ChunkInfo>& chunks) = 0;
+    virtual bool save_chunk_index(const std::map<unsigned long long, ChunkInfo>& chunks) = 0;
+
+    // Bytes of a single chunk
+    virtual bool load_chunk(unsigned long long cid, std::string& data) = 0;
+    virtual bool save_chunk(unsigned long long cid, const std::string& data) = 0;
+    virtual bool remove_chunk(unsigned long long cid) = 0;
+
+    // Whole content of a file saved before contents were chunked; rewritten as chunks on read
+    virtual bool load_content(unsigned long long fid, std::string& content) = 0;
+    virtual bool remove_content(unsigned long long fid) = 0;
 };
 
 } // namespace repositories
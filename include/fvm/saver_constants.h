@@ -8,6 +8,7 @@ constexpr unsigned long long DEFAULT_HASH_SEED = 13331;
 
 // WAL configuration
 constexpr size_t DEFAULT_WAL_COMPACT_THRESHOLD = 100;
+constexpr size_t DEFAULT_WAL_SEGMENT_SIZE = 64 << 20;  // Bytes before the WAL rolls to a new segment
 
 // Default filenames
 constexpr char DEFAULT_DATA_FILE[] = "data.chm";
@@ -4,8 +4,15 @@
 #include "fvm/interfaces/IStorageManager.h"
 #include "fvm/interfaces/IFileOperations.h"
 #include "fvm/interfaces/ILogger.h"
+#include <ostream>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <atomic>
 
 namespace fvm {
 
@@ -16,6 +23,28 @@ namespace fvm {
  * - Cleaner separation of storage concerns
  * - Better error handling and logging
  * - Optimized file I/O with pre-allocation
+ *
+ * The data file is binary: a header, then sections. Each section holds record
+ * payloads, an index of fixed-size entries sorted by name hash (offset, size, CRC32C
+ * and metadata of each payload) and a footer. The first section is the base written
+ * by a full rewrite; every checkpoint appends one with the records changed since the
+ * previous one plus an entry per removal, and its footer names the first WAL segment
+ * it does not cover. Loading maps the file and reads only the indexes, newest entry
+ * per name winning; records are decoded the first time they are asked for. An
+ * unfinished checkpoint after the last valid footer is ignored, since the WAL
+ * segments it came from are only retired once the footer is on disk.
+ *
+ * Files in the older text format (one record per line, "~name_hash" removals and
+ * "#position" markers) are still read, in full, and rewritten as binary by the next
+ * checkpoint.
+ *
+ * Records can be stored, retrieved and removed from any number of threads. They are
+ * spread over SHARD_COUNT shards by name hash, each behind a reader-writer lock, so
+ * readers share a shard and writers only contend within one. Loading, saving and
+ * checkpoints are serialized among themselves but run alongside record access: a
+ * checkpoint takes the changed records shard by shard, as shared handles, and writes
+ * them without holding any shard lock. set_float32_storage is not meant to race with
+ * stores.
  */
 class StorageManager : public interfaces::IStorageManager {
 public:
@@ -28,23 +57,119 @@ public:
     void store(unsigned long long name_hash,
               unsigned long long data_hash,
               const std::vector<std::pair<double, double>>& data,
-              int len) override;
+              int len,
+              unsigned format = 0) override;
+    void store(interfaces::DataNode&& node) override;
 
     bool retrieve(unsigned long long name_hash, interfaces::DataNode& node) const override;
+    interfaces::DataHandle retrieve(unsigned long long name_hash) const override;
     bool exists(unsigned long long name_hash) const override;
     bool remove(unsigned long long name_hash) override;
 
     bool load_from_file(const std::string& filename, int block_size) override;
     bool save_to_file(const std::string& filename) override;
 
-    void clear() override { data_map_.clear(); }
-    std::map<unsigned long long, interfaces::DataNode> get_all_data() const override { return data_map_; }
+    bool checkpoint(const std::string& filename, unsigned long long position, bool full = false) override;
+    unsigned long long get_checkpoint_position() const override { return checkpoint_position_; }
+    size_t get_dirty_count() const override;
+
+    void clear() override;
+    std::map<unsigned long long, interfaces::DataNode> get_all_data() const override;
+    void for_each(const std::function<void(const interfaces::DataNode&)>& visitor) const override;
+
+    /**
+     * @brief Keep blocks as float32 pairs where that provably does not change what they decode to
+     *
+     * Stored records are checked block by block with fits_float32 (precision.h). Blocks
+     * that pass are held as float32, the others stay double, and the record is tagged
+     * RECORD_FLOAT32. Records already tagged RECORD_FLOAT32, e.g. read from a file or the
+     * WAL, are narrowed the same way whether or not the mode is enabled.
+     *
+     * @param enabled Whether new records are narrowed
+     * @param block_size Pairs per block of the codec; also set by load_from_file
+     */
+    void set_float32_storage(bool enabled, int block_size);
+    bool get_float32_storage() const { return float32_enabled_; }
+
+    // Checkpoints below this many superseded records never trigger a full rewrite
+    static constexpr size_t MIN_CHECKPOINT_REWRITE = 1024;
+
+    static constexpr uint32_t FILE_MAGIC = 0x4D484346;     // "FCHM"
+    static constexpr uint32_t SECTION_MAGIC = 0x4B484346;  // "FCHK"
+    static constexpr uint32_t FILE_VERSION = 1;
+    static constexpr size_t FILE_HEADER_SIZE = 16;
+    static constexpr size_t INDEX_ENTRY_SIZE = 56;
+    static constexpr size_t FOOTER_SIZE = 48;
+
+    // Records are spread over this many independently locked shards
+    static constexpr unsigned SHARD_BITS = 6;
+    static constexpr size_t SHARD_COUNT = size_t(1) << SHARD_BITS;
 
 private:
-    std::map<unsigned long long, interfaces::DataNode> data_map_;
+    struct MappedFile;
+    struct DiskRecord;
+    struct Shard;
+    struct SnapshotRecord;
+    struct FileIndex;
+
+    std::shared_ptr<MappedFile> mapped_;
+    // Guard the data file and the fields below; records are guarded by their shard
+    std::mutex file_mutex_;
+    size_t file_records_ = 0;                       // Index entries in the data file
+    bool file_appendable_ = false;                  // Checkpoints can append a section
+    size_t committed_end_ = 0;                      // End of the last valid section
+    std::atomic<unsigned long long> checkpoint_position_{0};  // Position named by the last footer
     interfaces::ILogger& logger_;
     interfaces::IFileOperations* file_ops_;
     bool owns_file_ops_;
+    bool float32_enabled_ = false;
+    int block_size_ = 0;
+    std::unique_ptr<Shard[]> shards_;
+
+    // Helpers: move the blocks that fit into data32, and a copy of the record with them back in data
+    void narrow(interfaces::DataNode& node) const;
+    static interfaces::DataHandle widen(const interfaces::DataHandle& node);
+
+    // Shard holding a name
+    Shard& shard_for(unsigned long long name_hash) const;
+
+    // Look a record up, decoding it from the data file on first access.
+    // A record that fails to decode stays in the data file and is not returned
+    interfaces::DataHandle find(unsigned long long name_hash) const;
+
+    // Map the data file, or read it through IFileOperations
+    std::shared_ptr<MappedFile> open_file(const std::string& filename) const;
+
+    // Check the section whose footer ends at the given offset
+    static bool footer_valid(const MappedFile& file, size_t end);
+
+    // Read the indexes of a binary data file
+    bool index_file(const MappedFile& file, FileIndex& index) const;
+
+    // Decode the payload of a record in the data file, checking its CRC
+    static bool decode(const DiskRecord& record, interfaces::DataNode& node);
+
+    // Append a record's payload, and its index entry for the given file offset of payloads
+    static void encode(const interfaces::DataNode& dn, uint64_t offset,
+                       std::string& payloads, std::string& index);
+
+    // Close a section by appending its footer to the index
+    static void finish_section(std::string& index, uint64_t index_offset, uint64_t section_start,
+                               unsigned long long position);
+
+    // Take the dirty records, or all of them, for a checkpoint; and give the names back if it fails
+    void snapshot(bool all, std::vector<SnapshotRecord>& records, std::vector<unsigned long long>& taken);
+    void restore_dirty(const std::vector<unsigned long long>& taken);
+
+    // Append a snapshot record to a section being written
+    static void append_record(const SnapshotRecord& record, uint64_t offset,
+                              std::string& payloads, std::string& index);
+
+    // Write the whole data file in place of the current one
+    bool rewrite(const std::string& filename, unsigned long long position);
+
+    // Load a data file in the text format
+    bool load_text(const std::string& filename);
 
     // Helper: Atomic write implementation
     bool atomic_write(const std::string& filename, const std::string& content);
@@ -0,0 +1,67 @@
+#ifndef FVM_THREAD_POOL_H
+#define FVM_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fvm {
+
+/**
+ * @brief Fixed-size pool of worker threads for data-parallel loops
+ *
+ * The thread calling parallel_for() takes part in the work, so a pool created
+ * with N threads starts N - 1 workers. A pool of size 1 runs everything inline.
+ * Several threads may call parallel_for() on the same pool at once.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads Total number of threads working on a loop, including the caller
+     */
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Number of threads that work on a loop, including the caller
+     */
+    size_t size() const { return workers_.size() + 1; }
+
+    /**
+     * @brief Run body over [0, count) split into contiguous ranges
+     *
+     * Returns once every range has been processed. If body throws, the first
+     * exception is rethrown here after the remaining ranges have finished.
+     *
+     * @param count Number of loop iterations
+     * @param grain Minimum number of iterations per range, so tiny loops stay inline
+     * @param body Called as body(begin, end) for each range, possibly concurrently
+     */
+    void parallel_for(size_t count, size_t grain,
+                      const std::function<void(size_t, size_t)>& body);
+
+    /**
+     * @brief Hardware concurrency, or 1 when it cannot be determined
+     */
+    static size_t default_thread_count();
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+
+    void worker_loop();
+};
+
+} // namespace fvm
+
+#endif // FVM_THREAD_POOL_H
@@ -4,9 +4,18 @@
 #include "fvm/interfaces/IWalManager.h"
 #include "fvm/interfaces/IFileOperations.h"
 #include "fvm/interfaces/ILogger.h"
+#include "fvm/mpsc_ring.h"
 #include "fvm/saver_constants.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
 
 namespace fvm {
 
@@ -17,9 +26,52 @@ namespace fvm {
  * - Separate interface for easier testing
  * - Configurable compaction strategy
  * - Better error handling and logging
+ *
+ * Record format (version 1), all integers little-endian:
+ *     offset  0  u32 magic "FWAL"
+ *             4  u8 version, u8 op, 2 reserved bytes
+ *             8  u32 format, u32 len
+ *            16  u64 name_hash, u64 data_hash
+ *            32  u32 pair count, u32 block size (0 unless some block is float32)
+ *            40  u32 payload size, u32 CRC32C of bytes 0-43 and the payload
+ *            48  payload: bitmap of float32 blocks (only with a block size),
+ *                then each pair as two IEEE doubles, or two floats in float32 blocks
+ *
+ * Records go to numbered segment files, wal_file.00000001 and up. A segment is
+ * closed once it reaches the segment size or roll_segment() is called, and is
+ * deleted by retire_segments() once a checkpoint covers it. The lowest live
+ * segment number is kept in wal_file.head, so segments can be found without
+ * listing the directory. A WAL file named wal_file itself, in either format,
+ * predates segments; it is replayed first and retired with the first checkpoint.
+ *
+ * Replay of a segment stops at the first record that is cut short or fails its
+ * checksum, which is where a crash during an append leaves it, and goes on with
+ * the next segment. Appends never continue a segment left by an earlier run.
+ * Segments are memory-mapped for replay; records are verified and decoded on a
+ * thread pool, and only the last record of each name reaches the replay
+ * callback, since every record replaces or removes the whole entry.
+ *
+ * The WAL file stays open between appends. append_entry may be called from
+ * several threads: records queue up while a commit is in flight, and the next
+ * caller to find the log idle writes the whole queue with one write() and, under
+ * WalSyncPolicy::PER_COMMIT, one fdatasync(). Every caller returns once its own
+ * record is committed, so concurrent writers share the cost of a sync.
+ *
+ * After start_writer(), submit() takes disk latency off the caller: the record is
+ * encoded on the caller's thread and pushed into a lock-free ring, and a writer
+ * thread drains the ring in batches. submit() returns the record's sequence
+ * number; wait() blocks until that record, and so everything submitted before
+ * it, is durable. append_entry then queues the same way and waits only until
+ * the record has been written, as it would have without the writer.
  */
 class WalManager : public interfaces::IWalManager {
 public:
+    static constexpr uint32_t MAGIC = 0x4C415746;  // "FWAL" read as a little-endian u32
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 48;
+    static constexpr size_t RING_CAPACITY = 1024;            // Records queued for the writer thread
+    static constexpr size_t MAX_BATCH_BYTES = 4 << 20;       // Largest single write of the writer thread
+
     WalManager(const std::string& wal_file,
                interfaces::ILogger& logger,
                interfaces::IFileOperations* file_ops = nullptr);
@@ -30,11 +82,42 @@ public:
     bool append_entry(const interfaces::WalEntry& entry) override;
     bool load_and_replay(std::function<void(const interfaces::WalEntry&)> replay_callback) override;
     bool clear() override;
-    size_t get_entry_count() const override { return entry_count_; }
+    size_t get_entry_count() const override { return entry_count_.load(); }
     void set_enabled(bool enabled) override { enabled_ = enabled; }
     bool is_enabled() const override { return enabled_; }
     void set_auto_compact_threshold(size_t threshold) override { auto_compact_threshold_ = threshold; }
     size_t get_auto_compact_threshold() const override { return auto_compact_threshold_; }
+    bool sync() override;
+    void set_sync_policy(interfaces::WalSyncPolicy policy, unsigned interval_ms = 0) override;
+    interfaces::WalSyncPolicy get_sync_policy() const override { return sync_policy_; }
+    uint64_t roll_segment() override;
+    bool retire_segments(uint64_t before) override;
+    void set_segment_size(size_t bytes) override;
+    size_t get_segment_size() const override { return segment_size_; }
+    bool start_writer() override;
+    void stop_writer() override;
+    uint64_t submit(const interfaces::WalEntry& entry) override;
+    bool wait(uint64_t seq) override;
+
+    /**
+     * @brief Write blocks with float32 precision where that is provably safe
+     *
+     * Same check as StorageManager::set_float32_storage. Entries with such blocks are
+     * tagged RECORD_FLOAT32 and take about half the space in the WAL file.
+     *
+     * @param enabled Whether appended entries are narrowed
+     * @param block_size Pairs per block of the codec
+     */
+    void set_float32_storage(bool enabled, int block_size) {
+        float32_enabled_ = enabled;
+        block_size_ = block_size;
+    }
+    bool get_float32_storage() const { return float32_enabled_; }
+
+    /**
+     * @brief Path of the segment file with the given number
+     */
+    std::string segment_path(uint64_t seq) const;
 
 private:
     std::string wal_file_;
@@ -42,12 +125,104 @@ private:
     interfaces::IFileOperations* file_ops_;
     bool owns_file_ops_;
 
-    size_t entry_count_ = 0;
+    std::atomic<size_t> entry_count_{0};
     size_t auto_compact_threshold_ = DEFAULT_WAL_COMPACT_THRESHOLD;
     bool enabled_ = true;
+    bool float32_enabled_ = false;
+    int block_size_ = 0;
+
+    // Group commit state, guarded by commit_mutex_. Appends are numbered; records
+    // up to committed_seq_ have been written (and synced, as the policy asks).
+    int fd_ = -1;                     // WAL file kept open for appending, -1 until first use
+    std::mutex commit_mutex_;
+    std::condition_variable commit_cv_;
+    std::string pending_;             // Records waiting for the next commit
+    uint64_t next_seq_ = 0;           // Sequence number of the last queued record
+    uint64_t committed_seq_ = 0;      // Last record covered by a finished commit
+    uint64_t failed_seq_ = 0;         // First record of a failed commit, 0 if none
+    bool committing_ = false;         // A caller is writing a batch right now
+    interfaces::WalSyncPolicy sync_policy_ = interfaces::WalSyncPolicy::NONE;
+    std::chrono::milliseconds sync_interval_{0};
+    std::chrono::steady_clock::time_point last_sync_;
+
+    // Segment state, guarded by commit_mutex_ with no commit in flight (or by
+    // the committing_ flag inside write_batch). Discovered on first use.
+    bool segments_known_ = false;
+    uint64_t first_segment_ = 1;      // Lowest live segment
+    uint64_t active_segment_ = 1;     // Segment appends go to
+    size_t segment_bytes_ = 0;        // Bytes written to the active segment
+    bool segment_unsynced_ = false;   // The active segment has writes not yet synced
+    size_t segment_size_ = DEFAULT_WAL_SEGMENT_SIZE;
+    std::map<uint64_t, size_t> segment_entries_;  // Entries per live segment, 0 for the pre-segment file
+
+    // Background writer state. Sequence numbers count submissions from 1; the
+    // counters below are guarded by writer_mutex_.
+    std::unique_ptr<MpscRing<std::string>> ring_;  // Encoded records, null unless the writer runs
+    std::thread writer_;
+    std::mutex writer_mutex_;
+    std::condition_variable writer_cv_;   // Wakes the writer: new records, a sync request, stop
+    std::condition_variable waiter_cv_;   // Wakes callers of wait() after each batch
+    std::atomic<bool> writer_idle_{false};
+    bool writer_stopping_ = false;
+    uint64_t written_seq_ = 0;            // Last record handed to the file
+    uint64_t durable_seq_ = 0;            // Last record known to be on stable storage
+    uint64_t sync_request_ = 0;           // Highest sequence number a caller waits to be durable
+    uint64_t writer_failed_seq_ = 0;      // First record of a failed batch, 0 if none
+
+    // Encode an entry as one binary record, replacing the contents of record
+    void encode_record(const interfaces::WalEntry& entry, std::string& record) const;
+
+    // Writer thread body: drain the ring in batches until stop_writer()
+    void writer_loop();
+
+    // Block until seq has been written (and synced if durable); writer_mutex_ not held
+    bool wait_for(uint64_t seq, bool durable);
+
+    // Commit queued records until seq is covered; lock holds commit_mutex_
+    bool commit_through(std::unique_lock<std::mutex>& lock, uint64_t seq);
+
+    // Write one batch of records to the active segment and sync it as the policy
+    // asks; false on I/O error. synced, if given, tells whether the segment was
+    // synced after the batch.
+    bool write_batch(const std::string& batch, size_t records, bool force_sync, bool* synced = nullptr);
+    bool write_to_file(const std::string& batch, bool force_sync, bool* synced);
+
+    // Open the active segment for appending if it is not open yet
+    bool open_file();
+
+    // Find the live segments left by earlier runs and start a new one after them
+    void discover_segments();
+    bool segment_exists(uint64_t seq);
+    bool read_file(const std::string& path, std::string& content);
+
+    // Segment changes; commit_mutex_ held with no commit in flight
+    bool close_segment();
+    uint64_t roll_locked();
+    bool retire_locked(uint64_t before);
 
     // Atomic write helper
     bool atomic_write(const std::string& filename, const std::string& content);
+
+    // A WAL file in the binary format, mapped or read into memory for replay
+    struct ReplaySource {
+        uint64_t seq;           // Segment number, 0 for the pre-segment file
+        std::string path;
+        const char* data;
+        size_t size;
+        void* mapping;          // Set if data is an mmap of the file
+        size_t mapping_size;
+    };
+
+    // Map a WAL file read-only; false if it cannot be mapped
+    bool map_file(ReplaySource& source);
+
+    // Replay helpers for each file format. replay_binary splits the sources at
+    // record boundaries, verifies and decodes records on a thread pool, and hands
+    // over only the last record of each name, in log order.
+    void replay_binary(const std::vector<ReplaySource>& sources,
+                       const std::function<void(const interfaces::WalEntry&)>& replay_callback);
+    void replay_legacy(const std::string& content,
+                       const std::function<void(const interfaces::WalEntry&)>& replay_callback);
 };
 
 } // namespace fvm
@@ -0,0 +1,89 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+
+#ifndef CHUNKER_CPP
+#define CHUNKER_CPP
+
+#include "fvm/chunker.h"
+#include <algorithm>
+#include <array>
+
+namespace fvm {
+
+namespace {
+
+// The gear table decides where chunks are cut, and so which chunks stored earlier are
+// found again: it must never change. It is filled by splitmix64 from a fixed seed.
+constexpr std::array<uint64_t, 256> make_gear_table() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x46564D2D43444331ULL;
+    for (size_t i = 0; i < table.size(); i++) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        table[i] = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr std::array<uint64_t, 256> GEAR = make_gear_table();
+
+// A mask on the top bits: after shifting left, those depend on the last 64 bytes
+uint64_t top_bits(unsigned bits) {
+    return ~0ULL << (64 - bits);
+}
+
+} // namespace
+
+Chunker::Chunker(size_t average) {
+    average = std::min(std::max(average, MIN_AVERAGE), MAX_AVERAGE);
+    unsigned bits = 0;
+    while ((size_t(2) << bits) <= average) bits++;
+    average_ = size_t(1) << bits;
+    min_ = average_ / 4;
+    max_ = average_ * 8;
+    mask_small_ = top_bits(bits + 2);
+    mask_large_ = top_bits(bits - 2);
+}
+
+size_t Chunker::cut(const char* data, size_t size) const {
+    if (size <= min_) return size;
+    const size_t normal = std::min(average_, size);
+    const size_t limit = std::min(max_, size);
+
+    // Nothing is cut before the minimum size, so it is not hashed either
+    uint64_t fingerprint = 0;
+    size_t i = min_;
+    for (; i < normal; i++) {
+        fingerprint = (fingerprint << 1) + GEAR[static_cast<unsigned char>(data[i])];
+        if (!(fingerprint & mask_small_)) return i + 1;
+    }
+    for (; i < limit; i++) {
+        fingerprint = (fingerprint << 1) + GEAR[static_cast<unsigned char>(data[i])];
+        if (!(fingerprint & mask_large_)) return i + 1;
+    }
+    return limit;
+}
+
+std::vector<size_t> Chunker::split(const std::string& data) const {
+    std::vector<size_t> lengths;
+    lengths.reserve(data.size() / average_ + 1);
+    for (size_t offset = 0; offset < data.size(); ) {
+        size_t length = cut(data.data() + offset, data.size() - offset);
+        lengths.push_back(length);
+        offset += length;
+    }
+    return lengths;
+}
+
+} // namespace fvm
+
+#endif // CHUNKER_CPP
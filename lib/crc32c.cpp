@@ -0,0 +1,114 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+#ifndef CRC32C_CPP
+#define CRC32C_CPP
+
+#include "fvm/crc32c.h"
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FVM_CRC32C_X86 1
+#include <immintrin.h>
+#else
+#define FVM_CRC32C_X86 0
+#endif
+
+namespace fvm {
+
+namespace {
+
+constexpr uint32_t POLY = 0x82F63B78u;  // Reflected Castagnoli polynomial
+
+// table[k][b]: CRC of byte b followed by k zero bytes, for slicing-by-8
+struct Tables {
+    uint32_t table[8][256];
+
+    Tables() {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t crc = b;
+            for (int i = 0; i < 8; i++) {
+                crc = (crc >> 1) ^ (POLY & (0u - (crc & 1)));
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+            }
+        }
+    }
+};
+
+const Tables& tables() {
+    static const Tables t;
+    return t;
+}
+
+uint32_t crc32c_table(const uint8_t* p, size_t size, uint32_t crc) {
+    const auto& t = tables().table;
+    for (; size >= 8; p += 8, size -= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        lo = __builtin_bswap32(lo);
+        hi = __builtin_bswap32(hi);
+#endif
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    for (; size > 0; p++, size--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+    }
+    return crc;
+}
+
+#if FVM_CRC32C_X86
+
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(const uint8_t* p, size_t size, uint32_t crc) {
+    uint64_t crc64 = crc;
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; size > 0; p++, size--) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+
+#endif // FVM_CRC32C_X86
+
+using CrcKernel = uint32_t (*)(const uint8_t* p, size_t size, uint32_t crc);
+
+CrcKernel kernel() {
+    static const CrcKernel k = [] {
+#if FVM_CRC32C_X86
+        if (__builtin_cpu_supports("sse4.2")) return crc32c_sse42;
+#endif
+        return crc32c_table;
+    }();
+    return k;
+}
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+    return ~kernel()(static_cast<const uint8_t*>(data), size, ~crc);
+}
+
+} // namespace fvm
+
+#endif // CRC32C_CPP
@@ -6,116 +6,266 @@
 
 namespace fvm {
 
-bool DataSerializer::serialize(const interfaces::vvs& content, std::vector<int>& sequence) {
-    // Optimized single-pass serialization using stringstream
-    std::ostringstream oss;
+namespace {
+
+size_t varint_size(unsigned long long value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+template <class Sequence>
+void write_varint(Sequence& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Reads an unsigned LEB128 varint at pos; false if it is truncated or too long
+template <class T>
+bool read_varint(const T* data, size_t size, size_t& pos, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        unsigned long long byte = static_cast<uint8_t>(data[pos++]);
+        value |= (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
 
-    oss << content.size();
+// Collects parsed cells into owning strings
+struct VvsSink {
+    interfaces::vvs& content;
+
+    void begin(size_t rows) {
+        content.clear();
+        content.reserve(rows);
+    }
+    void row(size_t cells) {
+        content.emplace_back();
+        content.back().reserve(cells);
+    }
+    template <class T>
+    void cell(const T* data, size_t len) {
+        std::string dt(len, '\0');
+        for (size_t i = 0; i < len; i++) {
+            dt[i] = static_cast<char>(data[i]);
+        }
+        content.back().push_back(std::move(dt));
+    }
+};
+
+// Records parsed cells as views into the buffer being parsed
+struct ViewSink {
+    std::vector<std::string_view>& cells;
+    std::vector<size_t>& row_begin;
+
+    void begin(size_t rows) {
+        cells.clear();
+        row_begin.clear();
+        row_begin.reserve(rows);
+    }
+    void row(size_t) { row_begin.push_back(cells.size()); }
+    void cell(const char* data, size_t len) { cells.emplace_back(data, len); }
+};
+
+} // namespace
+
+size_t DataSerializer::binary_size(const interfaces::vvs& content) {
+    size_t size = 2 + varint_size(content.size());
     for (const auto& data_block : content) {
-        oss << ' ' << data_block.size();
+        size += varint_size(data_block.size());
         for (const auto& dt : data_block) {
-            oss << ' ' << dt.size() << ' ' << dt;
+            size += varint_size(dt.size()) + dt.size();
         }
     }
+    return size;
+}
 
-    // Convert to integer sequence in one pass (no intermediate string copy)
-    std::string serialized = oss.str();
-    sequence.clear();
-    sequence.reserve(serialized.size());  // Pre-allocate
-
-    // Use const_iterator for efficient traversal
-    for (unsigned char ch : serialized) {
-        sequence.push_back(static_cast<int>(ch));
+template <class Sequence>
+void DataSerializer::write_binary(const interfaces::vvs& content, Sequence& out) {
+    out.push_back(BINARY_MAGIC);
+    out.push_back(BINARY_VERSION);
+    write_varint(out, content.size());
+    for (const auto& data_block : content) {
+        write_varint(out, data_block.size());
+        for (const auto& dt : data_block) {
+            write_varint(out, dt.size());
+            for (unsigned char ch : dt) {
+                out.push_back(ch);
+            }
+        }
     }
+}
 
+bool DataSerializer::serialize(const interfaces::vvs& content, std::vector<int>& sequence) {
+    sequence.clear();
+    sequence.reserve(binary_size(content));  // Pre-allocate exactly
+    write_binary(content, sequence);
+    return true;
+}
+
+bool DataSerializer::serialize(const interfaces::vvs& content, std::vector<uint8_t>& bytes) {
+    bytes.clear();
+    bytes.reserve(binary_size(content));
+    write_binary(content, bytes);
     return true;
 }
 
 bool DataSerializer::deserialize(const std::vector<int>& sequence, interfaces::vvs& content) {
-    // Convert integer sequence back to string
-    std::string str;
-    str.reserve(sequence.size());
-    for (int val : sequence) {
-        str.push_back(static_cast<char>(val));
+    VvsSink sink{content};
+    if (!sequence.empty() && sequence[0] == BINARY_MAGIC) {
+        return read_binary(sequence.data(), sequence.size(), sink);
+    }
+    return read_legacy(sequence.data(), sequence.size(), sink);
+}
+
+bool DataSerializer::deserialize(const uint8_t* data, size_t size, interfaces::vvs& content) {
+    VvsSink sink{content};
+    if (size > 0 && data[0] == BINARY_MAGIC) {
+        return read_binary(data, size, sink);
+    }
+    return read_legacy(data, size, sink);
+}
+
+bool DataSerializer::deserialize(const std::vector<int>& sequence, RecordView& view) {
+    // Narrow the sequence into the view's buffer once; every cell then points into it
+    view.buffer_.resize(sequence.size());
+    for (size_t i = 0; i < sequence.size(); i++) {
+        view.buffer_[i] = static_cast<char>(sequence[i]);
+    }
+
+    ViewSink sink{view.cells_, view.row_begin_};
+    const char* data = view.buffer_.data();
+    size_t size = view.buffer_.size();
+    bool ok = size > 0 && static_cast<uint8_t>(data[0]) == BINARY_MAGIC
+                  ? read_binary(data, size, sink)
+                  : read_legacy(data, size, sink);
+    if (!ok) {
+        view.clear();
+    }
+    return ok;
+}
+
+template <class T, class Sink>
+bool DataSerializer::read_binary(const T* data, size_t size, Sink& sink) {
+    sink.begin(0);
+    if (size < 2 || static_cast<uint8_t>(data[1]) != BINARY_VERSION) {
+        return false;  // Unknown version
+    }
+
+    size_t pos = 2;
+    unsigned long long block_num;
+    if (!read_varint(data, size, pos, block_num)) return false;
+    // Every block takes at least one byte, which bounds what corrupt counts can allocate
+    if (block_num > size - pos) return false;
+    sink.begin(block_num);
+
+    for (unsigned long long i = 0; i < block_num; i++) {
+        unsigned long long data_num;
+        if (!read_varint(data, size, pos, data_num)) return false;
+        if (data_num > size - pos) return false;
+        sink.row(data_num);
+
+        for (unsigned long long j = 0; j < data_num; j++) {
+            unsigned long long data_len;
+            if (!read_varint(data, size, pos, data_len)) return false;
+            if (data_len > size - pos) return false;  // Not enough data
+            sink.cell(data + pos, data_len);
+            pos += data_len;
+        }
     }
 
+    return pos == size;
+}
+
+template <class T, class Sink>
+bool DataSerializer::read_legacy(const T* data, size_t size, Sink& sink) {
+    // Counts are unbounded decimal text here, so nothing is reserved from them
+    sink.begin(0);
+
     // Check for empty input
-    if (str.empty()) {
-        content.clear();
+    if (size == 0) {
         return true;  // Empty input is valid (represents 0 blocks)
     }
 
     // Data format: block_num [data_num [data_len data_string]... ]...
-    content.clear();
+
+    auto is_digit = [&](size_t i) { return isdigit(static_cast<unsigned char>(data[i])) != 0; };
 
     // Skip leading non-digits to find block_num
     size_t pos = 0;
-    while (pos < str.size() && !isdigit(static_cast<unsigned char>(str[pos]))) {
+    while (pos < size && !is_digit(pos)) {
         pos++;
     }
 
-    if (pos >= str.size()) {
+    if (pos >= size) {
         return false;  // No digits found
     }
 
     // Parse block_num
     int block_num = 0;
-    while (pos < str.size() && isdigit(static_cast<unsigned char>(str[pos]))) {
-        block_num = block_num * 10 + str[pos] - '0';
+    while (pos < size && is_digit(pos)) {
+        block_num = block_num * 10 + static_cast<char>(data[pos]) - '0';
         pos++;
     }
 
     // Skip space after block_num
-    if (pos < str.size() && str[pos] == ' ') {
+    if (pos < size && data[pos] == ' ') {
         pos++;
     }
 
     for (int i = 0; i < block_num; i++) {
-        content.push_back(std::vector<std::string>());
+        sink.row(0);
 
         // Parse data_num
         int data_num = 0;
-        while (pos < str.size() && !isdigit(static_cast<unsigned char>(str[pos]))) {
+        while (pos < size && !is_digit(pos)) {
             pos++;
         }
-        if (pos >= str.size()) return false;
-        while (pos < str.size() && isdigit(static_cast<unsigned char>(str[pos]))) {
-            data_num = data_num * 10 + str[pos] - '0';
+        if (pos >= size) return false;
+        while (pos < size && is_digit(pos)) {
+            data_num = data_num * 10 + static_cast<char>(data[pos]) - '0';
             pos++;
         }
 
         // Skip space after data_num
-        if (pos < str.size() && str[pos] == ' ') {
+        if (pos < size && data[pos] == ' ') {
             pos++;
         }
 
         for (int j = 0; j < data_num; j++) {
             // Parse data_len
             int data_len = 0;
-            while (pos < str.size() && !isdigit(static_cast<unsigned char>(str[pos]))) {
+            while (pos < size && !is_digit(pos)) {
                 pos++;
             }
-            if (pos >= str.size()) return false;
-            while (pos < str.size() && isdigit(static_cast<unsigned char>(str[pos]))) {
-                data_len = data_len * 10 + str[pos] - '0';
+            if (pos >= size) return false;
+            while (pos < size && is_digit(pos)) {
+                data_len = data_len * 10 + static_cast<char>(data[pos]) - '0';
                 pos++;
             }
 
             // Skip space after data_len
-            if (pos < str.size() && str[pos] == ' ') {
+            if (pos < size && data[pos] == ' ') {
                 pos++;
             }
 
             // Extract data string
-            if (pos + static_cast<size_t>(data_len) > str.size()) {
+            if (pos + static_cast<size_t>(data_len) > size) {
                 return false;  // Not enough data
             }
 
-            content.back().push_back(std::string(str.begin() + pos, str.begin() + pos + data_len));
+            sink.cell(data + pos, data_len);
             pos += data_len;
 
             // Skip space after data string
-            if (pos < str.size() && str[pos] == ' ') {
+            if (pos < size && data[pos] == ' ') {
                 pos++;
             }
         }
@@ -125,29 +275,11 @@ bool DataSerializer::deserialize(const std::vector<int>& sequence, interfaces::v
 }
 
 unsigned long long DataSerializer::calculate_hash(const std::vector<int>& data) {
-    unsigned long long hash = 0;
-    for (int value : data) {
-        hash = hash * HASH_SEED + value;
-    }
-    return hash;
+    return hasher_->hash(data);
 }
 
 unsigned long long DataSerializer::calculate_hash(const std::string& data) {
-    unsigned long long hash = 0;
-    for (unsigned char ch : data) {
-        hash = hash * HASH_SEED + ch;
-    }
-    return hash;
-}
-
-int DataSerializer::parse_int(std::string& s) {
-    int cur = 0, d = 0;
-    for (; cur < static_cast<int>(s.size()) && !isdigit(static_cast<unsigned char>(s[cur])); cur++);
-    for (; cur < static_cast<int>(s.size()) && isdigit(static_cast<unsigned char>(s[cur])); cur++) {
-        d = d * 10 + s[cur] - '0';
-    }
-    s.erase(s.begin(), s.begin() + std::min(cur + 1, static_cast<int>(s.size())));
-    return d;
+    return hasher_->hash(data);
 }
 
 } // namespace fvm
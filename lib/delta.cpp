@@ -0,0 +1,156 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+
+#ifndef DELTA_CPP
+#define DELTA_CPP
+
+#include "fvm/delta.h"
+#include "fvm/byte_order.h"
+#include "fvm/crc32c.h"
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace fvm {
+namespace delta {
+
+namespace {
+
+/**
+ * @brief
+ * Layout: varint base size, varint target size, u32 CRC-32C of target, then ops until
+ * the end. An op starts with varint (length << 1 | is_copy); a copy is followed by
+ * varint offset into base, an insertion by its bytes.
+ */
+constexpr size_t BLOCK = 16;             // Shortest match worth a copy
+constexpr uint64_t MULTIPLIER = 0x100000001B3ULL;
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool get_varint(const std::string& in, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t block_hash(const char* p) {
+    uint64_t h = 0;
+    for (size_t i = 0; i < BLOCK; i++) h = h * MULTIPLIER + static_cast<uint8_t>(p[i]);
+    return h;
+}
+
+void put_insert(std::string& out, const char* data, size_t length) {
+    if (length == 0) return;
+    put_varint(out, static_cast<uint64_t>(length) << 1);
+    out.append(data, length);
+}
+
+void put_copy(std::string& out, size_t offset, size_t length) {
+    put_varint(out, static_cast<uint64_t>(length) << 1 | 1);
+    put_varint(out, offset);
+}
+
+} // namespace
+
+std::string encode(const std::string& base, const std::string& target) {
+    std::string out;
+    put_varint(out, base.size());
+    put_varint(out, target.size());
+    put_u32(out, crc32c(target.data(), target.size()));
+
+    // First offset of every aligned block of base, by hash
+    std::unordered_map<uint64_t, size_t> blocks;
+    blocks.reserve(base.size() / BLOCK);
+    for (size_t offset = 0; offset + BLOCK <= base.size(); offset += BLOCK) {
+        blocks.emplace(block_hash(base.data() + offset), offset);
+    }
+
+    uint64_t top = 1;  // MULTIPLIER^(BLOCK-1), the weight of the byte leaving the window
+    for (size_t i = 1; i < BLOCK; i++) top *= MULTIPLIER;
+
+    const char* t = target.data();
+    const size_t n = target.size();
+    size_t pending = 0;  // Start of the bytes not yet emitted
+    size_t i = 0;
+    uint64_t h = n >= BLOCK ? block_hash(t) : 0;
+    while (i + BLOCK <= n) {
+        auto it = blocks.find(h);
+        if (it != blocks.end() && std::memcmp(base.data() + it->second, t + i, BLOCK) == 0) {
+            size_t offset = it->second;
+            size_t length = BLOCK;
+            while (offset + length < base.size() && i + length < n && base[offset + length] == t[i + length]) length++;
+            // Take back the end of the pending insertion if it matches too
+            while (i > pending && offset > 0 && base[offset - 1] == t[i - 1]) {
+                i--;
+                offset--;
+                length++;
+            }
+            put_insert(out, t + pending, i - pending);
+            put_copy(out, offset, length);
+            i += length;
+            pending = i;
+            if (i + BLOCK <= n) h = block_hash(t + i);
+            continue;
+        }
+        if (i + BLOCK < n) {
+            h = (h - static_cast<uint8_t>(t[i]) * top) * MULTIPLIER + static_cast<uint8_t>(t[i + BLOCK]);
+        }
+        i++;
+    }
+    put_insert(out, t + pending, n - pending);
+    return out;
+}
+
+bool decode(const std::string& base, const std::string& delta, std::string& target) {
+    size_t pos = 0;
+    uint64_t base_size, target_size;
+    if (!get_varint(delta, pos, base_size) || !get_varint(delta, pos, target_size)) return false;
+    if (base_size != base.size() || pos + 4 > delta.size()) return false;
+    const uint32_t crc = get_u32(delta.data() + pos);
+    pos += 4;
+
+    std::string out;
+    out.reserve(target_size);
+    while (pos < delta.size()) {
+        uint64_t op;
+        if (!get_varint(delta, pos, op)) return false;
+        const uint64_t length = op >> 1;
+        if (length > target_size - out.size()) return false;
+        if (op & 1) {
+            uint64_t offset;
+            if (!get_varint(delta, pos, offset)) return false;
+            if (offset > base.size() || length > base.size() - offset) return false;
+            out.append(base, offset, length);
+        } else {
+            if (length > delta.size() - pos) return false;
+            out.append(delta, pos, length);
+            pos += length;
+        }
+    }
+    if (out.size() != target_size || crc32c(out.data(), out.size()) != crc) return false;
+    target = std::move(out);
+    return true;
+}
+
+} // namespace delta
+} // namespace fvm
+
+#endif // DELTA_CPP
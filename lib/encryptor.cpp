@@ -39,117 +39,336 @@ Complex Complex::operator*(const Complex &r) const {
 }
 
                         /* ======= class Encryptor ======= */
-void Encryptor::fft(Complex a[], int n, int type) {
-    // Bit-reversal permutation
-    int j = 0;
-    for (int i = 1; i < n; ++i) {
-        int bit = n >> 1;
-        while (j & bit) {
-            j ^= bit;
-            bit >>= 1;
-        }
-        j ^= bit;
-        if (i < j) {
-            std::swap(a[i], a[j]);
+static_assert((Encryptor::N & (Encryptor::N - 1)) == 0 && (Encryptor::N & 0x55555555) != 0,
+              "The radix-4 FFT requires N to be a power of 4");
+
+Encryptor::FftPlan::FftPlan() {
+    int bits = 0;
+    while ((1 << bits) < N) bits++;
+    for (int i = 0; i < N; i++) {
+        rev[i] = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) rev[i] |= 1 << (bits - 1 - b);
         }
     }
 
-    // Iterative FFT butterfly operations
-    for (int len = 2; len <= n; len <<= 1) {
-        double ang = 2 * PI / len * type;
-        Complex wlen(std::cos(ang), std::sin(ang));
-        for (int i = 0; i < n; i += len) {
-            Complex w(1, 0);
-            for (int j = 0; j < len / 2; ++j) {
-                Complex u = a[i + j];
-                Complex v = a[i + j + len / 2] * w;
-                a[i + j] = u + v;
-                a[i + j + len / 2] = u - v;
-                w = w * wlen;
+    // Twiddles are evaluated directly from the angle rather than by repeated
+    // multiplication, so no rounding error accumulates along a stage.
+    for (int q = 1; q < N; q <<= 2) {
+        for (int r = 1; r <= 3; r++) {
+            for (int j = 0; j < q; j++) {
+                double ang = 2 * PI * r * j / (4 * q);
+                int k = q - 1 + (r - 1) * q + j;
+                twiddle_re[0][k] = twiddle_re[1][k] = std::cos(ang);
+                twiddle_im[0][k] = std::sin(ang);
+                twiddle_im[1][k] = -std::sin(ang);
             }
         }
     }
 
+    // The forward transform uses e^(+i*angle), so the real split twiddles do as well
+    for (int k = 0; k < N; k++) {
+        double ang = PI * k / N;
+        real_re[k] = std::cos(ang);
+        real_im[k] = std::sin(ang);
+    }
+}
+
+const Encryptor::FftPlan& Encryptor::plan() {
+    static const FftPlan instance;
+    return instance;
+}
+
+Encryptor::Encryptor(Transform transform) : transform_(transform) {
+    isa_ = fvm::fft::detect_isa();
+    stage_ = fvm::fft::get_stage_kernel(isa_);
+}
+
+bool Encryptor::set_isa(fvm::fft::Isa isa) {
+    if (!fvm::fft::is_supported(isa)) return false;
+    isa_ = isa;
+    stage_ = fvm::fft::get_stage_kernel(isa);
+    return true;
+}
+
+void Encryptor::set_thread_count(size_t threads) {
+    if (threads <= 1) {
+        pool_.reset();
+    } else if (get_thread_count() != threads) {
+        pool_ = std::make_unique<fvm::ThreadPool>(threads);
+    }
+}
+
+void Encryptor::for_each_block_range(size_t blocks, const std::function<void(size_t, size_t)> &body) const {
+    if (pool_) {
+        pool_->parallel_for(blocks, BLOCKS_PER_TASK, body);
+    } else {
+        body(0, blocks);
+    }
+}
+
+void Encryptor::fft(double re[], double im[], int type) const {
+    const FftPlan& p = plan();
+
+    // Radix-4 butterflies, see fvm::fft::StageKernel for the data layout
+    const int dir = type == 1 ? 0 : 1;
+    for (int q = 1; q < N; q <<= 2) {
+        stage_(re, im, N, q, p.twiddle_re[dir] + (q - 1), p.twiddle_im[dir] + (q - 1), type);
+    }
+
     // Normalize for inverse transform
     if (type == -1) {
-        for (int i = 0; i < n; ++i) {
-            a[i].a /= n;
-            a[i].b /= n;
+        const double scale = 1.0 / N;
+        for (int i = 0; i < N; ++i) {
+            re[i] *= scale;
+            im[i] *= scale;
         }
     }
 }
 
-bool Encryptor::encrypt_block(std::vector<std::pair<double, double>> &res) {
-    fft(block, N, 1);
-    res.clear();
-    for (int i = 0; i < N; i++) {
-        res.push_back(std::make_pair(block[i].a, block[i].b));
+void Encryptor::set_value(Block &scratch, size_t i, double value) const {
+    const int *rev = plan().rev;
+    if (transform_ == Transform::COMPLEX) {
+        scratch.re[rev[i]] = value;
+        scratch.im[rev[i]] = 0;
+    } else if (i & 1) {
+        scratch.im[rev[i >> 1]] = value;
+    } else {
+        scratch.re[rev[i >> 1]] = value;
     }
-    return true;
 }
 
-bool Encryptor::decrypt_block(std::vector<int> &res) {
-    fft(block, N, -1);
-    res.clear();
-    for (int i = 0; i < N; i++) {
-        int rounded_value = static_cast<int>(std::round(block[i].a));
-        if (block[i].a < 0.0 && std::abs(block[i].a) > ROUNDING_THRESHOLD) {
-            rounded_value--;
+void Encryptor::transform_block(Block &scratch, std::pair<double, double> *res) const {
+    fft(scratch.re, scratch.im, 1);
+
+    if (transform_ == Transform::COMPLEX) {
+        for (int i = 0; i < N; i++) {
+            res[i] = std::make_pair(scratch.re[i], scratch.im[i]);
         }
-        res.push_back(rounded_value);
+        return;
+    }
+
+    // The block was packed as z[n] = x[2n] + i*x[2n+1]. Split Z into the spectra
+    // E and O of the even and odd values, then X[k] = E[k] + w^k * O[k].
+    // X[0] and X[N] are real and share pair 0.
+    const FftPlan& p = plan();
+    const double *re = scratch.re, *im = scratch.im;
+    res[0] = std::make_pair(re[0] + im[0], re[0] - im[0]);
+    for (int k = 1; k < N; k++) {
+        const int m = N - k;
+        double er = (re[k] + re[m]) * 0.5, ei = (im[k] - im[m]) * 0.5;
+        double orr = (im[k] + im[m]) * 0.5, oi = (re[m] - re[k]) * 0.5;
+        double wr = p.real_re[k], wi = p.real_im[k];
+        res[k] = std::make_pair(er + (wr * orr - wi * oi), ei + (wr * oi + wi * orr));
     }
-    return true;
 }
 
-bool Encryptor::encrypt_sequence(const std::vector<int> &sequence, std::vector<std::pair<double, double>> &res) {
-    int len = sequence.size();
-    std::vector<int> padded_sequence = sequence;
-    while ((padded_sequence.size() + 1) % N != 0) {
-        padded_sequence.push_back(PLACEHOLDER);
-    }
-    int block_index = 1;
-    memset(block, 0, sizeof(block));
-    block[0].a = len;
-    res.clear();
-    std::vector<std::pair<double, double>> temp_buffer;
-    for (auto &element : padded_sequence) {
-        block[block_index++].a = element;
-        if (block_index == N) {
-            encrypt_block(temp_buffer);
-            res.insert(res.end(), temp_buffer.begin(), temp_buffer.end());
-            block_index = 0;
-            memset(block, 0, sizeof(block));
-            temp_buffer.clear();
+template <typename T>
+void Encryptor::encrypt_block(const T *values, size_t length, size_t index, Block &scratch,
+                              std::pair<double, double> *res) const {
+    const int *rev = plan().rev;
+    const size_t first = index * values_per_block();
+
+    // Position 0 of the stream is the length header, the sequence follows it
+    auto stream_value = [&](size_t pos) -> double {
+        if (pos == 0) return static_cast<int>(length);
+        if (pos - 1 < length) return values[pos - 1];
+        return PLACEHOLDER;
+    };
+
+    // Same placement as set_value, with the mode test hoisted out of the loop
+    if (transform_ == Transform::COMPLEX) {
+        memset(scratch.im, 0, sizeof(scratch.im));
+        for (int i = 0; i < N; i++) {
+            scratch.re[rev[i]] = stream_value(first + i);
+        }
+    } else {
+        for (int n = 0; n < N; n++) {
+            scratch.re[rev[n]] = stream_value(first + 2 * n);
+            scratch.im[rev[n]] = stream_value(first + 2 * n + 1);
         }
     }
-    return true;
+    transform_block(scratch, res);
+}
+
+void Encryptor::decrypt_block(const std::pair<double, double> *data, Block &scratch) const {
+    const FftPlan& p = plan();
+    const int *rev = p.rev;
+
+    if (transform_ == Transform::COMPLEX) {
+        for (int i = 0; i < N; i++) {
+            scratch.re[rev[i]] = data[i].first;
+            scratch.im[rev[i]] = data[i].second;
+        }
+        fft(scratch.re, scratch.im, -1);
+        return;
+    }
+
+    // Rebuild Z[k] = E[k] + i*O[k] from the half spectrum, inverting encrypt_block
+    scratch.re[rev[0]] = (data[0].first + data[0].second) * 0.5;
+    scratch.im[rev[0]] = (data[0].first - data[0].second) * 0.5;
+    for (int k = 1; k < N; k++) {
+        const std::pair<double, double> &x = data[k], &xm = data[N - k];
+        double er = (x.first + xm.first) * 0.5, ei = (x.second - xm.second) * 0.5;
+        double dr = (x.first - xm.first) * 0.5, di = (x.second + xm.second) * 0.5;
+        double wr = p.real_re[k], wi = p.real_im[k];
+        double orr = dr * wr + di * wi, oi = di * wr - dr * wi;
+        scratch.re[rev[k]] = er - oi;
+        scratch.im[rev[k]] = ei + orr;
+    }
+    fft(scratch.re, scratch.im, -1);
+}
+
+template <typename T>
+void Encryptor::copy_values(const Block &scratch, size_t first, size_t count, T *out) const {
+    if (transform_ == Transform::COMPLEX) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = static_cast<T>(round_value(scratch.re[first + i]));
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t pos = first + i;
+        out[i] = static_cast<T>(round_value(pos & 1 ? scratch.im[pos >> 1] : scratch.re[pos >> 1]));
+    }
+}
+
+int Encryptor::round_value(double value) {
+    int rounded_value = static_cast<int>(std::round(value));
+    if (value < 0.0 && std::abs(value) > ROUNDING_THRESHOLD) {
+        rounded_value--;
+    }
+    return rounded_value;
+}
+
+template <typename T>
+void Encryptor::encrypt_values(const T *values, size_t length, std::vector<std::pair<double, double>> &res) const {
+    // The length header plus the sequence, padded up to a whole number of blocks
+    const size_t blocks = length / values_per_block() + 1;
+    res.clear();
+    res.resize(blocks * N);
+
+    for_each_block_range(blocks, [&](size_t begin, size_t end) {
+        Block scratch;
+        for (size_t b = begin; b < end; b++) {
+            encrypt_block(values, length, b, scratch, res.data() + b * N);
+        }
+    });
 }
 
-bool Encryptor::decrypt_sequence(std::vector<std::pair<double, double>> &sequence, std::vector<int> &res) {
+template <typename T>
+bool Encryptor::decrypt_values(const std::vector<std::pair<double, double>> &sequence, std::vector<T> &res) const {
     if (sequence.size() % N != 0) return false;
-    memset(block, 0, sizeof(block));
-    int block_index = 0;
     res.clear();
-    int len = -1;
-    std::vector<int> temp_buffer;
-    for (auto &element : sequence) {
-        block[block_index].a = element.first;
-        block[block_index++].b = element.second;
-        if (block_index == N) {
-            decrypt_block(temp_buffer);
-            if (len != -1) {
-                res.insert(res.end(), temp_buffer.begin(), temp_buffer.end());
-            } else {
-                len = temp_buffer.front();
-                res.insert(res.end(), temp_buffer.begin() + 1, temp_buffer.end());
-            }
-            block_index = 0;
-            memset(block, 0, sizeof(block));
-            temp_buffer.clear();
+    const size_t blocks = sequence.size() / N;
+    if (blocks == 0) return true;
+    const size_t per_block = values_per_block();
+
+    // The first block carries the length, which sizes the result
+    Block head;
+    decrypt_block(sequence.data(), head);
+    long long len = round_value(head.re[0]);
+    if (len < 0 || static_cast<size_t>(len) > blocks * per_block - 1) return false;
+    res.resize(len);
+
+    const size_t used_blocks = static_cast<size_t>(len) / per_block + 1;
+    copy_values(head, 1, std::min(per_block - 1, res.size()), res.data());
+
+    for_each_block_range(used_blocks - 1, [&](size_t begin, size_t end) {
+        Block scratch;
+        for (size_t b = begin + 1; b < end + 1; b++) {
+            decrypt_block(sequence.data() + b * N, scratch);
+            const size_t offset = b * per_block - 1;
+            copy_values(scratch, 0, std::min(per_block, res.size() - offset), res.data() + offset);
         }
+    });
+    return true;
+}
+
+bool Encryptor::encrypt_sequence(const std::vector<int> &sequence, std::vector<std::pair<double, double>> &res) {
+    encrypt_values(sequence.data(), sequence.size(), res);
+    return true;
+}
+
+bool Encryptor::decrypt_sequence(const std::vector<std::pair<double, double>> &sequence, std::vector<int> &res) {
+    return decrypt_values(sequence, res);
+}
+
+bool Encryptor::encrypt_bytes(const std::string &bytes, std::vector<std::pair<double, double>> &res) {
+    encrypt_values(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size(), res);
+    return true;
+}
+
+bool Encryptor::decrypt_bytes(const std::vector<std::pair<double, double>> &sequence, std::vector<uint8_t> &res) {
+    return decrypt_values(sequence, res);
+}
+
+                        /* ======= class Encryptor::Encoder ======= */
+Encryptor::Encoder::Encoder(const Encryptor &encryptor, size_t length)
+    : encryptor_(encryptor), length_(length), fill_(1), emitted_(0) {
+    blocks_ = length / encryptor.values_per_block() + 1;
+    encryptor_.set_value(scratch_, 0, static_cast<int>(length));
+}
+
+size_t Encryptor::Encoder::push(const int *data, size_t count) {
+    const size_t per_block = encryptor_.values_per_block();
+    // Never accept more than announced, nor overwrite a block that was not pulled
+    const size_t pushed = emitted_ * per_block + fill_ - 1;
+    count = std::min(count, length_ - pushed);
+    count = std::min(count, per_block - fill_);
+    for (size_t i = 0; i < count; i++) {
+        encryptor_.set_value(scratch_, fill_ + i, data[i]);
+    }
+    fill_ += count;
+    return count;
+}
+
+bool Encryptor::Encoder::ready() const {
+    if (done()) return false;
+    const size_t per_block = encryptor_.values_per_block();
+    return fill_ == per_block || emitted_ * per_block + fill_ == length_ + 1;
+}
+
+bool Encryptor::Encoder::pull(std::pair<double, double> *out) {
+    if (!ready()) return false;
+    // The last block is padded with PLACEHOLDER
+    for (size_t i = fill_; i < encryptor_.values_per_block(); i++) {
+        encryptor_.set_value(scratch_, i, PLACEHOLDER);
     }
-    res.erase(res.begin() + len, res.end());
+    encryptor_.transform_block(scratch_, out);
+    emitted_++;
+    fill_ = 0;
     return true;
 }
 
+                        /* ======= class Encryptor::Decoder ======= */
+Encryptor::Decoder::Decoder(const Encryptor &encryptor, size_t blocks)
+    : encryptor_(encryptor), blocks_(blocks), length_(-1), delivered_(0), next_(0), end_(0) {}
+
+bool Encryptor::Decoder::push(const std::pair<double, double> *block) {
+    if (next_ < end_ || done()) return false;
+
+    encryptor_.decrypt_block(block, scratch_);
+    const size_t per_block = encryptor_.values_per_block();
+    next_ = 0;
+    if (length_ < 0) {
+        long long len = round_value(scratch_.re[0]);
+        // Checked before anyone sizes a buffer by it
+        if (len < 0 || blocks_ == 0 || static_cast<size_t>(len) > blocks_ * per_block - 1) return false;
+        length_ = len;
+        next_ = 1;
+    }
+    // The values of this block not past the end of the sequence
+    end_ = std::min<size_t>(per_block, next_ + (static_cast<size_t>(length_) - delivered_));
+    return true;
+}
+
+size_t Encryptor::Decoder::pull(int *out, size_t capacity) {
+    const size_t count = std::min(capacity, end_ - next_);
+    encryptor_.copy_values(scratch_, next_, count, out);
+    next_ += count;
+    delivered_ += count;
+    return count;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,257 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+#ifndef FFT_KERNELS_CPP
+#define FFT_KERNELS_CPP
+
+#include "fvm/fft_kernels.h"
+
+// SIMD kernels are compiled with per-function target attributes, so the rest of
+// the program keeps the baseline instruction set and the choice is made at runtime.
+// This file must be built with -ffp-contract=off: a fused multiply-add in one
+// kernel but not in another would break bit-exact agreement between them.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FVM_FFT_X86 1
+#include <immintrin.h>
+#else
+#define FVM_FFT_X86 0
+#endif
+
+namespace fvm {
+namespace fft {
+
+namespace {
+
+void stage_scalar(double* re, double* im, int n, int q,
+                  const double* wr, const double* wi, int type) {
+    for (int i = 0; i < n; i += 4 * q) {
+        for (int j = 0; j < q; j++) {
+            const int k0 = i + j, k1 = k0 + q, k2 = k1 + q, k3 = k2 + q;
+
+            double t0r = re[k0], t0i = im[k0];
+            double t1r = re[k2] * wr[j] - im[k2] * wi[j];
+            double t1i = re[k2] * wi[j] + im[k2] * wr[j];
+            double t2r = re[k1] * wr[q + j] - im[k1] * wi[q + j];
+            double t2i = re[k1] * wi[q + j] + im[k1] * wr[q + j];
+            double t3r = re[k3] * wr[2 * q + j] - im[k3] * wi[2 * q + j];
+            double t3i = re[k3] * wi[2 * q + j] + im[k3] * wr[2 * q + j];
+
+            double s02r = t0r + t2r, s02i = t0i + t2i;
+            double d02r = t0r - t2r, d02i = t0i - t2i;
+            double s13r = t1r + t3r, s13i = t1i + t3i;
+            double d13r = t1r - t3r, d13i = t1i - t3i;
+            // Multiply d13 by the quarter-turn root, which is i or -i
+            double rotr = -d13i * type, roti = d13r * type;
+
+            re[k0] = s02r + s13r; im[k0] = s02i + s13i;
+            re[k1] = d02r + rotr; im[k1] = d02i + roti;
+            re[k2] = s02r - s13r; im[k2] = s02i - s13i;
+            re[k3] = d02r - rotr; im[k3] = d02i - roti;
+        }
+    }
+}
+
+#if FVM_FFT_X86
+
+void stage_sse2(double* re, double* im, int n, int q,
+                const double* wr, const double* wi, int type) {
+    if (q < 2) {
+        stage_scalar(re, im, n, q, wr, wi, type);
+        return;
+    }
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d dir = _mm_set1_pd(static_cast<double>(type));
+    for (int i = 0; i < n; i += 4 * q) {
+        for (int j = 0; j < q; j += 2) {
+            const int k0 = i + j, k1 = k0 + q, k2 = k1 + q, k3 = k2 + q;
+            __m128d w1r = _mm_loadu_pd(wr + j), w1i = _mm_loadu_pd(wi + j);
+            __m128d w2r = _mm_loadu_pd(wr + q + j), w2i = _mm_loadu_pd(wi + q + j);
+            __m128d w3r = _mm_loadu_pd(wr + 2 * q + j), w3i = _mm_loadu_pd(wi + 2 * q + j);
+
+            __m128d t0r = _mm_loadu_pd(re + k0), t0i = _mm_loadu_pd(im + k0);
+            __m128d x1r = _mm_loadu_pd(re + k2), x1i = _mm_loadu_pd(im + k2);
+            __m128d x2r = _mm_loadu_pd(re + k1), x2i = _mm_loadu_pd(im + k1);
+            __m128d x3r = _mm_loadu_pd(re + k3), x3i = _mm_loadu_pd(im + k3);
+
+            __m128d t1r = _mm_sub_pd(_mm_mul_pd(x1r, w1r), _mm_mul_pd(x1i, w1i));
+            __m128d t1i = _mm_add_pd(_mm_mul_pd(x1r, w1i), _mm_mul_pd(x1i, w1r));
+            __m128d t2r = _mm_sub_pd(_mm_mul_pd(x2r, w2r), _mm_mul_pd(x2i, w2i));
+            __m128d t2i = _mm_add_pd(_mm_mul_pd(x2r, w2i), _mm_mul_pd(x2i, w2r));
+            __m128d t3r = _mm_sub_pd(_mm_mul_pd(x3r, w3r), _mm_mul_pd(x3i, w3i));
+            __m128d t3i = _mm_add_pd(_mm_mul_pd(x3r, w3i), _mm_mul_pd(x3i, w3r));
+
+            __m128d s02r = _mm_add_pd(t0r, t2r), s02i = _mm_add_pd(t0i, t2i);
+            __m128d d02r = _mm_sub_pd(t0r, t2r), d02i = _mm_sub_pd(t0i, t2i);
+            __m128d s13r = _mm_add_pd(t1r, t3r), s13i = _mm_add_pd(t1i, t3i);
+            __m128d d13r = _mm_sub_pd(t1r, t3r), d13i = _mm_sub_pd(t1i, t3i);
+            __m128d rotr = _mm_mul_pd(_mm_xor_pd(d13i, sign), dir);
+            __m128d roti = _mm_mul_pd(d13r, dir);
+
+            _mm_storeu_pd(re + k0, _mm_add_pd(s02r, s13r));
+            _mm_storeu_pd(im + k0, _mm_add_pd(s02i, s13i));
+            _mm_storeu_pd(re + k1, _mm_add_pd(d02r, rotr));
+            _mm_storeu_pd(im + k1, _mm_add_pd(d02i, roti));
+            _mm_storeu_pd(re + k2, _mm_sub_pd(s02r, s13r));
+            _mm_storeu_pd(im + k2, _mm_sub_pd(s02i, s13i));
+            _mm_storeu_pd(re + k3, _mm_sub_pd(d02r, rotr));
+            _mm_storeu_pd(im + k3, _mm_sub_pd(d02i, roti));
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void stage_avx2(double* re, double* im, int n, int q,
+                const double* wr, const double* wi, int type) {
+    if (q < 4) {
+        stage_scalar(re, im, n, q, wr, wi, type);
+        return;
+    }
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d dir = _mm256_set1_pd(static_cast<double>(type));
+    for (int i = 0; i < n; i += 4 * q) {
+        for (int j = 0; j < q; j += 4) {
+            const int k0 = i + j, k1 = k0 + q, k2 = k1 + q, k3 = k2 + q;
+            __m256d w1r = _mm256_loadu_pd(wr + j), w1i = _mm256_loadu_pd(wi + j);
+            __m256d w2r = _mm256_loadu_pd(wr + q + j), w2i = _mm256_loadu_pd(wi + q + j);
+            __m256d w3r = _mm256_loadu_pd(wr + 2 * q + j), w3i = _mm256_loadu_pd(wi + 2 * q + j);
+
+            __m256d t0r = _mm256_loadu_pd(re + k0), t0i = _mm256_loadu_pd(im + k0);
+            __m256d x1r = _mm256_loadu_pd(re + k2), x1i = _mm256_loadu_pd(im + k2);
+            __m256d x2r = _mm256_loadu_pd(re + k1), x2i = _mm256_loadu_pd(im + k1);
+            __m256d x3r = _mm256_loadu_pd(re + k3), x3i = _mm256_loadu_pd(im + k3);
+
+            __m256d t1r = _mm256_sub_pd(_mm256_mul_pd(x1r, w1r), _mm256_mul_pd(x1i, w1i));
+            __m256d t1i = _mm256_add_pd(_mm256_mul_pd(x1r, w1i), _mm256_mul_pd(x1i, w1r));
+            __m256d t2r = _mm256_sub_pd(_mm256_mul_pd(x2r, w2r), _mm256_mul_pd(x2i, w2i));
+            __m256d t2i = _mm256_add_pd(_mm256_mul_pd(x2r, w2i), _mm256_mul_pd(x2i, w2r));
+            __m256d t3r = _mm256_sub_pd(_mm256_mul_pd(x3r, w3r), _mm256_mul_pd(x3i, w3i));
+            __m256d t3i = _mm256_add_pd(_mm256_mul_pd(x3r, w3i), _mm256_mul_pd(x3i, w3r));
+
+            __m256d s02r = _mm256_add_pd(t0r, t2r), s02i = _mm256_add_pd(t0i, t2i);
+            __m256d d02r = _mm256_sub_pd(t0r, t2r), d02i = _mm256_sub_pd(t0i, t2i);
+            __m256d s13r = _mm256_add_pd(t1r, t3r), s13i = _mm256_add_pd(t1i, t3i);
+            __m256d d13r = _mm256_sub_pd(t1r, t3r), d13i = _mm256_sub_pd(t1i, t3i);
+            __m256d rotr = _mm256_mul_pd(_mm256_xor_pd(d13i, sign), dir);
+            __m256d roti = _mm256_mul_pd(d13r, dir);
+
+            _mm256_storeu_pd(re + k0, _mm256_add_pd(s02r, s13r));
+            _mm256_storeu_pd(im + k0, _mm256_add_pd(s02i, s13i));
+            _mm256_storeu_pd(re + k1, _mm256_add_pd(d02r, rotr));
+            _mm256_storeu_pd(im + k1, _mm256_add_pd(d02i, roti));
+            _mm256_storeu_pd(re + k2, _mm256_sub_pd(s02r, s13r));
+            _mm256_storeu_pd(im + k2, _mm256_sub_pd(s02i, s13i));
+            _mm256_storeu_pd(re + k3, _mm256_sub_pd(d02r, rotr));
+            _mm256_storeu_pd(im + k3, _mm256_sub_pd(d02i, roti));
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+void stage_avx512(double* re, double* im, int n, int q,
+                  const double* wr, const double* wi, int type) {
+    if (q < 8) {
+        stage_avx2(re, im, n, q, wr, wi, type);
+        return;
+    }
+    const __m512d dir = _mm512_set1_pd(static_cast<double>(type));
+    const __m512d zero = _mm512_setzero_pd();
+    for (int i = 0; i < n; i += 4 * q) {
+        for (int j = 0; j < q; j += 8) {
+            const int k0 = i + j, k1 = k0 + q, k2 = k1 + q, k3 = k2 + q;
+            __m512d w1r = _mm512_loadu_pd(wr + j), w1i = _mm512_loadu_pd(wi + j);
+            __m512d w2r = _mm512_loadu_pd(wr + q + j), w2i = _mm512_loadu_pd(wi + q + j);
+            __m512d w3r = _mm512_loadu_pd(wr + 2 * q + j), w3i = _mm512_loadu_pd(wi + 2 * q + j);
+
+            __m512d t0r = _mm512_loadu_pd(re + k0), t0i = _mm512_loadu_pd(im + k0);
+            __m512d x1r = _mm512_loadu_pd(re + k2), x1i = _mm512_loadu_pd(im + k2);
+            __m512d x2r = _mm512_loadu_pd(re + k1), x2i = _mm512_loadu_pd(im + k1);
+            __m512d x3r = _mm512_loadu_pd(re + k3), x3i = _mm512_loadu_pd(im + k3);
+
+            __m512d t1r = _mm512_sub_pd(_mm512_mul_pd(x1r, w1r), _mm512_mul_pd(x1i, w1i));
+            __m512d t1i = _mm512_add_pd(_mm512_mul_pd(x1r, w1i), _mm512_mul_pd(x1i, w1r));
+            __m512d t2r = _mm512_sub_pd(_mm512_mul_pd(x2r, w2r), _mm512_mul_pd(x2i, w2i));
+            __m512d t2i = _mm512_add_pd(_mm512_mul_pd(x2r, w2i), _mm512_mul_pd(x2i, w2r));
+            __m512d t3r = _mm512_sub_pd(_mm512_mul_pd(x3r, w3r), _mm512_mul_pd(x3i, w3i));
+            __m512d t3i = _mm512_add_pd(_mm512_mul_pd(x3r, w3i), _mm512_mul_pd(x3i, w3r));
+
+            __m512d s02r = _mm512_add_pd(t0r, t2r), s02i = _mm512_add_pd(t0i, t2i);
+            __m512d d02r = _mm512_sub_pd(t0r, t2r), d02i = _mm512_sub_pd(t0i, t2i);
+            __m512d s13r = _mm512_add_pd(t1r, t3r), s13i = _mm512_add_pd(t1i, t3i);
+            __m512d d13r = _mm512_sub_pd(t1r, t3r), d13i = _mm512_sub_pd(t1i, t3i);
+            // AVX-512F has no floating-point xor, so negate by multiplying with -type
+            __m512d rotr = _mm512_mul_pd(d13i, _mm512_sub_pd(zero, dir));
+            __m512d roti = _mm512_mul_pd(d13r, dir);
+
+            _mm512_storeu_pd(re + k0, _mm512_add_pd(s02r, s13r));
+            _mm512_storeu_pd(im + k0, _mm512_add_pd(s02i, s13i));
+            _mm512_storeu_pd(re + k1, _mm512_add_pd(d02r, rotr));
+            _mm512_storeu_pd(im + k1, _mm512_add_pd(d02i, roti));
+            _mm512_storeu_pd(re + k2, _mm512_sub_pd(s02r, s13r));
+            _mm512_storeu_pd(im + k2, _mm512_sub_pd(s02i, s13i));
+            _mm512_storeu_pd(re + k3, _mm512_sub_pd(d02r, rotr));
+            _mm512_storeu_pd(im + k3, _mm512_sub_pd(d02i, roti));
+        }
+    }
+}
+
+#endif // FVM_FFT_X86
+
+} // namespace
+
+StageKernel get_stage_kernel(Isa isa) {
+#if FVM_FFT_X86
+    switch (isa) {
+        case Isa::SSE2:   return stage_sse2;
+        case Isa::AVX2:   return stage_avx2;
+        case Isa::AVX512: return stage_avx512;
+        default:          break;
+    }
+#endif
+    (void)isa;
+    return stage_scalar;
+}
+
+bool is_supported(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR:
+            return true;
+#if FVM_FFT_X86
+        case Isa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+Isa detect_isa() {
+    if (is_supported(Isa::AVX512)) return Isa::AVX512;
+    if (is_supported(Isa::AVX2)) return Isa::AVX2;
+    if (is_supported(Isa::SSE2)) return Isa::SSE2;
+    return Isa::SCALAR;
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2:   return "sse2";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+        default:          return "scalar";
+    }
+}
+
+} // namespace fft
+} // namespace fvm
+
+#endif // FFT_KERNELS_CPP
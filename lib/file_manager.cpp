@@ -13,19 +13,43 @@
 
 #include "fvm/interfaces/ILogger.h"
 #include "fvm/interfaces/IFileManager.h"
+#include "fvm/interfaces/IContentStream.h"
 #include "fvm/repositories/IFileManagerRepository.h"
 #include "logger.cpp"
 #include "saver.cpp"
+#include "fvm/hasher.h"
+#include "fvm/chunker.h"
+#include "fvm/delta.h"
+#include "fvm/byte_order.h"
+#include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <list>
+#include <memory>
 #include <string>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 struct fileNode {
-    std::string content;
+    fvm::repositories::FileRecord file;
     unsigned long long cnt;
+    unsigned long long pins = 0;  // Open readers, counted in cnt but not persisted
+    bool loaded = true;  // False until the chunk list is read from the repository
 
     fileNode() = default;
-    fileNode(std::string content) : content(content), cnt(1) {}
+    fileNode(fvm::repositories::FileRecord file) : file(std::move(file)), cnt(1) {}
+};
+
+struct chunkNode {
+    std::string data;
+    unsigned long long cnt;  // Occurrences in the chunk lists of files
+    unsigned long long size = fvm::repositories::ChunkInfo::UNKNOWN_SIZE;
+    bool loaded = true;      // False when the data is only in the repository
+
+    chunkNode() = default;
+    chunkNode(std::string data) : data(std::move(data)), cnt(1), size(this->data.size()) {}
 };
 
 class FileManager : public fvm::interfaces::IFileManager {
@@ -33,16 +57,93 @@ private:
     fvm::interfaces::ILogger& logger_;
     fvm::repositories::IFileManagerRepository& repository_;
     std::map<unsigned long long, fileNode> mp;
+    std::map<unsigned long long, chunkNode> chunks_;
+    fvm::Chunker chunker_;
+
+    /**
+     * @brief
+     * A file is a list of content-defined chunks, and chunks are shared between files,
+     * so a new version of a large file only stores the chunks around the edit.
+     *
+     * Files and chunks are content addressed: a chunk's id is the hash of its bytes and a
+     * file's the hash of its chunk list, moved to the next free id on a collision, so
+     * storing content that is already there only bumps its counter. Chunks are compared
+     * in full before being shared; since chunking is deterministic, files with equal
+     * contents then have equal chunk lists. A file id thus only needs the chunks, and a
+     * writer can store them as they are cut instead of holding the whole content.
+     *
+     * With delta revisions on, update_content() stores a new version as a delta against
+     * the one it replaces, which stays alive as its base. Every keyframe-interval-th
+     * revision, or one that differs too much, is stored in full instead, so at most
+     * that many deltas are applied to rebuild a content. Rebuilt contents are kept in
+     * a small LRU cache, as reading a history back walks the same chains. Files larger
+     * than MAX_DELTA_CONTENT, before or after the update, are always stored in full:
+     * they share their unchanged chunks anyway, and a delta has to be rebuilt whole.
+     *
+     * Files and chunks are persisted one record each. The indexes of reference counts
+     * are read on first use, chunk lists when first asked for, and stored chunks each
+     * time they are needed, without keeping them. save() writes what was created since
+     * the last save, drops what was removed and rewrites the indexes if they changed.
+     */
+    bool loaded_ = false;
+    bool index_dirty_ = false;
+    bool chunk_index_dirty_ = false;
+    std::set<unsigned long long> unsaved_;         // Created since the last save
+    std::set<unsigned long long> removed_;         // Saved before, no longer referenced
+    std::set<unsigned long long> unsaved_chunks_;
+    std::set<unsigned long long> removed_chunks_;
+    std::set<unsigned long long> legacy_;          // Read from a whole-content record, now chunked
+
+    unsigned keyframe_interval_ = 0;  // 0 stores every revision in full
+    std::list<std::pair<unsigned long long, std::string>> recent_;  // Rebuilt contents, most recent first
+    std::unordered_map<unsigned long long, std::list<std::pair<unsigned long long, std::string>>::iterator> recent_index_;
+    size_t recent_bytes_ = 0;
+    size_t recent_capacity_ = DEFAULT_REVISION_CACHE;
+
+    class Reader;
+    class Writer;
 
-    unsigned long long get_new_id();
     bool check_file(unsigned long long fid);
+    void ensure_loaded();
+    bool load_node(unsigned long long fid, fileNode& node);
+    unsigned long long store_chunk(const char* data, size_t length);
+    std::vector<unsigned long long> store_chunks(const std::string& content);
+    void release_chunks(const std::vector<unsigned long long>& chunks);
+    void spill_chunk(unsigned long long cid);
+    const std::string* chunk_data(unsigned long long cid, std::string& buffer);
+    bool chunk_size(unsigned long long cid, unsigned long long& size);
+    bool read_chunks(const std::vector<unsigned long long>& chunks, std::string& content);
+    bool read_content(unsigned long long fid, std::string& content);
+    bool has_chunks(unsigned long long fid, const std::vector<unsigned long long>& chunks);
+    bool find_file(const std::vector<unsigned long long>& chunks, unsigned long long& id);
+    void add_file(unsigned long long id, fvm::repositories::FileRecord file);
+    unsigned long long add_chunks(std::vector<unsigned long long> chunks);
+    bool make_delta(unsigned long long fid, const std::string& content, fvm::repositories::FileRecord& file);
+    void remember(unsigned long long fid, const std::string& content);
+    void forget(unsigned long long fid);
+    void drop_file(unsigned long long fid);
+    bool pin(unsigned long long fid);
+    void unpin(unsigned long long fid);
     bool save();
     bool load();
 
 public:
-    FileManager(fvm::interfaces::ILogger& logger, fvm::repositories::IFileManagerRepository& repository);
+    static constexpr size_t DEFAULT_REVISION_CACHE = 16 << 20;
+    static constexpr size_t MAX_DELTA_CONTENT = 1 << 20;
+
+    FileManager(fvm::interfaces::ILogger& logger, fvm::repositories::IFileManagerRepository& repository,
+                size_t average_chunk_size = fvm::Chunker::DEFAULT_AVERAGE);
     ~FileManager();
 
+    // Persist the changes since the last save; call before the Saver shuts down
+    bool shutdown();
+
+    // Store updated contents as deltas, with a full revision at least every interval; 0 turns it off
+    void set_delta_revisions(unsigned keyframe_interval);
+    unsigned get_delta_revisions() const { return keyframe_interval_; }
+    // Size budget of the cache of contents rebuilt from deltas
+    void set_revision_cache_capacity(size_t bytes);
+
     // Singleton accessor removed - use dependency injection instead
     unsigned long long create_file(const std::string& content = "") override;
     bool increase_counter(unsigned long long fid) override;
@@ -50,20 +151,63 @@ public:
     bool update_content(unsigned long long fid, unsigned long long& new_id, const std::string& content) override;
     bool get_content(unsigned long long fid, std::string& content) override;
     bool file_exist(unsigned long long fid) override;
+
+    /**
+     * @brief
+     * Readers hold a reference to their file and keep at most one chunk in memory that
+     * the FileManager does not already hold. A file stored as a delta is rebuilt whole,
+     * which only happens to files of at most MAX_DELTA_CONTENT bytes.
+     * Writers cut and store chunks as the content comes in, writing new chunks to the
+     * repository at once rather than keeping them until the next save. Neither may
+     * outlive the FileManager.
+     */
+    std::unique_ptr<fvm::interfaces::IContentReader> open_reader(unsigned long long fid) override;
+    std::unique_ptr<fvm::interfaces::IContentWriter> open_writer() override;
 };
 
+class FileManager::Reader : public fvm::interfaces::IContentReader {
+private:
+    FileManager& owner_;
+    unsigned long long fid_;
+    std::vector<unsigned long long> chunks_;
+    std::vector<size_t> ends_;   // Offset just past every chunk
+    bool whole_ = false;         // The content is rebuilt in content_ rather than read by chunk
+    std::string content_;
+    size_t current_ = SIZE_MAX;  // Chunk held in buffer_
+    std::string buffer_;
 
+public:
+    // Pins fid, unpinned on destruction
+    Reader(FileManager& owner, unsigned long long fid);
+    ~Reader() override;
 
-                        /* ====== FileManager ====== */
-unsigned long long FileManager::get_new_id() {
-    unsigned long long id;
-    do {
-        id = 1ULL * rand() * rand() * rand();
-    } while (mp.count(id));
-    return id;
-}
+    bool open();
+    size_t size() const override { return whole_ ? content_.size() : (ends_.empty() ? 0 : ends_.back()); }
+    size_t read_at(size_t offset, char* buffer, size_t length) override;
+};
+
+class FileManager::Writer : public fvm::interfaces::IContentWriter {
+private:
+    FileManager& owner_;
+    std::vector<unsigned long long> chunks_;
+    std::string pending_;  // Written but not yet cut into chunks
+    bool committed_ = false;
+
+    void store(const char* data, size_t length);
+
+public:
+    explicit Writer(FileManager& owner) : owner_(owner) {}
+    ~Writer() override;
+
+    bool write(const char* data, size_t length) override;
+    bool commit(unsigned long long& id) override;
+};
 
+
+
+                        /* ====== FileManager ====== */
 bool FileManager::file_exist(unsigned long long fid) {
+    ensure_loaded();
     if (!mp.count(fid)) {
         logger_.log("File id " + std::to_string(fid) + " does not exists. This is not normal. Please check if the procedure is correct.", fvm::interfaces::LogLevel::FATAL, __LINE__);
         return false;
@@ -80,17 +224,376 @@ bool FileManager::check_file(unsigned long long fid) {
     return true;
 }
 
+void FileManager::ensure_loaded() {
+    if (loaded_) return;
+    loaded_ = true;
+    if (!load()) {
+        logger_.log("FileManager: No saved files found (this is ok for first run)", fvm::interfaces::LogLevel::INFO, __LINE__);
+    }
+}
+
+bool FileManager::load_node(unsigned long long fid, fileNode& node) {
+    if (node.loaded) return true;
+    if (repository_.load_file(fid, node.file)) {
+        node.loaded = true;
+        return true;
+    }
+
+    // Saved before contents were chunked: chunk it now, the old record goes on the next save
+    std::string content;
+    if (!repository_.load_content(fid, content)) {
+        logger_.log("Failed to read the content of file " + std::to_string(fid) + ".", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return false;
+    }
+    node.file = fvm::repositories::FileRecord();
+    node.file.chunks = store_chunks(content);
+    node.loaded = true;
+    unsaved_.insert(fid);
+    legacy_.insert(fid);
+    return true;
+}
+
+unsigned long long FileManager::store_chunk(const char* data, size_t length) {
+    unsigned long long id = fvm::default_hasher().hash(reinterpret_cast<const uint8_t*>(data), length);
+    auto it = chunks_.find(id);
+    std::string buffer;
+    for (; it != chunks_.end(); it = chunks_.find(++id)) {
+        if (it->second.size != fvm::repositories::ChunkInfo::UNKNOWN_SIZE && it->second.size != length) continue;
+        // The same bytes are already stored: share them. A stored chunk is compared
+        // through the buffer, so rewriting a large file does not load all of it
+        const std::string* stored = chunk_data(id, buffer);
+        if (stored && stored->compare(0, std::string::npos, data, length) == 0) {
+            it->second.cnt++;
+            break;
+        }
+    }
+    if (it == chunks_.end()) {
+        chunks_[id] = chunkNode(std::string(data, length));
+        // An id dropped since the last save may have held other bytes before
+        removed_chunks_.erase(id);
+        unsaved_chunks_.insert(id);
+    }
+    chunk_index_dirty_ = true;
+    return id;
+}
+
+std::vector<unsigned long long> FileManager::store_chunks(const std::string& content) {
+    std::vector<unsigned long long> ids;
+    size_t offset = 0;
+    for (size_t length : chunker_.split(content)) {
+        ids.push_back(store_chunk(content.data() + offset, length));
+        offset += length;
+    }
+    return ids;
+}
+
+void FileManager::release_chunks(const std::vector<unsigned long long>& chunks) {
+    for (unsigned long long cid : chunks) {
+        auto it = chunks_.find(cid);
+        if (it == chunks_.end()) {
+            logger_.log("Chunk " + std::to_string(cid) + " does not exists.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+            continue;
+        }
+        if (--it->second.cnt > 0) continue;
+        chunks_.erase(it);
+        // A chunk never saved has nothing to remove from the repository
+        if (!unsaved_chunks_.erase(cid)) {
+            removed_chunks_.insert(cid);
+        }
+    }
+    chunk_index_dirty_ = true;
+}
+
+void FileManager::spill_chunk(unsigned long long cid) {
+    auto it = chunks_.find(cid);
+    // Only a chunk just created by this write, which nothing else can be reading
+    if (it == chunks_.end() || it->second.cnt != 1 || !unsaved_chunks_.count(cid)) return;
+    // If it cannot be written now, the next save tries again
+    if (!repository_.save_chunk(cid, it->second.data)) return;
+    unsaved_chunks_.erase(cid);
+    std::string().swap(it->second.data);
+    it->second.loaded = false;
+}
+
+const std::string* FileManager::chunk_data(unsigned long long cid, std::string& buffer) {
+    auto it = chunks_.find(cid);
+    if (it == chunks_.end()) {
+        logger_.log("Chunk " + std::to_string(cid) + " does not exists.", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return nullptr;
+    }
+    if (it->second.loaded) return &it->second.data;
+    // Read for the caller only, so streaming a file does not keep all of it in memory
+    if (!repository_.load_chunk(cid, buffer)) {
+        logger_.log("Failed to read chunk " + std::to_string(cid) + ".", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return nullptr;
+    }
+    it->second.size = buffer.size();
+    return &buffer;
+}
+
+bool FileManager::chunk_size(unsigned long long cid, unsigned long long& size) {
+    auto it = chunks_.find(cid);
+    if (it != chunks_.end() && it->second.size != fvm::repositories::ChunkInfo::UNKNOWN_SIZE) {
+        size = it->second.size;
+        return true;
+    }
+    // Indexes written before chunk sizes were recorded
+    std::string buffer;
+    const std::string* data = chunk_data(cid, buffer);
+    if (!data) return false;
+    size = data->size();
+    chunk_index_dirty_ = true;
+    return true;
+}
+
+bool FileManager::read_chunks(const std::vector<unsigned long long>& chunks, std::string& content) {
+    unsigned long long size = 0;
+    for (unsigned long long cid : chunks) {
+        auto it = chunks_.find(cid);
+        if (it != chunks_.end() && it->second.size != fvm::repositories::ChunkInfo::UNKNOWN_SIZE) size += it->second.size;
+    }
+
+    // Chunks not in memory are read through one buffer and not kept, so reading a file
+    // leaves no more of the store resident than before
+    content.clear();
+    content.reserve(size);
+    std::string buffer;
+    for (unsigned long long cid : chunks) {
+        const std::string* data = chunk_data(cid, buffer);
+        if (!data) return false;
+        content += *data;
+    }
+    return true;
+}
+
+bool FileManager::read_content(unsigned long long fid, std::string& content) {
+    fileNode& node = mp[fid];
+    if (!load_node(fid, node)) return false;
+    if (!node.file.delta) return read_chunks(node.file.chunks, content);
+
+    auto cached = recent_index_.find(fid);
+    if (cached != recent_index_.end()) {
+        recent_.splice(recent_.begin(), recent_, cached->second);
+        content = cached->second->second;
+        return true;
+    }
+
+    std::string base, delta;
+    if (!mp.count(node.file.base) || !read_content(node.file.base, base) || !read_chunks(node.file.chunks, delta)) {
+        logger_.log("Failed to read the base of file " + std::to_string(fid) + ".", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return false;
+    }
+    if (!fvm::delta::decode(base, delta, content)) {
+        logger_.log("The delta of file " + std::to_string(fid) + " does not apply to its base.", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return false;
+    }
+    remember(fid, content);
+    return true;
+}
+
+bool FileManager::has_chunks(unsigned long long fid, const std::vector<unsigned long long>& chunks) {
+    fileNode& node = mp[fid];
+    if (!load_node(fid, node)) return false;
+    if (!node.file.delta) return node.file.chunks == chunks;
+
+    // A delta has no chunk list of its content to compare, so compare the content
+    std::string stored, buffer;
+    if (!read_content(fid, stored)) return false;
+    size_t offset = 0;
+    for (unsigned long long cid : chunks) {
+        const std::string* data = chunk_data(cid, buffer);
+        if (!data || stored.compare(offset, data->size(), *data) != 0) return false;
+        offset += data->size();
+    }
+    return offset == stored.size();
+}
+
+bool FileManager::find_file(const std::vector<unsigned long long>& chunks, unsigned long long& id) {
+    std::string list;
+    list.reserve(chunks.size() * 8);
+    for (unsigned long long cid : chunks) fvm::put_u64(list, cid);
+    id = fvm::default_hasher().hash(list);
+    for (auto it = mp.find(id); it != mp.end(); it = mp.find(++id)) {
+        if (has_chunks(id, chunks)) return true;
+    }
+    return false;
+}
+
+void FileManager::add_file(unsigned long long id, fvm::repositories::FileRecord file) {
+    mp[id] = fileNode(std::move(file));
+    // An id dropped since the last save may have held other content before
+    removed_.erase(id);
+    unsaved_.insert(id);
+    index_dirty_ = true;
+}
+
+unsigned long long FileManager::add_chunks(std::vector<unsigned long long> chunks) {
+    unsigned long long id;
+    // The same content is already stored: share it, and give back the chunk references just taken
+    if (find_file(chunks, id)) {
+        release_chunks(chunks);
+        mp[id].cnt++;
+        index_dirty_ = true;
+        return id;
+    }
+
+    fvm::repositories::FileRecord file;
+    file.chunks = std::move(chunks);
+    add_file(id, std::move(file));
+    return id;
+}
+
+bool FileManager::make_delta(unsigned long long fid, const std::string& content, fvm::repositories::FileRecord& file) {
+    if (keyframe_interval_ == 0 || content.size() > MAX_DELTA_CONTENT) return false;
+    fileNode& node = mp[fid];
+    if (!load_node(fid, node)) return false;
+    unsigned depth = node.file.delta ? node.file.depth + 1 : 1;
+    if (depth >= keyframe_interval_) return false;
+    // A delta base is itself no larger, so only a full revision can be
+    if (!node.file.delta) {
+        unsigned long long size = 0, chunk;
+        for (unsigned long long cid : node.file.chunks) {
+            if (!chunk_size(cid, chunk)) return false;
+            size += chunk;
+        }
+        if (size > MAX_DELTA_CONTENT) return false;
+    }
+
+    std::string base;
+    if (!read_content(fid, base)) return false;
+    std::string delta = fvm::delta::encode(base, content);
+    // Not worth a chain to rebuild unless it saves most of the content
+    if (delta.size() * 2 > content.size()) return false;
+
+    file.chunks = store_chunks(delta);
+    file.delta = true;
+    file.base = fid;
+    file.depth = depth;
+    // The base lives as long as the delta needs it
+    node.cnt++;
+    index_dirty_ = true;
+    return true;
+}
+
+void FileManager::remember(unsigned long long fid, const std::string& content) {
+    if (content.size() > recent_capacity_) return;
+    forget(fid);
+    recent_.emplace_front(fid, content);
+    recent_index_[fid] = recent_.begin();
+    recent_bytes_ += content.size();
+    while (recent_bytes_ > recent_capacity_) {
+        forget(recent_.back().first);
+    }
+}
+
+void FileManager::forget(unsigned long long fid) {
+    auto it = recent_index_.find(fid);
+    if (it == recent_index_.end()) return;
+    recent_bytes_ -= it->second->second.size();
+    recent_.erase(it->second);
+    recent_index_.erase(it);
+}
+
+void FileManager::drop_file(unsigned long long fid) {
+    fileNode& node = mp[fid];
+    bool delta = false;
+    unsigned long long base = 0;
+    if (load_node(fid, node)) {
+        release_chunks(node.file.chunks);
+        delta = node.file.delta;
+        base = node.file.base;
+    } else {
+        logger_.log("FileManager: the chunks of file " + std::to_string(fid) + " are kept, its chunk list could not be read", fvm::interfaces::LogLevel::WARNING, __LINE__);
+    }
+    mp.erase(fid);
+    forget(fid);
+    // A file never saved has nothing to remove from the repository
+    if (!unsaved_.erase(fid)) {
+        removed_.insert(fid);
+    }
+    index_dirty_ = true;
+    if (delta) decrease_counter(base);
+}
+
 bool FileManager::save() {
-    return repository_.save(mp);
+    // Nothing was read, so nothing can have changed
+    if (!loaded_) return true;
+
+    // Chunks before the files listing them, files before the indexes, removals after them
+    for (auto it = unsaved_chunks_.begin(); it != unsaved_chunks_.end(); it = unsaved_chunks_.erase(it)) {
+        if (!repository_.save_chunk(*it, chunks_[*it].data)) return false;
+    }
+    for (auto it = unsaved_.begin(); it != unsaved_.end(); it = unsaved_.erase(it)) {
+        if (!repository_.save_file(*it, mp[*it].file)) return false;
+    }
+    if (chunk_index_dirty_) {
+        std::map<unsigned long long, fvm::repositories::ChunkInfo> index;
+        for (const auto& it : chunks_) {
+            fvm::repositories::ChunkInfo& info = index.emplace_hint(index.end(), it.first, fvm::repositories::ChunkInfo())->second;
+            info.refs = it.second.cnt;
+            info.size = it.second.size;
+        }
+        if (!repository_.save_chunk_index(index)) return false;
+        chunk_index_dirty_ = false;
+    }
+    if (index_dirty_) {
+        std::map<unsigned long long, unsigned long long> counters;
+        // A file only open readers still hold is saved with no references, for load() to
+        // collect should the readers never let it go
+        for (const auto& it : mp) {
+            counters.emplace_hint(counters.end(), it.first, it.second.cnt - it.second.pins);
+        }
+        if (!repository_.save_index(counters)) return false;
+        index_dirty_ = false;
+    }
+    for (auto it = removed_.begin(); it != removed_.end(); it = removed_.erase(it)) {
+        if (!repository_.remove_file(*it)) {
+            logger_.log("FileManager: Failed to remove file " + std::to_string(*it), fvm::interfaces::LogLevel::WARNING, __LINE__);
+        }
+    }
+    for (auto it = legacy_.begin(); it != legacy_.end(); it = legacy_.erase(it)) {
+        repository_.remove_content(*it);
+    }
+    for (auto it = removed_chunks_.begin(); it != removed_chunks_.end(); it = removed_chunks_.erase(it)) {
+        if (!repository_.remove_chunk(*it)) {
+            logger_.log("FileManager: Failed to remove chunk " + std::to_string(*it), fvm::interfaces::LogLevel::WARNING, __LINE__);
+        }
+    }
+    return true;
 }
 
 bool FileManager::load() {
-    return repository_.load(mp);
+    std::map<unsigned long long, fvm::repositories::ChunkInfo> index;
+    if (!repository_.load_chunk_index(index)) return false;
+    chunks_.clear();
+    for (const auto& it : index) {
+        chunkNode& chunk = chunks_[it.first];
+        chunk.cnt = it.second.refs;
+        chunk.size = it.second.size;
+        chunk.loaded = false;
+    }
+
+    std::map<unsigned long long, unsigned long long> counters;
+    if (!repository_.load_index(counters)) return false;
+    mp.clear();
+    for (const auto& it : counters) {
+        fileNode& node = mp[it.first];
+        node.cnt = it.second;
+        node.loaded = false;
+    }
+
+    // Released while a reader was open: give back its chunks and base now
+    for (const auto& it : counters) {
+        auto node = mp.find(it.first);
+        if (node != mp.end() && node->second.cnt == 0) drop_file(it.first);
+    }
+    return true;
 }
 
-FileManager::FileManager(fvm::interfaces::ILogger& logger, fvm::repositories::IFileManagerRepository& repository)
-    : logger_(logger), repository_(repository) {
-    if (!load()) return;
+FileManager::FileManager(fvm::interfaces::ILogger& logger, fvm::repositories::IFileManagerRepository& repository,
+                         size_t average_chunk_size)
+    : logger_(logger), repository_(repository), chunker_(average_chunk_size) {
+    // Loaded on first use, once the Saver has been initialized
 }
 
 FileManager::~FileManager() {
@@ -99,50 +602,218 @@ FileManager::~FileManager() {
     }
 }
 
+bool FileManager::shutdown() {
+    return save();
+}
+
 // Singleton accessor removed - use dependency injection instead
 
+void FileManager::set_delta_revisions(unsigned keyframe_interval) {
+    keyframe_interval_ = keyframe_interval;
+}
+
+void FileManager::set_revision_cache_capacity(size_t bytes) {
+    recent_capacity_ = bytes;
+    while (recent_bytes_ > recent_capacity_) {
+        forget(recent_.back().first);
+    }
+}
+
 unsigned long long FileManager::create_file(const std::string& content) {
-    unsigned long long id = get_new_id();
-    mp[id] = fileNode(content);
-    return id;
+    ensure_loaded();
+    return add_chunks(store_chunks(content));
 }
 
 bool FileManager::increase_counter(unsigned long long fid) {
+    ensure_loaded();
     if (!mp.count(fid)) {
         logger_.log("File id does not exists. Please check if the procedure is correct.", fvm::interfaces::LogLevel::FATAL, __LINE__);
         return false;
     }
     if (!check_file(fid)) return false;
     mp[fid].cnt ++;
+    index_dirty_ = true;
     return true;
 }
 
 bool FileManager::decrease_counter(unsigned long long fid) {
+    ensure_loaded();
     if (!mp.count(fid)) {
         logger_.log("File id does not exists. Please check if the procedure is correct.", fvm::interfaces::LogLevel::FATAL, __LINE__);
         return false;
     }
     if (!check_file(fid)) return false;
     if (mp[fid].cnt == 1) {
-        mp.erase(mp.find(fid));
+        drop_file(fid);
     } else {
         mp[fid].cnt--;
+        index_dirty_ = true;
     }
     return true;
 }
 
 bool FileManager::update_content(unsigned long long fid, unsigned long long& new_id, const std::string& content) {
     if (!file_exist(fid)) return false;
-    if (!decrease_counter(fid)) return false;
-    new_id = get_new_id();
-    mp[new_id].content = content;
-    mp[new_id].cnt = 1;
+    // Add the new content first, so an unchanged file is shared rather than dropped and stored again
+    std::vector<unsigned long long> chunks = store_chunks(content);
+    unsigned long long id;
+    if (find_file(chunks, id)) {
+        release_chunks(chunks);
+        mp[id].cnt++;
+        index_dirty_ = true;
+    } else {
+        fvm::repositories::FileRecord file;
+        if (make_delta(fid, content, file)) {
+            release_chunks(chunks);
+            // It is likely to be read next, and is costlier to rebuild than a full revision
+            remember(id, content);
+        } else {
+            file.chunks = std::move(chunks);
+        }
+        add_file(id, std::move(file));
+    }
+    if (!decrease_counter(fid)) {
+        decrease_counter(id);
+        return false;
+    }
+    new_id = id;
     return true;
 }
 
 bool FileManager::get_content(unsigned long long fid, std::string& content) {
     if (!file_exist(fid)) return false;
-    content = mp[fid].content;
+    return read_content(fid, content);
+}
+
+bool FileManager::pin(unsigned long long fid) {
+    ensure_loaded();
+    if (!check_file(fid)) return false;
+    // Readers come and go without changing what is persisted, so the index stays clean
+    mp[fid].cnt++;
+    mp[fid].pins++;
+    return true;
+}
+
+void FileManager::unpin(unsigned long long fid) {
+    auto it = mp.find(fid);
+    if (it == mp.end() || it->second.pins == 0) {
+        logger_.log("File " + std::to_string(fid) + " is not pinned.", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return;
+    }
+    it->second.pins--;
+    if (it->second.cnt == 1) {
+        drop_file(fid);
+    } else {
+        it->second.cnt--;
+    }
+}
+
+std::unique_ptr<fvm::interfaces::IContentReader> FileManager::open_reader(unsigned long long fid) {
+    if (!pin(fid)) return nullptr;
+    std::unique_ptr<Reader> reader(new Reader(*this, fid));
+    if (!reader->open()) return nullptr;
+    return reader;
+}
+
+std::unique_ptr<fvm::interfaces::IContentWriter> FileManager::open_writer() {
+    ensure_loaded();
+    return std::unique_ptr<fvm::interfaces::IContentWriter>(new Writer(*this));
+}
+
+                        /* ====== FileManager::Reader ====== */
+FileManager::Reader::Reader(FileManager& owner, unsigned long long fid) : owner_(owner), fid_(fid) {}
+
+FileManager::Reader::~Reader() {
+    owner_.unpin(fid_);
+}
+
+bool FileManager::Reader::open() {
+    fileNode& node = owner_.mp[fid_];
+    if (!owner_.load_node(fid_, node)) return false;
+    if (node.file.delta) {
+        whole_ = true;
+        return owner_.read_content(fid_, content_);
+    }
+
+    chunks_ = node.file.chunks;
+    ends_.reserve(chunks_.size());
+    size_t end = 0;
+    for (unsigned long long cid : chunks_) {
+        unsigned long long size;
+        if (!owner_.chunk_size(cid, size)) return false;
+        end += size;
+        ends_.push_back(end);
+    }
+    return true;
+}
+
+size_t FileManager::Reader::read_at(size_t offset, char* buffer, size_t length) {
+    if (whole_) {
+        if (offset >= content_.size()) return 0;
+        length = std::min(length, content_.size() - offset);
+        std::memcpy(buffer, content_.data() + offset, length);
+        return length;
+    }
+
+    size_t copied = 0;
+    size_t i = std::upper_bound(ends_.begin(), ends_.end(), offset) - ends_.begin();
+    for (; i < chunks_.size() && copied < length; i++) {
+        const std::string* data;
+        if (i == current_) {
+            data = &buffer_;
+        } else {
+            current_ = SIZE_MAX;
+            data = owner_.chunk_data(chunks_[i], buffer_);
+            if (!data) return copied;
+            if (data == &buffer_) current_ = i;
+        }
+        const size_t begin = ends_[i] - data->size();
+        const size_t from = offset + copied - begin;
+        const size_t count = std::min(length - copied, data->size() - from);
+        std::memcpy(buffer + copied, data->data() + from, count);
+        copied += count;
+    }
+    return copied;
+}
+
+                        /* ====== FileManager::Writer ====== */
+FileManager::Writer::~Writer() {
+    // Nothing was committed: drop the chunks stored so far
+    if (!committed_) owner_.release_chunks(chunks_);
+}
+
+void FileManager::Writer::store(const char* data, size_t length) {
+    chunks_.push_back(owner_.store_chunk(data, length));
+    owner_.spill_chunk(chunks_.back());
+}
+
+bool FileManager::Writer::write(const char* data, size_t length) {
+    if (committed_) return false;
+    pending_.append(data, length);
+
+    // A cut never looks further than the maximum chunk size, so cutting once that much
+    // is pending gives the same chunks as cutting the whole content
+    const size_t max = owner_.chunker_.get_max();
+    size_t offset = 0;
+    while (pending_.size() - offset >= max) {
+        size_t cut = owner_.chunker_.cut(pending_.data() + offset, pending_.size() - offset);
+        store(pending_.data() + offset, cut);
+        offset += cut;
+    }
+    pending_.erase(0, offset);
+    return true;
+}
+
+bool FileManager::Writer::commit(unsigned long long& id) {
+    if (committed_) return false;
+    size_t offset = 0;
+    for (size_t length : owner_.chunker_.split(pending_)) {
+        store(pending_.data() + offset, length);
+        offset += length;
+    }
+    std::string().swap(pending_);
+    committed_ = true;
+    id = owner_.add_chunks(std::move(chunks_));
     return true;
 }
 
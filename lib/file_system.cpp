@@ -21,6 +21,7 @@
 #include "logger.cpp"
 #include <ctime>
 #include <string>
+#include <memory>
 #include <stack>
 #include <vector>
 
@@ -167,6 +168,41 @@ private:
      */
     bool kmp(std::string str, std::string tar);
 
+    /**
+     * @brief
+     * Go to the file with the given name.
+     *
+     * @param name
+     * The name of the file.
+     *
+     * @return true
+     * path.back() is now the node of the file.
+     *
+     * @return false
+     * If the go_to function, check_path function returns an error or the name does not
+     * correspond to a file, the function will return an error.
+     */
+    bool go_to_file(const std::string& name);
+
+    /**
+     * @brief
+     * Replace the file at path.back() with a copy linked to another node, rebuilding the
+     * nodes along the path the way every modification does.
+     *
+     * @param link
+     * The node the copy links to, the one holding the new content.
+     *
+     * @return true
+     * The file now links to the new node.
+     *
+     * @return false
+     * If the rebuild_nodes function or decrease_counter function returns an error, then
+     * this function will also return an error.
+     */
+    bool relink_file(unsigned long long link);
+
+    class Writer;
+
 public:
     FileSystem(fvm::interfaces::ILogger& logger,
                fvm::interfaces::INodeManager& node_manager,
@@ -359,6 +395,34 @@ public:
      */
     bool get_content(const std::string& name, std::string& content) override;
 
+    /**
+     * @brief
+     * Read the content of a file in pieces, without loading all of it.
+     *
+     * @param name
+     * The name of the file you want to read.
+     *
+     * @return
+     * A reader over the content the file has now, which later changes do not affect.
+     * A null pointer if the name does not correspond to a file.
+     */
+    std::unique_ptr<fvm::interfaces::IContentReader> open_reader(const std::string& name) override;
+
+    /**
+     * @brief
+     * Write the new content of a file in pieces, without holding all of it in memory.
+     * The file is only modified when the writer commits, which works like update_content.
+     * The commit fails if the file was removed or changed since the writer was opened,
+     * or if the current directory is no longer the one the writer was opened in.
+     *
+     * @param name
+     * The name of the file you want to modify.
+     *
+     * @return
+     * The writer, or a null pointer if the name does not correspond to a file.
+     */
+    std::unique_ptr<fvm::interfaces::IContentWriter> open_writer(const std::string& name) override;
+
     /**
      * @brief 
      * This function will be used in conjunction with the travel_tree function.
@@ -555,6 +619,26 @@ public:
     int get_current_version() override;
 };
 
+/**
+ * @brief
+ * Streams into the node of a file, then relinks the file when committing.
+ */
+class FileSystem::Writer : public fvm::interfaces::IContentWriter {
+private:
+    FileSystem& owner_;
+    std::string name_;
+    unsigned long long link_;  // Node of the file when the writer was opened
+    std::unique_ptr<fvm::interfaces::IContentWriter> node_writer_;
+
+public:
+    Writer(FileSystem& owner, std::string name, unsigned long long link,
+           std::unique_ptr<fvm::interfaces::IContentWriter> node_writer)
+        : owner_(owner), name_(std::move(name)), link_(link), node_writer_(std::move(node_writer)) {}
+
+    bool write(const char* data, size_t length) override;
+    bool commit(unsigned long long& id) override;
+};
+
 
 
 
@@ -768,11 +852,11 @@ bool FileSystem::make_file(const std::string& name) {
         logger_.log(name + ": Name exist.");
         return false;
     }
-    if (!goto_tail()) return false;
 
-    // Get parent directory node before rebuild_nodes modifies path
-    // After goto_tail(), path.back() is the last sibling, parent is at size()-2
+    // Get parent directory node before goto_tail and rebuild_nodes modify path
+    // After name_exist(), path.back() is the HEAD_NODE, parent is at size()-2
     fvm::treeNode* parent_dir = (path.size() >= 2) ? path[path.size() - 2] : nullptr;
+    if (!goto_tail()) return false;
 
     fvm::treeNode *t = new fvm::treeNode(fvm::FILE_NODE);
     t->link = node_manager_.get_new_node(name);
@@ -794,11 +878,11 @@ bool FileSystem::make_dir(const std::string& name) {
         logger_.log(name + ": Name exist.");
         return false;
     }
-    if (!goto_tail()) return false;
 
-    // Get parent directory node before rebuild_nodes modifies path
-    // After goto_tail(), path.back() is the last sibling, parent is at size()-2
+    // Get parent directory node before goto_tail and rebuild_nodes modify path
+    // After name_exist(), path.back() is the HEAD_NODE, parent is at size()-2
     fvm::treeNode* parent_dir = (path.size() >= 2) ? path[path.size() - 2] : nullptr;
+    if (!goto_tail()) return false;
 
     fvm::treeNode *t = new fvm::treeNode(fvm::DIR_NODE);
     if (t == nullptr) {
@@ -928,13 +1012,28 @@ bool FileSystem::update_name(const std::string& fr_name, const std::string& to_n
     return true;
 }
 
-bool FileSystem::update_content(const std::string& name, const std::string& content) {
+bool FileSystem::go_to_file(const std::string& name) {
     if (!go_to(name)) return false;
     if (!check_path()) return false;
     if (path.back()->type != fvm::FILE_NODE) {
         logger_.log(name + ": Not a file.");
         return false;
     }
+    // A lookup through the child index jumps straight from the head to the file, but
+    // rebuild_nodes needs every brother in between on the path
+    fvm::treeNode *file = path.back();
+    path.pop_back();
+    while (path.back() != file) {
+        if (path.back()->next_brother == nullptr) {
+            logger_.log(name + ": Not linked from its directory.", fvm::interfaces::LogLevel::FATAL, __LINE__);
+            return false;
+        }
+        path.push_back(path.back()->next_brother);
+    }
+    return true;
+}
+
+bool FileSystem::relink_file(unsigned long long link) {
     fvm::treeNode *back = path.back();
     fvm::treeNode *t = new fvm::treeNode();
     if (t == nullptr) {
@@ -943,27 +1042,52 @@ bool FileSystem::update_content(const std::string& name, const std::string& cont
     }
     *t = *back;
     t->cnt = 1;
-    t->link = node_manager_.update_content(t->link, content);
+    t->link = link;
     path.pop_back();
     if (!rebuild_nodes(t)) {
         delete t;
         return false;
     }
     if (!decrease_counter(back)) return false;
+
+    // OPTIMIZATION: The directory's child_index still points to the replaced nodes,
+    // drop it so the next lookup rebuilds it
+    for (size_t i = path.size() - 1; i > 0; i--) {
+        if (path[i]->type == fvm::HEAD_NODE) {
+            delete path[i - 1]->child_index;
+            path[i - 1]->child_index = nullptr;
+            break;
+        }
+    }
     return true;
 }
 
+bool FileSystem::update_content(const std::string& name, const std::string& content) {
+    if (!go_to_file(name)) return false;
+    unsigned long long link = node_manager_.update_content(path.back()->link, content);
+    if (link == (unsigned long long)-1) return false;
+    return relink_file(link);
+}
+
 bool FileSystem::get_content(const std::string& name, std::string& content) {
-    if (!go_to(name)) return false;
-    if (!check_path()) return false;
-    if (path.back()->type != fvm::FILE_NODE) {
-        logger_.log(name + ": Not a file.");
-        return false;
-    }
+    if (!go_to_file(name)) return false;
     content = node_manager_.get_content(path.back()->link);
     return true;
 }
 
+std::unique_ptr<fvm::interfaces::IContentReader> FileSystem::open_reader(const std::string& name) {
+    if (!go_to_file(name)) return nullptr;
+    return node_manager_.open_reader(path.back()->link);
+}
+
+std::unique_ptr<fvm::interfaces::IContentWriter> FileSystem::open_writer(const std::string& name) {
+    if (!go_to_file(name)) return nullptr;
+    unsigned long long link = path.back()->link;
+    std::unique_ptr<fvm::interfaces::IContentWriter> node_writer = node_manager_.open_writer(link);
+    if (!node_writer) return nullptr;
+    return std::unique_ptr<fvm::interfaces::IContentWriter>(new Writer(*this, name, link, std::move(node_writer)));
+}
+
 bool FileSystem::tree(std::string& tree_info) {
     if (!check_path()) return false;
     if (!travel_tree(path.front(), tree_info, 1)) return false;
@@ -1026,6 +1150,20 @@ bool FileSystem::Find(const std::string& name, std::vector<std::pair<std::string
     return true;
 }
 
+bool FileSystem::Writer::write(const char* data, size_t length) {
+    return node_writer_->write(data, length);
+}
+
+bool FileSystem::Writer::commit(unsigned long long& id) {
+    if (!owner_.go_to_file(name_)) return false;
+    if (owner_.path.back()->link != link_) {
+        owner_.logger_.log(name_ + ": Changed since it was opened for writing.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+        return false;
+    }
+    if (!node_writer_->commit(id)) return false;
+    return owner_.relink_file(id);
+}
+
 int FileSystem::get_current_version() {
     return CURRENT_VERSION;
 }
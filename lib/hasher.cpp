@@ -0,0 +1,415 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+#ifndef HASHER_CPP
+#define HASHER_CPP
+
+#include "fvm/hasher.h"
+#include "fvm/saver_constants.h"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FVM_HASH_X86 1
+#include <immintrin.h>
+#else
+#define FVM_HASH_X86 0
+#endif
+
+namespace fvm {
+
+namespace {
+
+constexpr uint64_t PRIME32_1 = 0x9E3779B1u;
+constexpr uint64_t PRIME32_2 = 0x85EBCA77u;
+constexpr uint64_t PRIME32_3 = 0xC2B2AE3Du;
+constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+constexpr uint64_t PRIME_MX1 = 0x165667919E3779F9ull;
+constexpr uint64_t PRIME_MX2 = 0x9FB21C651E98DF25ull;
+
+constexpr size_t STRIPE_LEN = 64;
+constexpr size_t SECRET_SIZE = 192;
+constexpr size_t SECRET_CONSUME_RATE = 8;
+constexpr size_t STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE_LEN) / SECRET_CONSUME_RATE;
+constexpr size_t BLOCK_LEN = STRIPE_LEN * STRIPES_PER_BLOCK;
+
+// Default secret of the reference implementation
+alignas(64) constexpr uint8_t SECRET[SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// The format is defined on little-endian words
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+inline uint64_t rotl64(uint64_t v, int r) { return (v << r) | (v >> (64 - r)); }
+
+inline uint64_t mul128_fold64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t lo_lo = (a & 0xffffffffu) * (b & 0xffffffffu);
+    uint64_t hi_lo = (a >> 32) * (b & 0xffffffffu);
+    uint64_t lo_hi = (a & 0xffffffffu) * (b >> 32);
+    uint64_t hi_hi = (a >> 32) * (b >> 32);
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffu) + lo_hi;
+    uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    uint64_t lower = (cross << 32) | (lo_lo & 0xffffffffu);
+    return lower ^ upper;
+#endif
+}
+
+inline uint64_t xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= PRIME_MX1;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t rrmxmx(uint64_t h, uint64_t len) {
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= PRIME_MX2;
+    h ^= (h >> 35) + len;
+    h *= PRIME_MX2;
+    return h ^ (h >> 28);
+}
+
+inline uint64_t mix16(const uint8_t* input, const uint8_t* secret) {
+    return mul128_fold64(read64(input) ^ read64(secret), read64(input + 8) ^ read64(secret + 8));
+}
+
+uint64_t hash_0_to_16(const uint8_t* input, size_t len) {
+    if (len > 8) {
+        uint64_t lo = read64(input) ^ (read64(SECRET + 24) ^ read64(SECRET + 32));
+        uint64_t hi = read64(input + len - 8) ^ (read64(SECRET + 40) ^ read64(SECRET + 48));
+        uint64_t acc = len + __builtin_bswap64(lo) + hi + mul128_fold64(lo, hi);
+        return xxh3_avalanche(acc);
+    }
+    if (len >= 4) {
+        uint64_t combined = read32(input + len - 4) + (static_cast<uint64_t>(read32(input)) << 32);
+        return rrmxmx(combined ^ (read64(SECRET + 8) ^ read64(SECRET + 16)), len);
+    }
+    if (len > 0) {
+        uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) |
+                            (static_cast<uint32_t>(input[len >> 1]) << 24) |
+                            static_cast<uint32_t>(input[len - 1]) |
+                            (static_cast<uint32_t>(len) << 8);
+        return xxh64_avalanche(combined ^ static_cast<uint64_t>(read32(SECRET) ^ read32(SECRET + 4)));
+    }
+    return xxh64_avalanche(read64(SECRET + 56) ^ read64(SECRET + 64));
+}
+
+uint64_t hash_17_to_128(const uint8_t* input, size_t len) {
+    uint64_t acc = len * PRIME64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += mix16(input + 48, SECRET + 96);
+                acc += mix16(input + len - 64, SECRET + 112);
+            }
+            acc += mix16(input + 32, SECRET + 64);
+            acc += mix16(input + len - 48, SECRET + 80);
+        }
+        acc += mix16(input + 16, SECRET + 32);
+        acc += mix16(input + len - 32, SECRET + 48);
+    }
+    acc += mix16(input, SECRET);
+    acc += mix16(input + len - 16, SECRET + 16);
+    return xxh3_avalanche(acc);
+}
+
+uint64_t hash_129_to_240(const uint8_t* input, size_t len) {
+    constexpr size_t START_OFFSET = 3, LAST_OFFSET = 17;
+    uint64_t acc = len * PRIME64_1;
+    for (size_t i = 0; i < 8; i++) {
+        acc += mix16(input + 16 * i, SECRET + 16 * i);
+    }
+    acc = xxh3_avalanche(acc);
+    for (size_t i = 8; i < len / 16; i++) {
+        acc += mix16(input + 16 * i, SECRET + 16 * (i - 8) + START_OFFSET);
+    }
+    acc += mix16(input + len - 16, SECRET + 136 - LAST_OFFSET);
+    return xxh3_avalanche(acc);
+}
+
+/*
+ * Long inputs keep eight 64-bit accumulators. Each stripe adds, per lane i,
+ * the stripe word to lane i^1 and the product of the two halves of
+ * (word ^ secret word) to lane i; after every block the lanes are scrambled.
+ * The lanes are independent, which is what the SIMD kernels exploit.
+ */
+using AccumulateKernel = void (*)(uint64_t* acc, const uint8_t* input, const uint8_t* secret,
+                                  size_t stripes);
+using ScrambleKernel = void (*)(uint64_t* acc, const uint8_t* secret);
+
+void accumulate_scalar(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    for (size_t s = 0; s < stripes; s++) {
+        const uint8_t* in = input + s * STRIPE_LEN;
+        const uint8_t* key = secret + s * SECRET_CONSUME_RATE;
+        for (size_t i = 0; i < 8; i++) {
+            uint64_t data = read64(in + 8 * i);
+            uint64_t data_key = data ^ read64(key + 8 * i);
+            acc[i ^ 1] += data;
+            acc[i] += (data_key & 0xffffffffu) * (data_key >> 32);
+        }
+    }
+}
+
+void scramble_scalar(uint64_t* acc, const uint8_t* secret) {
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= read64(secret + 8 * i);
+        acc[i] = a * PRIME32_1;
+    }
+}
+
+#if FVM_HASH_X86
+
+void accumulate_sse2(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    __m128i a[4];
+    for (int i = 0; i < 4; i++) a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+    for (size_t s = 0; s < stripes; s++) {
+        const __m128i* in = reinterpret_cast<const __m128i*>(input + s * STRIPE_LEN);
+        const __m128i* key = reinterpret_cast<const __m128i*>(secret + s * SECRET_CONSUME_RATE);
+        for (int i = 0; i < 4; i++) {
+            __m128i data = _mm_loadu_si128(in + i);
+            __m128i data_key = _mm_xor_si128(data, _mm_loadu_si128(key + i));
+            __m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i product = _mm_mul_epu32(data_key, data_key_hi);
+            __m128i data_swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, data_swap));
+        }
+    }
+    for (int i = 0; i < 4; i++) _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, a[i]);
+}
+
+void scramble_sse2(uint64_t* acc, const uint8_t* secret) {
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+    for (int i = 0; i < 4; i++) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+        a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+        a = _mm_xor_si128(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+        __m128i a_hi = _mm_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i product_lo = _mm_mul_epu32(a, prime);
+        __m128i product_hi = _mm_mul_epu32(a_hi, prime);
+        a = _mm_add_epi64(product_lo, _mm_slli_epi64(product_hi, 32));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, a);
+    }
+}
+
+__attribute__((target("avx2")))
+void accumulate_avx2(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    __m256i a[2];
+    for (int i = 0; i < 2; i++) a[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+    for (size_t s = 0; s < stripes; s++) {
+        const __m256i* in = reinterpret_cast<const __m256i*>(input + s * STRIPE_LEN);
+        const __m256i* key = reinterpret_cast<const __m256i*>(secret + s * SECRET_CONSUME_RATE);
+        for (int i = 0; i < 2; i++) {
+            __m256i data = _mm256_loadu_si256(in + i);
+            __m256i data_key = _mm256_xor_si256(data, _mm256_loadu_si256(key + i));
+            __m256i data_key_hi = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+            __m256i product = _mm256_mul_epu32(data_key, data_key_hi);
+            __m256i data_swap = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm256_add_epi64(a[i], _mm256_add_epi64(product, data_swap));
+        }
+    }
+    for (int i = 0; i < 2; i++) _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, a[i]);
+}
+
+__attribute__((target("avx2")))
+void scramble_avx2(uint64_t* acc, const uint8_t* secret) {
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+    for (int i = 0; i < 2; i++) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+        a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+        a = _mm256_xor_si256(a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+        __m256i a_hi = _mm256_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1));
+        __m256i product_lo = _mm256_mul_epu32(a, prime);
+        __m256i product_hi = _mm256_mul_epu32(a_hi, prime);
+        a = _mm256_add_epi64(product_lo, _mm256_slli_epi64(product_hi, 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, a);
+    }
+}
+
+#endif // FVM_HASH_X86
+
+struct LongKernels {
+    AccumulateKernel accumulate;
+    ScrambleKernel scramble;
+};
+
+const LongKernels& long_kernels() {
+    static const LongKernels kernels = [] {
+#if FVM_HASH_X86
+        if (__builtin_cpu_supports("avx2")) return LongKernels{accumulate_avx2, scramble_avx2};
+        if (__builtin_cpu_supports("sse2")) return LongKernels{accumulate_sse2, scramble_sse2};
+#endif
+        return LongKernels{accumulate_scalar, scramble_scalar};
+    }();
+    return kernels;
+}
+
+/*
+ * Inputs are either bytes or integer sequences holding one byte per element.
+ * Integer sequences are narrowed a block at a time into a buffer on the
+ * stack, so hashing them needs no copy of the whole input.
+ */
+inline const uint8_t* as_bytes(const uint8_t* input, size_t, uint8_t*) {
+    return input;
+}
+
+inline const uint8_t* as_bytes(const int* input, size_t len, uint8_t* buffer) {
+    size_t i = 0;
+#if FVM_HASH_X86 && defined(__SSE2__)
+    // Keep the low byte of each element, then pack 16 elements into 16 bytes
+    const __m128i low_byte = _mm_set1_epi32(0xff);
+    for (; i < (len & ~static_cast<size_t>(15)); i += 16) {
+        const __m128i* in = reinterpret_cast<const __m128i*>(input + i);
+        __m128i a = _mm_and_si128(_mm_loadu_si128(in), low_byte);
+        __m128i b = _mm_and_si128(_mm_loadu_si128(in + 1), low_byte);
+        __m128i c = _mm_and_si128(_mm_loadu_si128(in + 2), low_byte);
+        __m128i d = _mm_and_si128(_mm_loadu_si128(in + 3), low_byte);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i), packed);
+    }
+#endif
+    for (; i < len; i++) {
+        buffer[i] = static_cast<uint8_t>(input[i]);
+    }
+    return buffer;
+}
+
+template <class T>
+uint64_t hash_long(const T* input, size_t len) {
+    alignas(32) uint64_t acc[8] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                                   PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+    const LongKernels& kernels = long_kernels();
+    uint8_t buffer[BLOCK_LEN];
+
+    const size_t blocks = (len - 1) / BLOCK_LEN;
+    for (size_t b = 0; b < blocks; b++) {
+        kernels.accumulate(acc, as_bytes(input + b * BLOCK_LEN, BLOCK_LEN, buffer), SECRET, STRIPES_PER_BLOCK);
+        kernels.scramble(acc, SECRET + SECRET_SIZE - STRIPE_LEN);
+    }
+
+    // Remaining full stripes, then the last 64 bytes, which may overlap them
+    const size_t stripes = ((len - 1) - BLOCK_LEN * blocks) / STRIPE_LEN;
+    kernels.accumulate(acc, as_bytes(input + blocks * BLOCK_LEN, stripes * STRIPE_LEN, buffer), SECRET, stripes);
+    constexpr size_t LAST_ACC_START = 7;
+    kernels.accumulate(acc, as_bytes(input + len - STRIPE_LEN, STRIPE_LEN, buffer),
+                       SECRET + SECRET_SIZE - STRIPE_LEN - LAST_ACC_START, 1);
+
+    // Merge the lanes
+    constexpr size_t MERGE_ACCS_START = 11;
+    uint64_t result = len * PRIME64_1;
+    for (size_t i = 0; i < 4; i++) {
+        const uint8_t* key = SECRET + MERGE_ACCS_START + 16 * i;
+        result += mul128_fold64(acc[2 * i] ^ read64(key), acc[2 * i + 1] ^ read64(key + 8));
+    }
+    return xxh3_avalanche(result);
+}
+
+uint64_t hash_short(const uint8_t* input, size_t len) {
+    if (len <= 16) return hash_0_to_16(input, len);
+    if (len <= 128) return hash_17_to_128(input, len);
+    return hash_129_to_240(input, len);
+}
+
+constexpr size_t MAX_SHORT_LEN = 240;
+
+} // namespace
+
+unsigned long long PolynomialHasher::hash(const uint8_t* data, size_t size) const {
+    unsigned long long hash = 0;
+    for (size_t i = 0; i < size; i++) {
+        hash = hash * DEFAULT_HASH_SEED + data[i];
+    }
+    return hash;
+}
+
+unsigned long long PolynomialHasher::hash(const std::vector<int>& data) const {
+    unsigned long long hash = 0;
+    for (int value : data) {
+        hash = hash * DEFAULT_HASH_SEED + value;
+    }
+    return hash;
+}
+
+unsigned long long Xxh3Hasher::hash(const uint8_t* data, size_t size) const {
+    if (size <= MAX_SHORT_LEN) return hash_short(data, size);
+    return hash_long(data, size);
+}
+
+unsigned long long Xxh3Hasher::hash(const std::vector<int>& data) const {
+    if (data.size() <= MAX_SHORT_LEN) {
+        uint8_t buffer[MAX_SHORT_LEN];
+        return hash_short(as_bytes(data.data(), data.size(), buffer), data.size());
+    }
+    return hash_long(data.data(), data.size());
+}
+
+const interfaces::IHasher* get_hasher(unsigned version) {
+    static const PolynomialHasher polynomial;
+    static const Xxh3Hasher xxh3;
+    switch (version) {
+        case HASH_POLYNOMIAL:
+            return &polynomial;
+        case HASH_XXH3:
+            return &xxh3;
+        default:
+            return nullptr;
+    }
+}
+
+const interfaces::IHasher& default_hasher() {
+    return *get_hasher(HASH_XXH3);
+}
+
+} // namespace fvm
+
+#endif // HASHER_CPP
@@ -0,0 +1,122 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+#ifndef LOAD_CACHE_CPP
+#define LOAD_CACHE_CPP
+
+#include "fvm/load_cache.h"
+
+namespace fvm {
+
+LoadCache::LoadCache(size_t capacity_bytes) : capacity_(capacity_bytes) {}
+
+void LoadCache::set_capacity(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = bytes;
+    evict_locked();
+}
+
+size_t LoadCache::get_capacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_;
+}
+
+LoadCache::Value LoadCache::get(unsigned long long name_hash, unsigned long long data_hash) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name_hash);
+    if (it == index_.end()) {
+        misses_++;
+        return nullptr;
+    }
+    if (it->second->data_hash != data_hash) {
+        // Decoded from a version of the record that has since been replaced
+        erase_locked(it->second);
+        misses_++;
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->value;
+}
+
+void LoadCache::put(unsigned long long name_hash, unsigned long long data_hash, Value value) {
+    if (!value) return;
+    const size_t bytes = footprint(*value);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name_hash);
+    if (it != index_.end()) {
+        erase_locked(it->second);
+    }
+    if (bytes > capacity_) return;
+
+    lru_.push_front(Entry{name_hash, data_hash, std::move(value), bytes});
+    index_[name_hash] = lru_.begin();
+    bytes_ += bytes;
+    evict_locked();
+}
+
+void LoadCache::invalidate(unsigned long long name_hash) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name_hash);
+    if (it != index_.end()) {
+        erase_locked(it->second);
+    }
+}
+
+void LoadCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+interfaces::LoadCacheStats LoadCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    interfaces::LoadCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entries = lru_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+size_t LoadCache::footprint(const interfaces::vvs& value) {
+    size_t bytes = sizeof(interfaces::vvs) + value.capacity() * sizeof(std::vector<std::string>);
+    for (const auto& row : value) {
+        bytes += row.capacity() * sizeof(std::string);
+        for (const auto& cell : row) {
+            // Short strings live inside the std::string itself
+            const char* inline_begin = reinterpret_cast<const char*>(&cell);
+            if (cell.data() < inline_begin || cell.data() >= inline_begin + sizeof(std::string)) {
+                bytes += cell.capacity() + 1;
+            }
+        }
+    }
+    return bytes;
+}
+
+void LoadCache::erase_locked(std::list<Entry>::iterator it) {
+    bytes_ -= it->bytes;
+    index_.erase(it->name_hash);
+    lru_.erase(it);
+}
+
+void LoadCache::evict_locked() {
+    while (bytes_ > capacity_ && !lru_.empty()) {
+        erase_locked(std::prev(lru_.end()));
+        evictions_++;
+    }
+}
+
+} // namespace fvm
+
+#endif // LOAD_CACHE_CPP
@@ -0,0 +1,169 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+
+#ifndef LZ_CODEC_CPP
+#define LZ_CODEC_CPP
+
+#include "fvm/lz_codec.h"
+#include "fvm/byte_order.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace fvm {
+namespace lz {
+
+namespace {
+
+/**
+ * @brief
+ * Layout: u32 decompressed size, then sequences. A sequence is a token byte whose high
+ * nibble is the literal count and low nibble the match length minus MIN_MATCH (15 means
+ * more follows in bytes of 255 and a last one below it), the literals, a u16 offset
+ * back from the current position and the rest of the match length. The last sequence
+ * stops after its literals.
+ */
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr unsigned HASH_BITS = 14;
+constexpr size_t MIN_INPUT = 32;   // Shorter data never gets smaller
+constexpr unsigned SKIP_SHIFT = 6; // After 2^6 misses in a row, look at every other position, and so on
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+unsigned hash32(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void put_length(std::string& out, size_t length) {
+    for (; length >= 255; length -= 255) out.push_back(static_cast<char>(255));
+    out.push_back(static_cast<char>(length));
+}
+
+bool get_length(const uint8_t* data, size_t size, size_t& pos, size_t& length) {
+    for (;;) {
+        if (pos >= size) return false;
+        uint8_t byte = data[pos++];
+        length += byte;
+        if (byte != 255) return true;
+    }
+}
+
+void put_sequence(std::string& out, const uint8_t* literals, size_t literal_count, size_t offset, size_t match) {
+    const size_t extra = match - MIN_MATCH;
+    out.push_back(static_cast<char>((std::min<size_t>(literal_count, 15) << 4) | std::min<size_t>(extra, 15)));
+    if (literal_count >= 15) put_length(out, literal_count - 15);
+    out.append(reinterpret_cast<const char*>(literals), literal_count);
+    out.push_back(static_cast<char>(offset));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (extra >= 15) put_length(out, extra - 15);
+}
+
+} // namespace
+
+bool compress(const uint8_t* data, size_t size, std::string& out) {
+    if (size < MIN_INPUT || size > UINT32_MAX) return false;
+    out.clear();
+    out.reserve(size);
+    put_u32(out, static_cast<uint32_t>(size));
+
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);  // Position + 1 of the last sequence with a hash
+    size_t anchor = 0;  // Start of the literals not yet written
+    size_t pos = 0;
+    size_t misses = 0;
+    while (pos + MIN_MATCH <= size) {
+        const uint32_t sequence = read32(data + pos);
+        uint32_t& slot = table[hash32(sequence)];
+        const size_t candidate = slot;
+        slot = static_cast<uint32_t>(pos + 1);
+        if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET || read32(data + candidate - 1) != sequence) {
+            pos += 1 + (misses++ >> SKIP_SHIFT);
+            continue;
+        }
+
+        size_t match_pos = candidate - 1;
+        size_t length = MIN_MATCH;
+        while (pos + length < size && data[match_pos + length] == data[pos + length]) length++;
+        while (pos > anchor && match_pos > 0 && data[match_pos - 1] == data[pos - 1]) {
+            pos--;
+            match_pos--;
+            length++;
+        }
+        put_sequence(out, data + anchor, pos - anchor, pos - match_pos, length);
+        if (out.size() >= size) return false;
+
+        pos += length;
+        anchor = pos;
+        misses = 0;
+        // Index a position inside the match as well, for repeats that start there
+        if (pos + 2 <= size) {
+            table[hash32(read32(data + pos - 2))] = static_cast<uint32_t>(pos - 1);
+        }
+    }
+
+    // Trailing literals, in a sequence without a match
+    const size_t literal_count = size - anchor;
+    out.push_back(static_cast<char>(std::min<size_t>(literal_count, 15) << 4));
+    if (literal_count >= 15) put_length(out, literal_count - 15);
+    out.append(reinterpret_cast<const char*>(data + anchor), literal_count);
+    return out.size() < size;
+}
+
+bool decompress(const uint8_t* data, size_t size, std::string& out) {
+    if (size < 4) return false;
+    const size_t total = get_u32(reinterpret_cast<const char*>(data));
+    std::string result;
+    // The size comes from the block, so it is trusted no further than the block can expand
+    result.reserve(std::min(total, size * 255));
+
+    size_t pos = 4;
+    bool finished = false;
+    while (pos < size) {
+        const uint8_t token = data[pos++];
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !get_length(data, size, pos, literal_count)) return false;
+        if (literal_count > size - pos || literal_count > total - result.size()) return false;
+        result.append(reinterpret_cast<const char*>(data + pos), literal_count);
+        pos += literal_count;
+        if (pos == size) {
+            // The last sequence has no match
+            finished = true;
+            break;
+        }
+
+        if (size - pos < 2) return false;
+        const size_t offset = data[pos] | static_cast<size_t>(data[pos + 1]) << 8;
+        pos += 2;
+        size_t length = token & 15;
+        if (length == 15 && !get_length(data, size, pos, length)) return false;
+        length += MIN_MATCH;
+        if (offset == 0 || offset > result.size() || length > total - result.size()) return false;
+        const size_t from = result.size() - offset;
+        if (offset >= length) {
+            result.append(result, from, length);
+        } else {
+            // The copy overlaps what it produces, so it goes byte by byte
+            for (size_t i = 0; i < length; i++) result.push_back(result[from + i]);
+        }
+    }
+    if (!finished || result.size() != total) return false;
+    out = std::move(result);
+    return true;
+}
+
+} // namespace lz
+} // namespace fvm
+
+#endif // LZ_CODEC_CPP
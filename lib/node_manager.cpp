@@ -24,6 +24,7 @@
 #include <cstdlib>
 #include <string>
 #include <map>
+#include <memory>
 
 namespace fvm {
 
@@ -56,6 +57,8 @@ private:
     fvm::interfaces::ILogger& logger_;
     fvm::interfaces::ISystemClock* clock_;  // System clock for time generation
 
+    class Writer;
+
     unsigned long long get_new_id();
     bool load();
     bool save();
@@ -84,6 +87,27 @@ public:
     std::string get_create_time(unsigned long long idx) override;
     void increase_counter(unsigned long long idx) override;
     unsigned long long _get_counter(unsigned long long idx) override;
+    std::unique_ptr<fvm::interfaces::IContentReader> open_reader(unsigned long long idx) override;
+    std::unique_ptr<fvm::interfaces::IContentWriter> open_writer(unsigned long long idx) override;
+};
+
+/**
+ * @brief
+ * Streams the content into the FileManager, then replaces the node the way
+ * update_content() does. The node must still exist when committing.
+ */
+class NodeManager::Writer : public fvm::interfaces::IContentWriter {
+private:
+    NodeManager& owner_;
+    unsigned long long idx_;
+    std::unique_ptr<fvm::interfaces::IContentWriter> file_writer_;
+
+public:
+    Writer(NodeManager& owner, unsigned long long idx, std::unique_ptr<fvm::interfaces::IContentWriter> file_writer)
+        : owner_(owner), idx_(idx), file_writer_(std::move(file_writer)) {}
+
+    bool write(const char* data, size_t length) override;
+    bool commit(unsigned long long& id) override;
 };
 
 
@@ -191,12 +215,20 @@ unsigned long long NodeManager::update_content(unsigned long long idx, const std
     if (!node_exist(idx)) return -1;
     std::string name = get_name(idx);
     std::string create_time = get_update_time(idx);
+    // Update from the current file, so it can become the base of the new one.
+    // update_content() gives back the reference it is passed, the node keeps its own
+    unsigned long long fid = mp.find(idx)->second.second.fid, new_fid;
+    file_manager_.increase_counter(fid);
+    if (!file_manager_.update_content(fid, new_fid, content)) {
+        file_manager_.decrease_counter(fid);
+        return -1;
+    }
     delete_node(idx);
     idx = get_new_node(name);
 
     auto it = mp.find(idx);
-    unsigned long long fid = it->second.second.fid;
-    file_manager_.update_content(it->second.second.fid, it->second.second.fid, content);
+    file_manager_.decrease_counter(it->second.second.fid);
+    it->second.second.fid = new_fid;
     return idx;
 }
 
@@ -248,6 +280,41 @@ unsigned long long NodeManager::_get_counter(unsigned long long idx) {
     return mp.find(idx)->second.first;
 }
 
+std::unique_ptr<fvm::interfaces::IContentReader> NodeManager::open_reader(unsigned long long idx) {
+    if (!node_exist(idx)) return nullptr;
+    return file_manager_.open_reader(mp.find(idx)->second.second.fid);
+}
+
+std::unique_ptr<fvm::interfaces::IContentWriter> NodeManager::open_writer(unsigned long long idx) {
+    if (!node_exist(idx)) return nullptr;
+    std::unique_ptr<fvm::interfaces::IContentWriter> file_writer = file_manager_.open_writer();
+    if (!file_writer) return nullptr;
+    return std::unique_ptr<fvm::interfaces::IContentWriter>(new Writer(*this, idx, std::move(file_writer)));
+}
+
+                        /* ======= class NodeManager::Writer ======= */
+
+bool NodeManager::Writer::write(const char* data, size_t length) {
+    return file_writer_->write(data, length);
+}
+
+bool NodeManager::Writer::commit(unsigned long long& id) {
+    if (!owner_.node_exist(idx_)) {
+        owner_.logger_.log("Node " + std::to_string(idx_) + " no longer exists.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+        return false;
+    }
+    unsigned long long fid;
+    if (!file_writer_->commit(fid)) return false;
+
+    std::string name = owner_.get_name(idx_);
+    owner_.delete_node(idx_);
+    id = owner_.get_new_node(name);
+    auto it = owner_.mp.find(id);
+    owner_.file_manager_.decrease_counter(it->second.second.fid);
+    it->second.second.fid = fid;
+    return true;
+}
+
 // Singleton accessor removed - use dependency injection instead
 
 // Test functions removed - use main.cpp for testing with proper DI
@@ -0,0 +1,162 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+#ifndef NTT_ENCRYPTOR_CPP
+#define NTT_ENCRYPTOR_CPP
+
+#include "fvm/ntt_encryptor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace fvm {
+
+static_assert((NttEncryptor::P - 1) % NttEncryptor::M == 0,
+              "The transform length must divide P - 1");
+
+uint32_t NttEncryptor::pow_mod(uint64_t base, uint64_t exp) {
+    uint64_t result = 1;
+    base %= P;
+    while (exp) {
+        if (exp & 1) result = result * base % P;
+        base = base * base % P;
+        exp >>= 1;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+NttEncryptor::Plan::Plan() {
+    int bits = 0;
+    while ((1 << bits) < M) bits++;
+    for (int i = 0; i < M; i++) {
+        rev[i] = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) rev[i] |= 1u << (bits - 1 - b);
+        }
+    }
+
+    for (int h = 1; h < M; h <<= 1) {
+        uint32_t w = pow_mod(G, (P - 1) / (2 * h));
+        uint32_t w_inv = pow_mod(w, P - 2);
+        uint64_t cur = 1, cur_inv = 1;
+        for (int j = 0; j < h; j++) {
+            roots[0][h + j] = static_cast<uint32_t>(cur);
+            roots[1][h + j] = static_cast<uint32_t>(cur_inv);
+            cur = cur * w % P;
+            cur_inv = cur_inv * w_inv % P;
+        }
+    }
+    roots[0][0] = roots[1][0] = 0;  // Unused
+    inv_m = pow_mod(M, P - 2);
+}
+
+const NttEncryptor::Plan& NttEncryptor::plan() {
+    static const Plan instance;
+    return instance;
+}
+
+void NttEncryptor::ntt(uint32_t a[], int type) {
+    const Plan& p = plan();
+    for (int i = 0; i < M; i++) {
+        if (static_cast<uint32_t>(i) < p.rev[i]) std::swap(a[i], a[p.rev[i]]);
+    }
+
+    const uint32_t* table = p.roots[type == 1 ? 0 : 1];
+    for (int h = 1; h < M; h <<= 1) {
+        const uint32_t* w = table + h;
+        for (int i = 0; i < M; i += 2 * h) {
+            for (int j = 0; j < h; j++) {
+                uint32_t u = a[i + j];
+                uint32_t v = static_cast<uint32_t>(static_cast<uint64_t>(a[i + j + h]) * w[j] % P);
+                a[i + j] = u + v >= P ? u + v - P : u + v;
+                a[i + j + h] = u >= v ? u - v : u + P - v;
+            }
+        }
+    }
+
+    if (type == -1) {
+        for (int i = 0; i < M; i++) {
+            a[i] = static_cast<uint32_t>(static_cast<uint64_t>(a[i]) * p.inv_m % P);
+        }
+    }
+}
+
+bool NttEncryptor::encrypt_sequence(const std::vector<int>& sequence, std::vector<std::pair<double, double>>& res) {
+    // The residue of anything larger would decode to another value
+    if (sequence.size() >= P) return false;
+    for (int value : sequence) {
+        if (value < -MAX_VALUE || value > MAX_VALUE) return false;
+    }
+
+    // The length header plus the sequence, padded up to a whole number of blocks
+    const size_t blocks = sequence.size() / M + 1;
+    res.clear();
+    res.resize(blocks * N);
+
+    uint32_t a[M];
+    for (size_t b = 0; b < blocks; b++) {
+        for (int i = 0; i < M; i++) {
+            size_t pos = b * M + i;
+            long long value = 0;
+            if (pos == 0) {
+                value = static_cast<long long>(sequence.size());
+            } else if (pos - 1 < sequence.size()) {
+                value = sequence[pos - 1];
+            }
+            a[i] = static_cast<uint32_t>((value % P + P) % P);
+        }
+        ntt(a, 1);
+        for (int k = 0; k < N; k++) {
+            res[b * N + k] = std::make_pair(static_cast<double>(a[2 * k]),
+                                            static_cast<double>(a[2 * k + 1]));
+        }
+    }
+    return true;
+}
+
+bool NttEncryptor::decrypt_sequence(const std::vector<std::pair<double, double>>& sequence, std::vector<int>& res) {
+    if (sequence.size() % N != 0) return false;
+    res.clear();
+    const size_t blocks = sequence.size() / N;
+
+    uint32_t a[M];
+    long long len = -1;
+    for (size_t b = 0; b < blocks; b++) {
+        for (int k = 0; k < N; k++) {
+            const double values[2] = {sequence[b * N + k].first, sequence[b * N + k].second};
+            for (int h = 0; h < 2; h++) {
+                // Anything but an integer residue means this is not an NTT record
+                if (!(values[h] >= 0 && values[h] < P) || values[h] != std::floor(values[h])) {
+                    res.clear();
+                    return false;
+                }
+                a[2 * k + h] = static_cast<uint32_t>(values[h]);
+            }
+        }
+        ntt(a, -1);
+
+        int first = 0;
+        if (b == 0) {
+            len = a[0];
+            if (static_cast<size_t>(len) > blocks * M - 1) return false;
+            res.reserve(len);
+            first = 1;
+        }
+        for (int i = first; i < M && res.size() < static_cast<size_t>(len); i++) {
+            long long value = a[i] > P / 2 ? static_cast<long long>(a[i]) - P : a[i];
+            res.push_back(static_cast<int>(value));
+        }
+        if (res.size() == static_cast<size_t>(len)) break;
+    }
+    return true;
+}
+
+} // namespace fvm
+
+#endif // NTT_ENCRYPTOR_CPP
@@ -0,0 +1,42 @@
+/**
+   ___ _                 _
+  / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+ / /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\/\ |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/    \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+#ifndef PRECISION_CPP
+#define PRECISION_CPP
+
+#include "fvm/precision.h"
+#include "fvm/record_format.h"
+#include <cmath>
+#include <limits>
+
+namespace fvm {
+
+bool fits_float32(const std::pair<double, double>* block, int block_size, unsigned format) {
+    const unsigned codec = record_codec(format);
+    if (codec != CODEC_FFT && codec != CODEC_FFT_REAL && codec != CODEC_NTT) return false;
+
+    const double max_float = std::numeric_limits<float>::max();
+    double error = 0;
+    for (int i = 0; i < block_size; i++) {
+        const double values[2] = {block[i].first, block[i].second};
+        for (double v : values) {
+            if (!(std::fabs(v) <= max_float)) return false;
+            error += std::fabs(static_cast<double>(static_cast<float>(v)) - v);
+        }
+    }
+
+    if (codec == CODEC_NTT) return error == 0;
+    const double weight = (codec == CODEC_FFT_REAL ? 2.0 : 1.0) / block_size;
+    return error * weight < FLOAT32_ERROR_BOUND;
+}
+
+} // namespace fvm
+
+#endif // PRECISION_CPP
@@ -4,6 +4,7 @@
 #include "fvm/interfaces/ISaver.h"
 #include "fvm/interfaces/ILogger.h"
 #include "fvm/repositories/ICommandRepository.h"
+#include "fvm/record_view.h"
 
 namespace fvm {
 namespace repositories {
@@ -26,21 +27,21 @@ public:
     }
 
     bool load(std::map<unsigned long long, unsigned long long>& data) override {
-        interfaces::vvs vvs_data;
-        if (!saver_.load("CommandInterpreter::map_relation", vvs_data)) return false;
+        RecordView view;
+        if (!saver_.load("CommandInterpreter::map_relation", view)) return false;
 
         data.clear();
-        for (auto& it : vvs_data) {
+        for (size_t i = 0; i < view.size(); i++) {
+            RecordView::Row it = view[i];
             if (it.size() != 2) {
                 logger_.warning("CommandRepository: corrupted data", __LINE__);
                 return false;
             }
-            if (!saver_.is_all_digits(it[0]) || !saver_.is_all_digits(it[1])) {
+            unsigned long long key, value;
+            if (!parse_ull(it[0], key) || !parse_ull(it[1], value)) {
                 logger_.warning("CommandRepository: invalid format", __LINE__);
                 return false;
             }
-            unsigned long long key = saver_.str_to_ull(it[0]);
-            unsigned long long value = saver_.str_to_ull(it[1]);
             data[key] = value;
         }
         return true;
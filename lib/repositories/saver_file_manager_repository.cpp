@@ -3,8 +3,8 @@
 
 #include "fvm/interfaces/ISaver.h"
 #include "fvm/interfaces/ILogger.h"
+#include "fvm/record_view.h"
 #include "fvm/repositories/IFileManagerRepository.h"
-#include "../file_manager.cpp"  // For fileNode struct
 
 namespace fvm {
 namespace repositories {
@@ -14,37 +14,190 @@ private:
     interfaces::ISaver& saver_;
     interfaces::ILogger& logger_;
 
-public:
-    SaverFileManagerRepository(interfaces::ISaver& saver, interfaces::ILogger& logger)
-        : saver_(saver), logger_(logger) {}
+    static std::string file_key(unsigned long long fid) {
+        return "FileManager::chunk_list::" + std::to_string(fid);
+    }
 
-    bool save(const std::map<unsigned long long, fileNode>& data) override {
-        vvs vvs_data;
-        for (const auto& it : data) {
-            vvs_data.push_back({std::to_string(it.first), it.second.content, std::to_string(it.second.cnt)});
-        }
-        return saver_.save("FileManager::map_relation", vvs_data);
+    static std::string chunk_key(unsigned long long cid) {
+        return "FileManager::chunk::" + std::to_string(cid);
+    }
+
+    // Whole contents, as files were stored before they were chunked
+    static std::string content_key(unsigned long long fid) {
+        return "FileManager::file::" + std::to_string(fid);
     }
 
-    bool load(std::map<unsigned long long, fileNode>& data) override {
-        vvs vvs_data;
+    /**
+     * @brief
+     * Stores written before files had their own keys kept everything in one record.
+     * It is split into per-file records once, then dropped; those are chunked when read.
+     */
+    bool migrate_legacy(std::map<unsigned long long, unsigned long long>& counters) {
+        interfaces::vvs vvs_data;
         if (!saver_.load("FileManager::map_relation", vvs_data)) return false;
 
-        data.clear();
+        counters.clear();
         for (auto& it : vvs_data) {
             if (it.size() != 3) {
                 logger_.warning("FileManagerRepository: corrupted data", __LINE__);
                 return false;
             }
-            if (!saver_.is_all_digits(it[0])) {
+            if (!saver_.is_all_digits(it[0]) || !saver_.is_all_digits(it[2])) {
                 logger_.warning("FileManagerRepository: invalid key format", __LINE__);
                 return false;
             }
             unsigned long long key = saver_.str_to_ull(it[0]);
-            unsigned long long cnt = saver_.str_to_ull(it[2]);
-            data[key] = fileNode(it[1]);
-            data[key].cnt = cnt;
+            interfaces::vvs content = {{it[1]}};
+            if (!saver_.save(content_key(key), content)) return false;
+            counters[key] = saver_.str_to_ull(it[2]);
+        }
+        if (!save_index(counters)) return false;
+        saver_.remove("FileManager::map_relation");
+        return true;
+    }
+
+public:
+    SaverFileManagerRepository(interfaces::ISaver& saver, interfaces::ILogger& logger)
+        : saver_(saver), logger_(logger) {}
+
+    bool load_index(std::map<unsigned long long, unsigned long long>& counters) override {
+        RecordView view;
+        if (!saver_.load("FileManager::index", view)) return migrate_legacy(counters);
+
+        counters.clear();
+        for (size_t i = 0; i < view.size(); i++) {
+            RecordView::Row it = view[i];
+            unsigned long long key, cnt;
+            if (it.size() != 2 || !parse_ull(it[0], key) || !parse_ull(it[1], cnt)) {
+                logger_.warning("FileManagerRepository: corrupted index", __LINE__);
+                return false;
+            }
+            counters[key] = cnt;
+        }
+        return true;
+    }
+
+    bool save_index(const std::map<unsigned long long, unsigned long long>& counters) override {
+        interfaces::vvs vvs_data;
+        vvs_data.reserve(counters.size());
+        for (const auto& it : counters) {
+            vvs_data.push_back({std::to_string(it.first), std::to_string(it.second)});
+        }
+        return saver_.save("FileManager::index", vvs_data);
+    }
+
+    bool load_file(unsigned long long fid, FileRecord& file) override {
+        RecordView view;
+        if (!saver_.load(file_key(fid), view)) return false;
+
+        // A row of chunk ids, then for a delta a row with its base and depth
+        file = FileRecord();
+        if (view.size() == 0) return true;
+        if (view.size() > 2) {
+            logger_.warning("FileManagerRepository: corrupted chunk list", __LINE__);
+            return false;
+        }
+        RecordView::Row row = view[0];
+        file.chunks.resize(row.size());
+        for (size_t i = 0; i < row.size(); i++) {
+            if (!parse_ull(row[i], file.chunks[i])) {
+                logger_.warning("FileManagerRepository: corrupted chunk list", __LINE__);
+                return false;
+            }
+        }
+        if (view.size() == 2) {
+            RecordView::Row delta = view[1];
+            unsigned long long depth;
+            if (delta.size() != 2 || !parse_ull(delta[0], file.base) || !parse_ull(delta[1], depth)) {
+                logger_.warning("FileManagerRepository: corrupted chunk list", __LINE__);
+                return false;
+            }
+            file.delta = true;
+            file.depth = static_cast<unsigned>(depth);
+        }
+        return true;
+    }
+
+    bool save_file(unsigned long long fid, const FileRecord& file) override {
+        // An empty full revision has no rows at all
+        interfaces::vvs vvs_data;
+        if (!file.chunks.empty() || file.delta) {
+            vvs_data.emplace_back();
+            vvs_data[0].reserve(file.chunks.size());
+            for (unsigned long long cid : file.chunks) vvs_data[0].push_back(std::to_string(cid));
+        }
+        if (file.delta) {
+            vvs_data.push_back({std::to_string(file.base), std::to_string(file.depth)});
+        }
+        return saver_.save(file_key(fid), vvs_data);
+    }
+
+    bool remove_file(unsigned long long fid) override {
+        return saver_.remove(file_key(fid));
+    }
+
+    bool load_chunk_index(std::map<unsigned long long, ChunkInfo>& chunks) override {
+        chunks.clear();
+        RecordView view;
+        // Stores written before files were chunked have no chunks yet
+        if (!saver_.load("FileManager::chunk_index", view)) return true;
+
+        // Rows are {cid, refs, size}; older ones have no size
+        for (size_t i = 0; i < view.size(); i++) {
+            RecordView::Row it = view[i];
+            unsigned long long key;
+            ChunkInfo info;
+            if (it.size() < 2 || it.size() > 3 || !parse_ull(it[0], key) || !parse_ull(it[1], info.refs) ||
+                (it.size() == 3 && !parse_ull(it[2], info.size))) {
+                logger_.warning("FileManagerRepository: corrupted chunk index", __LINE__);
+                return false;
+            }
+            chunks[key] = info;
+        }
+        return true;
+    }
+
+    bool save_chunk_index(const std::map<unsigned long long, ChunkInfo>& chunks) override {
+        interfaces::vvs vvs_data;
+        vvs_data.reserve(chunks.size());
+        for (const auto& it : chunks) {
+            std::vector<std::string> row = {std::to_string(it.first), std::to_string(it.second.refs)};
+            if (it.second.size != ChunkInfo::UNKNOWN_SIZE) row.push_back(std::to_string(it.second.size));
+            vvs_data.push_back(std::move(row));
+        }
+        return saver_.save("FileManager::chunk_index", vvs_data);
+    }
+
+    bool load_chunk(unsigned long long cid, std::string& data) override {
+        return load_single(chunk_key(cid), data);
+    }
+
+    bool save_chunk(unsigned long long cid, const std::string& data) override {
+        interfaces::vvs vvs_data = {{data}};
+        return saver_.save(chunk_key(cid), vvs_data);
+    }
+
+    bool remove_chunk(unsigned long long cid) override {
+        return saver_.remove(chunk_key(cid));
+    }
+
+    bool load_content(unsigned long long fid, std::string& content) override {
+        return load_single(content_key(fid), content);
+    }
+
+    bool remove_content(unsigned long long fid) override {
+        return saver_.remove(content_key(fid));
+    }
+
+private:
+    bool load_single(const std::string& name, std::string& data) {
+        interfaces::vvs vvs_data;
+        if (!saver_.load(name, vvs_data)) return false;
+        if (vvs_data.size() != 1 || vvs_data[0].size() != 1) {
+            logger_.warning("FileManagerRepository: corrupted file content", __LINE__);
+            return false;
         }
+        data = std::move(vvs_data[0][0]);
         return true;
     }
 };
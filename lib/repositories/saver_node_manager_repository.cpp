@@ -4,6 +4,7 @@
 #include "fvm/interfaces/ISaver.h"
 #include "fvm/interfaces/ILogger.h"
 #include "fvm/interfaces/IFileManager.h"
+#include "fvm/record_view.h"
 #include "fvm/repositories/INodeManagerRepository.h"
 #include "../node_manager.cpp"  // For Node struct
 
@@ -36,33 +37,26 @@ public:
     }
 
     bool load(std::map<unsigned long long, std::pair<unsigned long long, Node>>& data) override {
-        vvs vvs_data;
-        if (!saver_.load("NodeManager::map_relation", vvs_data)) return false;
+        // Cells are views into one buffer, so only the Node's own strings are allocated
+        RecordView view;
+        if (!saver_.load("NodeManager::map_relation", view)) return false;
 
         data.clear();
-        for (auto& it : vvs_data) {
+        for (size_t i = 0; i < view.size(); i++) {
+            RecordView::Row it = view[i];
             if (it.size() != 6) {
                 logger_.warning("NodeManagerRepository: corrupted data", __LINE__);
                 return false;
             }
-            bool flag = true;
-            if (!saver_.is_all_digits(it[0]) || !saver_.is_all_digits(it[1]) || !saver_.is_all_digits(it[5])) {
-                flag = false;
-            }
-            if (!flag) {
+            unsigned long long key, cnt, fid;
+            if (!parse_ull(it[0], key) || !parse_ull(it[1], cnt) || !parse_ull(it[5], fid)) {
                 logger_.warning("NodeManagerRepository: invalid format", __LINE__);
                 return false;
             }
-            unsigned long long key = saver_.str_to_ull(it[0]);
-            unsigned long long cnt = saver_.str_to_ull(it[1]);
-            unsigned long long fid = saver_.str_to_ull(it[5]);
-            std::string& name = it[2];
-            std::string& create_time = it[3];
-            std::string& update_time = it[4];
             Node t_node = Node(&file_manager_);
-            t_node.name = name;
-            t_node.create_time = create_time;
-            t_node.update_time = update_time;
+            t_node.name.assign(it[2]);
+            t_node.create_time.assign(it[3]);
+            t_node.update_time.assign(it[4]);
             t_node.fid = fid;
             data.insert(std::pair<unsigned long long, std::pair<unsigned long long, Node>>(
                 key, std::pair<unsigned long long, Node>(cnt, std::move(t_node))));
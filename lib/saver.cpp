@@ -13,15 +13,22 @@
 
 #include "logger.cpp"
 #include "fvm/encryptor.h"
+#include "fvm/ntt_encryptor.h"
+#include "fvm/record_format.h"
+#include "fvm/record_view.h"
 #include "fvm/interfaces/IEncryptor.h"
 #include "fvm/interfaces/ISaver.h"
 #include "fvm/interfaces/ILogger.h"
 #include "fvm/interfaces/IFileOperations.h"
 #include "fvm/saver_constants.h"
 #include "fvm/data_serializer.h"
+#include "fvm/hasher.h"
 #include "fvm/wal_manager.h"
 #include "fvm/storage_manager.h"
+#include "fvm/load_cache.h"
+#include "fvm/lz_codec.h"
 #include <cctype>
+#include <climits>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -111,6 +118,21 @@ private:
     fvm::interfaces::IEncryptor* encryptor_;
     bool owns_encryptor_;  // True if we created the default implementation
 
+    /**
+     * @brief
+     * Decoders for records written with a codec other than the current encryptor's,
+     * keyed by codec id and created on first use.
+     */
+    std::map<unsigned, std::unique_ptr<fvm::interfaces::IEncryptor>> decoders_;
+
+    /**
+     * @brief
+     * Pick the codec able to decode a record of the given format.
+     *
+     * @return nullptr if the codec is unknown
+     */
+    fvm::interfaces::IEncryptor* get_decoder(unsigned format);
+
     /**
      * @brief
      * File operations abstraction (for testability).
@@ -139,19 +161,6 @@ private:
     std::unique_ptr<fvm::WalManager> wal_manager_;
     std::unique_ptr<fvm::StorageManager> storage_manager_;
 
-    /**
-     * @brief Get the hash object
-     * This is a generic function, it is a generalized hash function.
-     * 
-     * @param s 
-     * You want to take the data array of the hash value.
-     * 
-     * @return unsigned long long 
-     * The calculated hash value.
-     */
-    template <class T>
-    unsigned long long get_hash(T &s);
-
     /**
      * @brief 
      * Read the previously stored data from the file.
@@ -218,10 +227,54 @@ private:
      */
     bool atomic_write(const std::string& filename, const std::string& content);
 
+    /**
+     * @brief
+     * Recently loaded records, deserialized. Off until given a capacity.
+     */
+    fvm::LoadCache load_cache_;
+
+    bool compression_enabled_ = true;
+
+    /**
+     * @brief
+     * Compress a serialized sequence into packed if that makes it smaller.
+     *
+     * @return The compression applied, fvm::COMPRESSION_NONE if packed was left empty
+     */
+    unsigned compress_sequence(const std::vector<int>& sequence, std::string& packed) const;
+
+    /**
+     * @brief
+     * Find the record stored under a name, falling back to the name hash used
+     * before hashes were versioned.
+     *
+     * @return nullptr if there is none
+     */
+    fvm::interfaces::DataHandle find_record(const std::string& name);
+
+    /**
+     * @brief
+     * Decrypt and verify the serialized sequence of a record.
+     * Shared by both load overloads, which differ only in how they deserialize.
+     *
+     * @param mandatory_access Return the sequence even if it fails the integrity check
+     * @param verified Set to whether the sequence passed the integrity check
+     * @return true if a sequence was produced
+     */
+    bool load_sequence(const fvm::interfaces::DataNode& node, std::vector<int>& sequence,
+                       bool mandatory_access, bool& verified);
+
 public:
+    /**
+     * @param codec
+     * Codec of the default encryptor (fvm::CODEC_FFT_REAL, fvm::CODEC_FFT or
+     * fvm::CODEC_NTT), only used when no encryptor is injected. Records are tagged with their codec, so stores written
+     * with either codec stay readable whichever one is selected.
+     */
     Saver(fvm::interfaces::ILogger& logger,
           fvm::interfaces::IEncryptor* encryptor = nullptr,
-          fvm::interfaces::IFileOperations* file_ops = nullptr);
+          fvm::interfaces::IFileOperations* file_ops = nullptr,
+          unsigned codec = fvm::CODEC_FFT_REAL);
 
     /**
      * Storage format:
@@ -232,6 +285,21 @@ public:
     // Encryptor injection (for testability)
     void set_encryptor(fvm::interfaces::IEncryptor* encryptor);
 
+    /**
+     * @brief
+     * Opt in to holding and logging encrypted blocks as float32 where that provably
+     * decodes to the same data (see StorageManager::set_float32_storage). Records
+     * written this way stay readable with the mode off.
+     */
+    void set_float32_storage(bool enabled);
+
+    /**
+     * @brief
+     * Compress records before they are encrypted, so they take fewer blocks on disk
+     * and in the WAL. On by default; records keep reading back either way.
+     */
+    void set_compression(bool enabled) { compression_enabled_ = enabled; }
+
     // File operations injection (for testability)
     void set_file_operations(fvm::interfaces::IFileOperations* file_ops) override;
 
@@ -249,6 +317,8 @@ public:
     */
     bool save(const std::string& name, std::vector<std::vector<std::string>>& content) override;
     bool load(const std::string& name, std::vector<std::vector<std::string>>& content, bool mandatory_access = false) override;
+    bool load(const std::string& name, fvm::RecordView& view, bool mandatory_access = false) override;
+    bool remove(const std::string& name) override;
     bool is_all_digits(std::string& s) override;
     unsigned long long str_to_ull(std::string& s) override;
 
@@ -256,10 +326,14 @@ public:
 
     // New WAL-related public methods
     bool flush() override;                        // Immediately flush WAL to disk
+    bool set_wal_sync_policy(fvm::interfaces::WalSyncPolicy policy, unsigned interval_ms = 0) override;
+    bool checkpoint() override;                   // Incremental checkpoint of changed records
     bool compact() override;                      // Manually trigger WAL compaction
     size_t get_wal_size() const override;         // Get current WAL entry count
     bool set_auto_compact(size_t threshold) override;  // Set auto-compact threshold
     bool set_wal_enabled(bool enabled) override;  // Enable/disable WAL
+    void set_load_cache_capacity(size_t bytes) override { load_cache_.set_capacity(bytes); }
+    fvm::interfaces::LoadCacheStats get_load_cache_stats() const override { return load_cache_.get_stats(); }
 
     // Configuration persistence support (for Config class)
     std::string get_data_file() const override { return data_file; }
@@ -290,15 +364,6 @@ dataNode::dataNode(unsigned long long name_hash,
 
 
                         /* ======= class Saver ======= */
-template <class T>
-unsigned long long Saver::get_hash(T &s) {
-    unsigned long long seed = fvm::DEFAULT_HASH_SEED, hash = 0;
-    for (auto &ch : s) {
-        hash = hash * seed + ch;
-    }
-    return hash;
-}
-
 bool Saver::load_file() {
     std::ifstream* in_ptr = nullptr;
     bool using_file_ops = false;
@@ -429,12 +494,22 @@ int Saver::read(std::string &s) {
 
 Saver::Saver(fvm::interfaces::ILogger& logger,
              fvm::interfaces::IEncryptor* encryptor,
-             fvm::interfaces::IFileOperations* file_ops)
+             fvm::interfaces::IFileOperations* file_ops,
+             unsigned codec)
     : logger_(logger), encryptor_(encryptor), owns_encryptor_(false),
       file_ops_(file_ops), owns_file_ops_(false) {
     // Create default encryptor if not provided
     if (!encryptor_) {
-        encryptor_ = new Encryptor();
+        if (codec == fvm::CODEC_NTT) {
+            encryptor_ = new fvm::NttEncryptor();
+        } else {
+            Encryptor* default_encryptor = new Encryptor(codec == fvm::CODEC_FFT
+                                                         ? Encryptor::Transform::COMPLEX
+                                                         : Encryptor::Transform::REAL);
+            // Large records span hundreds of independent blocks; spread them over the cores
+            default_encryptor->set_thread_count(fvm::ThreadPool::default_thread_count());
+            encryptor_ = default_encryptor;
+        }
         owns_encryptor_ = true;
     }
 
@@ -452,6 +527,8 @@ Saver::Saver(fvm::interfaces::ILogger& logger,
 */
 Saver::~Saver() {
     // Destructor no longer saves data - use shutdown() instead
+    // Queued WAL records still need the file operations deleted below
+    wal_manager_->stop_writer();
     if (owns_encryptor_ && encryptor_) {
         delete encryptor_;
     }
@@ -468,6 +545,49 @@ void Saver::set_encryptor(fvm::interfaces::IEncryptor* encryptor) {
     owns_encryptor_ = false;
 }
 
+fvm::interfaces::IEncryptor* Saver::get_decoder(unsigned format) {
+    unsigned codec = fvm::record_codec(format);
+    if (codec == encryptor_->get_format_tag()) {
+        return encryptor_;
+    }
+
+    auto it = decoders_.find(codec);
+    if (it != decoders_.end()) {
+        return it->second.get();
+    }
+
+    std::unique_ptr<fvm::interfaces::IEncryptor> decoder;
+    switch (codec) {
+        case fvm::CODEC_FFT:
+            decoder = std::make_unique<Encryptor>(Encryptor::Transform::COMPLEX);
+            break;
+        case fvm::CODEC_FFT_REAL:
+            decoder = std::make_unique<Encryptor>(Encryptor::Transform::REAL);
+            break;
+        case fvm::CODEC_NTT:
+            decoder = std::make_unique<fvm::NttEncryptor>();
+            break;
+        default:
+            return nullptr;
+    }
+    return (decoders_[codec] = std::move(decoder)).get();
+}
+
+void Saver::set_float32_storage(bool enabled) {
+    storage_manager_->set_float32_storage(enabled, encryptor_->get_block_size());
+    wal_manager_->set_float32_storage(enabled, encryptor_->get_block_size());
+}
+
+unsigned Saver::compress_sequence(const std::vector<int>& sequence, std::string& packed) const {
+    if (!compression_enabled_) return fvm::COMPRESSION_NONE;
+    std::vector<uint8_t> bytes(sequence.begin(), sequence.end());
+    if (!fvm::lz::compress(bytes.data(), bytes.size(), packed)) {
+        packed.clear();
+        return fvm::COMPRESSION_NONE;
+    }
+    return fvm::COMPRESSION_LZ;
+}
+
 void Saver::set_file_operations(fvm::interfaces::IFileOperations* file_ops) {
     if (owns_file_ops_ && file_ops_) {
         delete file_ops_;
@@ -482,13 +602,18 @@ bool Saver::initialize() {
         logger_.log("initialize: No data file found (this is ok for first run)", fvm::interfaces::LogLevel::INFO, __LINE__);
     }
 
+    // Segments the last checkpoint covers may be left over from a crash before they were retired
+    if (storage_manager_->get_checkpoint_position() > 0) {
+        wal_manager_->retire_segments(storage_manager_->get_checkpoint_position());
+    }
+
     // Load and replay WAL entries
     if (!wal_manager_->load_and_replay([this](const fvm::interfaces::WalEntry& entry) {
         // Replay callback: apply WAL entry to storage
         switch (entry.op) {
             case fvm::interfaces::WalOperation::INSERT:
             case fvm::interfaces::WalOperation::UPDATE:
-                storage_manager_->store(entry.name_hash, entry.data_hash, entry.data, entry.len);
+                storage_manager_->store(entry.name_hash, entry.data_hash, entry.data, entry.len, entry.format);
                 break;
             case fvm::interfaces::WalOperation::DELETE:
                 storage_manager_->remove(entry.name_hash);
@@ -498,12 +623,20 @@ bool Saver::initialize() {
         logger_.log("initialize: No WAL file found (this is ok for first run)", fvm::interfaces::LogLevel::INFO, __LINE__);
     }
 
+    // Replayed changes only live in the WAL until a checkpoint takes them over
+    if (wal_manager_->get_entry_count() > 0 && !checkpoint()) {
+        logger_.log("initialize: Failed to checkpoint replayed WAL entries", fvm::interfaces::LogLevel::WARNING, __LINE__);
+    }
+
+    // From here on saves hand their WAL records to a writer thread instead of waiting for the disk
+    wal_manager_->start_writer();
+
     return true;
 }
 
 bool Saver::shutdown() {
-    // Save data to files via WAL compaction
-    return compact();
+    // Persist what changed since the last checkpoint
+    return checkpoint();
 }
 
 /**
@@ -522,21 +655,42 @@ bool Saver::save(const std::string& name, std::vector<std::vector<std::string>>&
         return false;
     }
 
-    // Encrypt the serialized data
-    std::vector<std::pair<double, double>> res;
-    encryptor_->encrypt_sequence(sequence, res);
-
-    // Calculate hashes
-    std::string data_str;
-    data_str.reserve(sequence.size());
-    for (int ch : sequence) {
-        data_str.push_back(static_cast<char>(ch));
-    }
+    // Calculate hashes; the data hash is of the serialized record, however it is stored
     unsigned long long name_hash = serializer_->calculate_hash(name);
     unsigned long long data_hash = serializer_->calculate_hash(sequence);
 
-    // Store using StorageManager
-    storage_manager_->store(name_hash, data_hash, res, res.size() / encryptor_->get_block_size());
+    // Compress and encrypt the serialized data
+    std::string packed;
+    unsigned compression = compress_sequence(sequence, packed);
+    std::vector<std::pair<double, double>> res;
+    bool encrypted;
+    if (compression == fvm::COMPRESSION_LZ) {
+        // Encrypted from the compressed bytes as they are; the serialized sequence is not needed any more
+        std::vector<int>().swap(sequence);
+        encrypted = encryptor_->encrypt_bytes(packed, res);
+    } else {
+        encrypted = encryptor_->encrypt_sequence(sequence, res);
+    }
+    if (!encrypted) {
+        logger_.log("save: Failed to encrypt content", fvm::interfaces::LogLevel::WARNING, __LINE__);
+        return false;
+    }
+    unsigned format = encryptor_->get_format_tag() |
+                      (serializer_->get_hash_version() << fvm::RECORD_HASH_SHIFT) |
+                      (compression << fvm::RECORD_COMPRESSION_SHIFT);
+
+    // Whatever was loaded under this name before is stale now
+    load_cache_.invalidate(name_hash);
+
+    // A record written before the current name hash is superseded by this one
+    unsigned long long legacy_hash = fvm::get_hasher(fvm::HASH_POLYNOMIAL)->hash(name);
+    load_cache_.invalidate(legacy_hash);
+    if (legacy_hash != name_hash && storage_manager_->remove(legacy_hash)) {
+        fvm::interfaces::WalEntry removal;
+        removal.op = fvm::interfaces::WalOperation::DELETE;
+        removal.name_hash = legacy_hash;
+        wal_manager_->submit(removal);
+    }
 
     // Write to WAL for incremental persistence
     fvm::interfaces::WalEntry entry;
@@ -544,39 +698,161 @@ bool Saver::save(const std::string& name, std::vector<std::vector<std::string>>&
     entry.name_hash = name_hash;
     entry.data_hash = data_hash;
     entry.len = res.size() / encryptor_->get_block_size();
-    entry.data = res;
+    entry.format = format;
+    entry.data = std::move(res);
 
-    wal_manager_->append_entry(entry);
+    // Queued for the WAL writer thread; flush() waits until it is durable.
+    // submit() encodes the entry right away, so its data can then be handed on
+    wal_manager_->submit(entry);
+
+    // Store using StorageManager, handing over the encrypted data
+    storage_manager_->store(fvm::interfaces::DataNode(name_hash, data_hash, std::move(entry.data), entry.len, format));
+
+    // Keep the live WAL short; a checkpoint only writes the records changed since the last one
+    if (wal_manager_->get_entry_count() >= wal_manager_->get_auto_compact_threshold()) {
+        checkpoint();
+    }
 
     return true;
 }
 
-bool Saver::load(const std::string& name, std::vector<std::vector<std::string>>& content, bool mandatory_access) {
+fvm::interfaces::DataHandle Saver::find_record(const std::string& name) {
     unsigned long long name_hash = serializer_->calculate_hash(name);
 
-    // Use StorageManager to retrieve data
-    fvm::interfaces::DataNode node;
-    if (!storage_manager_->retrieve(name_hash, node)) {
+    // Use StorageManager to retrieve data, falling back to the name hash used
+    // before hashes were versioned. The handle shares the stored record rather than copying it
+    fvm::interfaces::DataHandle handle = storage_manager_->retrieve(name_hash);
+    if (!handle) {
+        handle = storage_manager_->retrieve(fvm::get_hasher(fvm::HASH_POLYNOMIAL)->hash(name));
+    }
+    if (!handle) {
         logger_.log("Failed to load data. No data named A exists. ", fvm::interfaces::LogLevel::WARNING, __LINE__);
+    }
+    return handle;
+}
+
+bool Saver::load_sequence(const fvm::interfaces::DataNode& node, std::vector<int>& sequence,
+                          bool mandatory_access, bool& verified) {
+    verified = false;
+
+    // Decrypt the data with the codec it was written with
+    fvm::interfaces::IEncryptor* decoder = get_decoder(node.format);
+    if (!decoder) {
+        logger_.log("Failed to load data. Unknown record codec.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+        return false;
+    }
+    // Compressed bytes are decrypted as they are, rather than into a sequence first
+    unsigned compression = fvm::record_compression(node.format);
+    std::vector<uint8_t> packed;
+    bool decrypted = compression == fvm::COMPRESSION_LZ
+                     ? decoder->decrypt_bytes(node.data, packed)
+                     : decoder->decrypt_sequence(node.data, sequence);
+    if (!decrypted) {
+        logger_.log("Failed to decrypt data.", fvm::interfaces::LogLevel::WARNING, __LINE__);
         return false;
     }
 
-    // Decrypt the data
-    std::vector<int> sequence;
-    encryptor_->decrypt_sequence(node.data, sequence);
+    // Undo the compression applied before encrypting
+    switch (compression) {
+        case fvm::COMPRESSION_NONE:
+            break;
+        case fvm::COMPRESSION_LZ: {
+            std::string bytes;
+            if (!fvm::lz::decompress(packed.data(), packed.size(), bytes)) {
+                logger_.log("Failed to decompress data.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+                return false;
+            }
+            sequence.assign(reinterpret_cast<const uint8_t*>(bytes.data()),
+                            reinterpret_cast<const uint8_t*>(bytes.data()) + bytes.size());
+            break;
+        }
+        default:
+            logger_.log("Failed to load data. Unknown record compression.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+            return false;
+    }
 
-    // Verify data integrity
-    if (serializer_->calculate_hash(sequence) != node.data_hash) {
+    // Verify data integrity with the hash the record was written with
+    const fvm::interfaces::IHasher* hasher = fvm::get_hasher(fvm::record_hash_version(node.format));
+    if (!hasher) {
+        logger_.log("Failed to load data. Unknown record hash version.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+        return false;
+    }
+    if (hasher->hash(sequence) != node.data_hash) {
         logger_.log("Data failed to pass integrity verification.", fvm::interfaces::LogLevel::WARNING, __LINE__);
         if (!mandatory_access) return false;
+        return true;
     }
 
+    verified = true;
+    return true;
+}
+
+bool Saver::load(const std::string& name, std::vector<std::vector<std::string>>& content, bool mandatory_access) {
+    fvm::interfaces::DataHandle node = find_record(name);
+    if (!node) return false;
+
+    // A record loaded before and not saved since needs no decrypting or deserializing
+    if (fvm::LoadCache::Value cached = load_cache_.get(node->name_hash, node->data_hash)) {
+        content = *cached;
+        return true;
+    }
+
+    std::vector<int> sequence;
+    bool verified;
+    if (!load_sequence(*node, sequence, mandatory_access, verified)) return false;
+
     // Deserialize the data
     if (!serializer_->deserialize(sequence, content)) {
         logger_.log("Failed to deserialize data.", fvm::interfaces::LogLevel::WARNING, __LINE__);
         return false;
     }
 
+    // Only records that passed the integrity check are cached
+    if (verified && load_cache_.get_capacity() > 0) {
+        load_cache_.put(node->name_hash, node->data_hash, std::make_shared<const vvs>(content));
+    }
+    return true;
+}
+
+bool Saver::load(const std::string& name, fvm::RecordView& view, bool mandatory_access) {
+    fvm::interfaces::DataHandle node = find_record(name);
+    if (!node) return false;
+
+    std::vector<int> sequence;
+    bool verified;
+    if (!load_sequence(*node, sequence, mandatory_access, verified)) return false;
+
+    if (!serializer_->deserialize(sequence, view)) {
+        logger_.log("Failed to deserialize data.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+        return false;
+    }
+
+    return true;
+}
+
+bool Saver::remove(const std::string& name) {
+    // Under the current name hash and the one used before hashes were versioned
+    const unsigned long long hashes[] = {serializer_->calculate_hash(name),
+                                         fvm::get_hasher(fvm::HASH_POLYNOMIAL)->hash(name)};
+    bool removed = false;
+    for (unsigned long long name_hash : hashes) {
+        load_cache_.invalidate(name_hash);
+        if (!storage_manager_->remove(name_hash)) continue;
+
+        fvm::interfaces::WalEntry removal;
+        removal.op = fvm::interfaces::WalOperation::DELETE;
+        removal.name_hash = name_hash;
+        wal_manager_->submit(removal);
+        removed = true;
+    }
+    if (!removed) {
+        logger_.log("remove: No data named " + name + " exists.", fvm::interfaces::LogLevel::WARNING, __LINE__);
+        return false;
+    }
+
+    if (wal_manager_->get_entry_count() >= wal_manager_->get_auto_compact_threshold()) {
+        checkpoint();
+    }
     return true;
 }
 
@@ -590,7 +866,7 @@ bool Saver::is_all_digits(std::string &s) {
 unsigned long long Saver::str_to_ull(std::string &s) {
     unsigned long long res = 0;
     for (auto &ch : s) {
-        if (res > ULLONG_MAX / 10) return 0;
+        if (!isdigit(ch) || res > ULLONG_MAX / 10) return 0;
         res = res * 10 + ch - '0';
     }
     return res;
@@ -781,35 +1057,47 @@ bool Saver::load_from_wal() {
     return true;
 }
 
-bool Saver::compact() {
-    // Build the complete data file content using StorageManager
-    std::ostringstream oss;
-    auto all_data = storage_manager_->get_all_data();
-    for (const auto& data : all_data) {
-        const auto& dn = data.second;
-        oss << data.first << ' ' << dn.data_hash << ' ' << dn.len;
-        for (const auto& pr : dn.data) {
-            oss << ' ' << pr.first << ' ' << pr.second;
-        }
-        oss << '\n';
+bool Saver::checkpoint() {
+    // Entries saved from here on go to a new segment, so the older ones are all in storage
+    uint64_t segment = wal_manager_->roll_segment();
+    if (!storage_manager_->checkpoint(data_file, segment)) {
+        logger_.log("checkpoint: Failed to write checkpoint to data file", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return false;
     }
 
-    // Write to data file atomically
-    if (!atomic_write(data_file, oss.str())) {
+    // The checkpoint is durable, so the segments it covers can go
+    if (!wal_manager_->retire_segments(segment)) {
+        logger_.log("checkpoint: Failed to retire WAL segments", fvm::interfaces::LogLevel::WARNING, __LINE__);
+    }
+    return true;
+}
+
+bool Saver::compact() {
+    // Write the complete data file atomically using StorageManager
+    uint64_t segment = wal_manager_->roll_segment();
+    if (!storage_manager_->checkpoint(data_file, segment, true)) {
         logger_.log("compact: Failed to write compacted data file", fvm::interfaces::LogLevel::FATAL, __LINE__);
         return false;
     }
 
-    // Clear WAL after successful compaction
-    wal_manager_->clear();
+    // Retire the WAL segments after successful compaction
+    wal_manager_->retire_segments(segment);
 
     logger_.log("compact: Successfully compacted WAL to main file", fvm::interfaces::LogLevel::INFO, __LINE__);
     return true;
 }
 
 bool Saver::flush() {
-    // Force immediate WAL sync (already done on each write)
-    // This is mainly for explicit user control
+    // Entries are queued on save; this waits until they are on stable storage
+    if (!wal_manager_->sync()) {
+        logger_.log("flush: Failed to sync WAL file", fvm::interfaces::LogLevel::FATAL, __LINE__);
+        return false;
+    }
+    return true;
+}
+
+bool Saver::set_wal_sync_policy(fvm::interfaces::WalSyncPolicy policy, unsigned interval_ms) {
+    wal_manager_->set_sync_policy(policy, interval_ms);
     return true;
 }
 
@@ -24,6 +24,7 @@
 #include <vector>
 #include <algorithm>
 #include <fstream>
+#include <memory>
 
 class Terminal : private CommandInterpreter, public fvm::interfaces::ITerminal {
 private:
@@ -100,13 +101,17 @@ bool Terminal::execute(unsigned long long pid, std::vector<std::string> paramete
    }
 
 
-   std::string get_content_content;       // case 10
+   const size_t BLOCK_SIZE = 1 << 16;     // case 10, 19: contents are streamed in blocks
+   std::vector<char> block(BLOCK_SIZE);   // case 10, 19
+   size_t offset, got;                    // case 10, 19
+   std::unique_ptr<fvm::interfaces::IContentReader> reader; // case 10, 19
+   std::unique_ptr<fvm::interfaces::IContentWriter> writer; // case 19
+   unsigned long long link;               // case 19
    std::string tree_content;              // case 11
    std::vector<std::string> ls_content;   // case 13
    std::vector<std::pair<unsigned long long, fvm::versionNode>> version_content; // case 15
    std::string file_name;                 // case 19
    std::string cmd;                       // case 19
-   std::string content;                   // case 19
    std::string tmp;                       // case 19
    std::ifstream in;                      // case 19
    std::vector<std::string> path;         // case 20
@@ -165,8 +170,12 @@ bool Terminal::execute(unsigned long long pid, std::vector<std::string> paramete
       break;
 
       case 10:
-      if (!file_system_.get_content(parameter[0], get_content_content)) return false;
-      else std::cout << get_content_content << '\n';
+      reader = file_system_.open_reader(parameter[0]);
+      if (!reader) return false;
+      for (offset = 0; (got = reader->read_at(offset, block.data(), block.size())) > 0; offset += got) {
+         std::cout.write(block.data(), got);
+      }
+      std::cout << '\n';
       break;
 
       case 11:
@@ -249,24 +258,28 @@ bool Terminal::execute(unsigned long long pid, std::vector<std::string> paramete
       system(cmd.c_str());
       cmd = "touch -f " + file_name;
       system(cmd.c_str());
-      if (file_system_.get_content(parameter[0], content)) {
-         std::ofstream out(file_name);
-         out << content;
+      reader = file_system_.open_reader(parameter[0]);
+      if (reader) {
+         std::ofstream out(file_name, std::ios::binary);
+         for (offset = 0; (got = reader->read_at(offset, block.data(), block.size())) > 0; offset += got) {
+            out.write(block.data(), got);
+         }
          out.close();
+         reader.reset();
       }
       cmd = "vim " + file_name;
       system(cmd.c_str());
+      file_system_.make_file(parameter[0]);
+      writer = file_system_.open_writer(parameter[0]);
       in.open(file_name);
-      content.clear();
-      while (std::getline(in, tmp)) {
-         content += tmp;
-         content.push_back('\n');
+      while (writer && std::getline(in, tmp)) {
+         tmp.push_back('\n');
+         writer->write(tmp.data(), tmp.size());
       }
       in.close();
       cmd = "rm -f " + file_name;
       system(cmd.c_str());
-      file_system_.make_file(parameter[0]);
-      if (!file_system_.update_content(parameter[0], content)) return false;
+      if (!writer || !writer->commit(link)) return false;
       break;
 
       case 20:
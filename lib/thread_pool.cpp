@@ -0,0 +1,113 @@
+/**
+  ___ _                 _
+ / __| |__   __ _ _ __ | |_    /\/\   ___  ___
+/ /  | '_ \ / _` | '_ \| __|  /    \ / _ \/ _ \
+/ /___| | | | (_| | | | | |_  / /\  |  __|  __/
+\____/|_| |_|\__,_|_| |_|\__| \/  \/\___|\___|
+
+@ Author: Mu Xiangyu, Chant Mee
+*/
+
+#ifndef THREAD_POOL_CPP
+#define THREAD_POOL_CPP
+
+#include "fvm/thread_pool.h"
+#include <algorithm>
+#include <exception>
+
+namespace fvm {
+
+ThreadPool::ThreadPool(size_t threads) {
+    for (size_t i = 1; i < threads; i++) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::default_thread_count() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;  // Stopping and drained
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t grain,
+                              const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = std::min(size(), (count + grain - 1) / grain);
+    if (chunks <= 1) {
+        body(0, count);
+        return;
+    }
+
+    // Completion latch shared by the ranges handed to workers, along with the
+    // first exception thrown by any range
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t pending = chunks - 1;
+    std::exception_ptr error;
+    auto run = [&](size_t b, size_t e) {
+        try {
+            body(b, e);
+        } catch (...) {
+            std::lock_guard<std::mutex> done_lock(done_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    size_t step = count / chunks, extra = count % chunks;
+    size_t begin = 0;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t c = 0; c < chunks; c++) {
+        size_t end = begin + step + (c < extra ? 1 : 0);
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t c = 1; c < chunks; c++) {
+            size_t b = ranges[c].first, e = ranges[c].second;
+            tasks_.emplace_back([&, b, e] {
+                run(b, e);
+                std::lock_guard<std::mutex> done_lock(done_mutex);
+                if (--pending == 0) done_cv.notify_one();
+            });
+        }
+    }
+    cv_.notify_all();
+
+    run(ranges[0].first, ranges[0].second);
+
+    // The tasks refer to this frame, so wait for all of them before rethrowing
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&] { return pending == 0; });
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace fvm
+
+#endif // THREAD_POOL_CPP
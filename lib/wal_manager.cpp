@@ -2,11 +2,94 @@
 #define WAL_MANAGER_CPP
 
 #include "fvm/wal_manager.h"
+#include "fvm/byte_order.h"
+#include "fvm/crc32c.h"
+#include "fvm/precision.h"
+#include "fvm/record_format.h"
+#include "fvm/thread_pool.h"
 #include <sstream>
 #include <fstream>
+#include <iterator>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace fvm {
 
+namespace {
+
+// Force written data to stable storage; macOS needs F_FULLFSYNC to get past the drive cache
+int sync_file(int fd) {
+#if defined(__APPLE__)
+    if (::fcntl(fd, F_FULLFSYNC) == 0) return 0;
+    return ::fsync(fd);
+#else
+    return ::fdatasync(fd);
+#endif
+}
+
+// Header fields, payload size and checksum of a record whose bytes are all present
+bool record_valid(const char* header) {
+    const size_t header_size = WalManager::HEADER_SIZE;
+    const uint32_t payload_size = get_u32(header + header_size - 8);
+    const char* payload = header + header_size;
+    uint32_t crc = crc32c(header, header_size - 4);
+    crc = crc32c(payload, payload_size, crc);
+    if (crc != get_u32(header + header_size - 4)) return false;
+    if (static_cast<uint8_t>(header[5]) > static_cast<uint8_t>(interfaces::WalOperation::DELETE)) return false;
+
+    // The payload must hold exactly what the header describes
+    const uint32_t pairs = get_u32(header + 32);
+    const uint32_t block_size = get_u32(header + 36);
+    const size_t blocks = block_size > 0 ? (pairs + block_size - 1) / block_size : 0;
+    size_t expected = (blocks + 7) / 8;
+    if (blocks == 0) {
+        expected = static_cast<size_t>(pairs) * 2 * sizeof(double);
+    }
+    for (size_t b = 0; b < blocks && expected <= payload_size; b++) {
+        const bool narrowed = (static_cast<uint8_t>(payload[b / 8]) >> (b % 8)) & 1;
+        size_t block_pairs = std::min<size_t>(block_size, pairs - b * block_size);
+        expected += block_pairs * 2 * (narrowed ? sizeof(float) : sizeof(double));
+    }
+    return expected == payload_size;
+}
+
+// Decode a record that passed record_valid
+void decode_record(const char* header, interfaces::WalEntry& entry) {
+    const char* payload = header + WalManager::HEADER_SIZE;
+    entry.op = static_cast<interfaces::WalOperation>(static_cast<uint8_t>(header[5]));
+    entry.format = get_u32(header + 8);
+    entry.len = static_cast<int>(get_u32(header + 12));
+    entry.name_hash = get_u64(header + 16);
+    entry.data_hash = get_u64(header + 24);
+    const uint32_t pairs = get_u32(header + 32);
+    const uint32_t block_size = get_u32(header + 36);
+    const size_t blocks = block_size > 0 ? (pairs + block_size - 1) / block_size : 0;
+
+    entry.data.resize(pairs);
+    const char* p = payload + (blocks + 7) / 8;
+    for (uint32_t i = 0; i < pairs; i++) {
+        const size_t b = blocks > 0 ? i / block_size : 0;
+        if (blocks > 0 && ((static_cast<uint8_t>(payload[b / 8]) >> (b % 8)) & 1)) {
+            entry.data[i] = {get_float(p), get_float(p + sizeof(float))};
+            p += 2 * sizeof(float);
+        } else {
+            entry.data[i] = {get_double(p), get_double(p + sizeof(double))};
+            p += 2 * sizeof(double);
+        }
+    }
+}
+
+} // namespace
+
 WalManager::WalManager(const std::string& wal_file,
                        interfaces::ILogger& logger,
                        interfaces::IFileOperations* file_ops)
@@ -18,6 +101,10 @@ WalManager::WalManager(const std::string& wal_file,
 }
 
 WalManager::~WalManager() {
+    stop_writer();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
     if (owns_file_ops_ && file_ops_) {
         delete file_ops_;
     }
@@ -26,74 +113,686 @@ WalManager::~WalManager() {
 bool WalManager::append_entry(const interfaces::WalEntry& entry) {
     if (!enabled_) return true;  // Return true but don't write or increment
 
-    // WAL entry format: op name_hash data_hash len [pairs...]
-    std::ostringstream oss;
-    oss << static_cast<int>(entry.op) << ' '
-        << entry.name_hash << ' '
-        << entry.data_hash << ' '
-        << entry.len;
+    // With the writer thread running, queue behind earlier submissions to keep their order
+    if (ring_) {
+        return wait_for(submit(entry), false);
+    }
 
-    for (const auto& pr : entry.data) {
-        oss << ' ' << pr.first << ' ' << pr.second;
+    std::string record;
+    encode_record(entry, record);
+
+    // Queue the record and wait until a group commit has covered it
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    pending_ += record;
+    uint64_t seq = ++next_seq_;
+    if (!commit_through(lock, seq)) {
+        return false;
     }
-    oss << '\n';
 
-    std::string wal_line = oss.str();
+    entry_count_++;
 
-    // Append to WAL file
-    bool append_ok;
-    if (file_ops_) {
-        append_ok = file_ops_->append_file(wal_file_, wal_line);
-    } else {
-        std::ofstream out(wal_file_, std::ios::app | std::ios::binary);
-        if (!out.good()) {
-            logger_.log("WalManager: Failed to open WAL file for appending",
-                       interfaces::LogLevel::FATAL, __LINE__);
-            return false;
+    return true;
+}
+
+void WalManager::encode_record(const interfaces::WalEntry& entry, std::string& record) const {
+    // Blocks that fit are written with float precision; they narrow back to the same floats
+    unsigned format = entry.format & ~RECORD_FLOAT32;
+    std::vector<bool> float_blocks;
+    if (float32_enabled_ && block_size_ > 0 && entry.data.size() % block_size_ == 0) {
+        for (size_t b = 0; b < entry.data.size() / block_size_; b++) {
+            float_blocks.push_back(fits_float32(entry.data.data() + b * block_size_, block_size_, format));
+            if (float_blocks.back()) format |= RECORD_FLOAT32;
         }
-        out << wal_line;
-        out.close();
-        append_ok = out.good();
     }
 
-    if (!append_ok) {
-        logger_.log("WalManager: Failed to write to WAL file",
-                   interfaces::LogLevel::FATAL, __LINE__);
+    // Header; the payload size and checksum are filled in once the payload is written
+    const bool narrowed = (format & RECORD_FLOAT32) != 0;
+    record.clear();
+    record.reserve(HEADER_SIZE + entry.data.size() * 2 * sizeof(double) + float_blocks.size() / 8 + 1);
+    put_u32(record, MAGIC);
+    record.push_back(static_cast<char>(VERSION));
+    record.push_back(static_cast<char>(entry.op));
+    record.append(2, '\0');
+    put_u32(record, format);
+    put_u32(record, static_cast<uint32_t>(entry.len));
+    put_u64(record, entry.name_hash);
+    put_u64(record, entry.data_hash);
+    put_u32(record, static_cast<uint32_t>(entry.data.size()));
+    put_u32(record, narrowed ? static_cast<uint32_t>(block_size_) : 0);
+    record.append(8, '\0');
+
+    // Payload: a bitmap of the narrowed blocks if any, then the pairs as doubles or floats
+    if (narrowed) {
+        for (size_t b = 0; b < float_blocks.size(); b += 8) {
+            uint8_t bits = 0;
+            for (size_t k = 0; k < 8 && b + k < float_blocks.size(); k++) {
+                if (float_blocks[b + k]) bits |= 1u << k;
+            }
+            record.push_back(static_cast<char>(bits));
+        }
+    }
+    for (size_t i = 0; i < entry.data.size(); i++) {
+        const auto& pr = entry.data[i];
+        if (narrowed && float_blocks[i / block_size_]) {
+            put_float(record, static_cast<float>(pr.first));
+            put_float(record, static_cast<float>(pr.second));
+        } else {
+            put_double(record, pr.first);
+            put_double(record, pr.second);
+        }
+    }
+
+    // The checksum covers the header up to itself and the payload
+    std::string trailer;
+    put_u32(trailer, static_cast<uint32_t>(record.size() - HEADER_SIZE));
+    record.replace(HEADER_SIZE - 8, 4, trailer);
+    uint32_t crc = crc32c(record.data(), HEADER_SIZE - 4);
+    crc = crc32c(record.data() + HEADER_SIZE, record.size() - HEADER_SIZE, crc);
+    trailer.clear();
+    put_u32(trailer, crc);
+    record.replace(HEADER_SIZE - 4, 4, trailer);
+}
+
+bool WalManager::start_writer() {
+    if (ring_) return true;
+    ring_.reset(new MpscRing<std::string>(RING_CAPACITY));
+    writer_stopping_ = false;
+    written_seq_ = durable_seq_ = sync_request_ = writer_failed_seq_ = 0;
+    try {
+        writer_ = std::thread(&WalManager::writer_loop, this);
+    } catch (const std::system_error&) {
+        ring_.reset();
+        logger_.log("WalManager: Failed to start the WAL writer thread",
+                   interfaces::LogLevel::WARNING, __LINE__);
         return false;
     }
+    return true;
+}
+
+void WalManager::stop_writer() {
+    if (!ring_) return;
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        writer_stopping_ = true;
+    }
+    writer_cv_.notify_one();
+    writer_.join();
+    ring_.reset();
+}
+
+uint64_t WalManager::submit(const interfaces::WalEntry& entry) {
+    if (!enabled_) return 0;
+    if (!ring_) {
+        if (!append_entry(entry)) return 0;
+        std::lock_guard<std::mutex> lock(commit_mutex_);
+        return next_seq_;
+    }
 
+    std::string record;
+    encode_record(entry, record);
+
+    uint64_t position;
+    while (!ring_->try_push(record, position)) {
+        // Full: the writer is behind, let it catch up
+        writer_cv_.notify_one();
+        std::this_thread::yield();
+    }
     entry_count_++;
 
-    return true;
+    // Pairs with the writer publishing writer_idle_ before its last look at the ring
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writer_idle_.load()) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        writer_cv_.notify_one();
+    }
+    return position + 1;
 }
 
-bool WalManager::load_and_replay(std::function<void(const interfaces::WalEntry&)> replay_callback) {
-    if (!enabled_) return true;
+bool WalManager::wait(uint64_t seq) {
+    if (!ring_) return sync();
+    return wait_for(seq, true);
+}
 
-    std::ifstream* in_ptr = nullptr;
-    bool using_file_ops = false;
+bool WalManager::wait_for(uint64_t seq, bool durable) {
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    if (durable && sync_request_ < seq) {
+        sync_request_ = seq;
+        writer_cv_.notify_one();
+    }
+    auto failed = [&] { return writer_failed_seq_ != 0 && seq >= writer_failed_seq_; };
+    waiter_cv_.wait(lock, [&] {
+        return (durable ? durable_seq_ : written_seq_) >= seq || failed();
+    });
+    return !failed();
+}
+
+void WalManager::writer_loop() {
+    std::string batch, record;
+    bool timed_out = false;
+    while (true) {
+        batch.clear();
+        size_t records = 0;
+        while (batch.size() < MAX_BATCH_BYTES && ring_->try_pop(record)) {
+            batch += record;
+            records++;
+        }
+        const uint64_t last = ring_->popped();
+
+        bool force_sync;
+        {
+            std::unique_lock<std::mutex> lock(writer_mutex_);
+            // Sync once every record a caller waits on is in this batch, or after an idle interval.
+            // After a failure nothing more can be promised, so requests are not retried.
+            const bool sync_pending = sync_request_ > durable_seq_ && writer_failed_seq_ == 0;
+            force_sync = (sync_pending && sync_request_ <= last) ||
+                         (timed_out && sync_policy_ == interfaces::WalSyncPolicy::INTERVAL &&
+                          written_seq_ > durable_seq_);
+            timed_out = false;
+            if (batch.empty() && !force_sync) {
+                if (!ring_->empty()) {
+                    // A producer claimed a slot but has not filled it yet
+                    lock.unlock();
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (writer_stopping_) break;
+
+                // Sleep until a producer or waiter needs us; the timeout drives interval syncs
+                auto timeout = std::chrono::milliseconds(50);
+                if (sync_policy_ == interfaces::WalSyncPolicy::INTERVAL && written_seq_ > durable_seq_) {
+                    timeout = std::max(sync_interval_, std::chrono::milliseconds(1));
+                }
+                writer_idle_.store(true);
+                if (ring_->empty() && !writer_stopping_ && !sync_pending) {
+                    timed_out = writer_cv_.wait_for(lock, timeout) == std::cv_status::timeout;
+                }
+                writer_idle_.store(false);
+                continue;
+            }
+        }
 
+        // Take the file the same way a group commit leader does, so both paths can mix
+        bool synced = false;
+        bool ok;
+        {
+            std::unique_lock<std::mutex> lock(commit_mutex_);
+            while (committing_) {
+                commit_cv_.wait(lock);
+            }
+            committing_ = true;
+            lock.unlock();
+            ok = write_batch(batch, records, force_sync, &synced);
+            lock.lock();
+            committing_ = false;
+            commit_cv_.notify_all();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            // A failed write or sync leaves every record not yet known durable in doubt
+            if (!ok && writer_failed_seq_ == 0) {
+                writer_failed_seq_ = durable_seq_ + 1;
+            }
+            written_seq_ = last;
+            if (synced) durable_seq_ = last;
+        }
+        waiter_cv_.notify_all();
+    }
+}
+
+bool WalManager::commit_through(std::unique_lock<std::mutex>& lock, uint64_t seq) {
+    while (committed_seq_ < seq) {
+        if (committing_) {
+            commit_cv_.wait(lock);
+            continue;
+        }
+
+        // Lead a commit of everything queued so far, including other callers' records
+        committing_ = true;
+        std::string batch;
+        batch.swap(pending_);
+        const uint64_t first = committed_seq_ + 1, last = next_seq_;
+        lock.unlock();
+        bool ok = write_batch(batch, last - first + 1, false);
+        lock.lock();
+
+        if (!ok && failed_seq_ == 0) {
+            failed_seq_ = first;
+        }
+        committed_seq_ = last;
+        committing_ = false;
+        commit_cv_.notify_all();
+    }
+
+    // After a failed write the file's tail is unknown, so later records fail too until clear()
+    return failed_seq_ == 0 || seq < failed_seq_;
+}
+
+bool WalManager::open_file() {
+    if (fd_ >= 0) return true;
+    fd_ = ::open(segment_path(active_segment_).c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        logger_.log("WalManager: Failed to open WAL file for appending",
+                   interfaces::LogLevel::FATAL, __LINE__);
+        return false;
+    }
+    return true;
+}
+
+bool WalManager::write_batch(const std::string& batch, size_t records, bool force_sync, bool* synced) {
+    discover_segments();
+
+    bool ok = true;
     if (file_ops_) {
-        in_ptr = file_ops_->get_input_stream(wal_file_, std::ios::in);
-        if (!in_ptr) {
-            // WAL file doesn't exist yet, that's ok
+        if (!batch.empty() && !file_ops_->append_file(segment_path(active_segment_), batch)) {
+            logger_.log("WalManager: Failed to write to WAL file",
+                       interfaces::LogLevel::FATAL, __LINE__);
+            return false;
+        }
+        // IFileOperations has no sync; what it wrote is as durable as it gets
+        if (synced) *synced = true;
+    } else {
+        ok = write_to_file(batch, force_sync, synced);
+    }
+    if (!ok) return false;
+
+    segment_bytes_ += batch.size();
+    segment_entries_[active_segment_] += records;
+
+    // A full segment is closed here, so the next batch starts the next one
+    if (segment_bytes_ >= segment_size_) {
+        ok = close_segment();
+        active_segment_++;
+        segment_bytes_ = 0;
+    }
+    return ok;
+}
+
+bool WalManager::write_to_file(const std::string& batch, bool force_sync, bool* synced) {
+    if (!open_file()) return false;
+
+    size_t written = 0;
+    while (written < batch.size()) {
+        ssize_t n = ::write(fd_, batch.data() + written, batch.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            logger_.log("WalManager: Failed to write to WAL file",
+                       interfaces::LogLevel::FATAL, __LINE__);
             return false;
         }
-        using_file_ops = true;
+        written += static_cast<size_t>(n);
+    }
+
+    // Without the writer thread nothing wakes up for INTERVAL, so it is only checked here
+    auto now = std::chrono::steady_clock::now();
+    bool sync_now = force_sync ||
+                    sync_policy_ == interfaces::WalSyncPolicy::PER_COMMIT ||
+                    (sync_policy_ == interfaces::WalSyncPolicy::INTERVAL && now - last_sync_ >= sync_interval_);
+    if (sync_now) {
+        if (sync_file(fd_) != 0) {
+            logger_.log("WalManager: Failed to sync WAL file",
+                       interfaces::LogLevel::FATAL, __LINE__);
+            return false;
+        }
+        last_sync_ = now;
+        segment_unsynced_ = false;
+        if (synced) *synced = true;
+    } else if (!batch.empty()) {
+        segment_unsynced_ = true;
+    }
+    return true;
+}
+
+std::string WalManager::segment_path(uint64_t seq) const {
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".%08llu", static_cast<unsigned long long>(seq));
+    return wal_file_ + suffix;
+}
+
+bool WalManager::read_file(const std::string& path, std::string& content) {
+    std::ifstream* in_ptr = nullptr;
+    if (file_ops_) {
+        in_ptr = file_ops_->get_input_stream(path, std::ios::in | std::ios::binary);
+        if (!in_ptr) return false;
     } else {
-        in_ptr = new std::ifstream(wal_file_);
+        in_ptr = new std::ifstream(path, std::ios::binary);
         if (!in_ptr->good()) {
-            // WAL file doesn't exist yet, that's ok
             delete in_ptr;
             return false;
         }
     }
 
-    std::ifstream& in = *in_ptr;
+    content.assign(std::istreambuf_iterator<char>(*in_ptr), std::istreambuf_iterator<char>());
+
+    if (file_ops_) {
+        file_ops_->close_input_stream(in_ptr);
+    } else {
+        in_ptr->close();
+        delete in_ptr;
+    }
+    return true;
+}
+
+bool WalManager::segment_exists(uint64_t seq) {
+    const std::string path = segment_path(seq);
+    if (file_ops_) {
+        if (file_ops_->file_exists(path)) return true;
+        std::ifstream* in_ptr = file_ops_->get_input_stream(path, std::ios::in | std::ios::binary);
+        if (!in_ptr) return false;
+        file_ops_->close_input_stream(in_ptr);
+        return true;
+    }
+    std::ifstream in(path, std::ios::binary);
+    return in.good();
+}
+
+void WalManager::discover_segments() {
+    if (segments_known_) return;
+    segments_known_ = true;
+
+    std::string head;
+    first_segment_ = 1;
+    if (read_file(wal_file_ + ".head", head)) {
+        unsigned long long value = std::strtoull(head.c_str(), nullptr, 10);
+        if (value > 0) first_segment_ = value;
+    }
+
+    // Segments are numbered without gaps; start a new one after the last
+    active_segment_ = first_segment_;
+    while (segment_exists(active_segment_)) {
+        active_segment_++;
+    }
+    segment_bytes_ = 0;
+}
+
+bool WalManager::close_segment() {
+    bool ok = true;
+    if (fd_ >= 0) {
+        // sync() promises durability for everything appended, including closed segments
+        if (segment_unsynced_ && sync_file(fd_) != 0) {
+            logger_.log("WalManager: Failed to sync WAL segment",
+                       interfaces::LogLevel::FATAL, __LINE__);
+            ok = false;
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    segment_unsynced_ = false;
+    return ok;
+}
+
+uint64_t WalManager::roll_locked() {
+    discover_segments();
+    if (segment_bytes_ > 0) {
+        close_segment();
+        active_segment_++;
+        segment_bytes_ = 0;
+    }
+    return active_segment_;
+}
+
+bool WalManager::retire_locked(uint64_t before) {
+    discover_segments();
+    before = std::min(before, active_segment_);
+
+    // Move the head first: a crash part way through leaves unreferenced files, not holes
+    if (before > first_segment_ && !atomic_write(wal_file_ + ".head", std::to_string(before))) {
+        return false;
+    }
+
+    auto remove_file = [&](const std::string& path) {
+        if (file_ops_) {
+            file_ops_->delete_file(path);
+        } else {
+            std::remove(path.c_str());
+        }
+    };
+    remove_file(wal_file_);
+    for (uint64_t seq = first_segment_; seq < before; seq++) {
+        remove_file(segment_path(seq));
+    }
+    first_segment_ = std::max(first_segment_, before);
+
+    for (auto it = segment_entries_.begin(); it != segment_entries_.end() && it->first < before;) {
+        entry_count_ -= std::min<size_t>(entry_count_, it->second);
+        it = segment_entries_.erase(it);
+    }
+    return true;
+}
+
+uint64_t WalManager::roll_segment() {
+    if (ring_) {
+        wait_for(ring_->pushed(), false);
+    }
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    commit_through(lock, next_seq_);
+    while (committing_) {
+        commit_cv_.wait(lock);
+    }
+    return roll_locked();
+}
+
+bool WalManager::retire_segments(uint64_t before) {
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    while (committing_) {
+        commit_cv_.wait(lock);
+    }
+    return retire_locked(before);
+}
+
+void WalManager::set_segment_size(size_t bytes) {
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    segment_size_ = std::max<size_t>(bytes, 1);
+}
+
+bool WalManager::sync() {
+    if (ring_) {
+        return wait_for(ring_->pushed(), true);
+    }
+
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    if (!commit_through(lock, next_seq_)) {
+        return false;
+    }
+
+    // Wait out a commit another caller may have started, then sync whatever it wrote
+    while (committing_) {
+        commit_cv_.wait(lock);
+    }
+    committing_ = true;
+    lock.unlock();
+    bool ok = write_batch(std::string(), 0, true);
+    lock.lock();
+    committing_ = false;
+    commit_cv_.notify_all();
+    return ok;
+}
+
+void WalManager::set_sync_policy(interfaces::WalSyncPolicy policy, unsigned interval_ms) {
+    // The writer thread reads the policy under writer_mutex_, commits under commit_mutex_
+    std::lock_guard<std::mutex> lock(commit_mutex_);
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    sync_policy_ = policy;
+    sync_interval_ = std::chrono::milliseconds(interval_ms);
+}
+
+bool WalManager::load_and_replay(std::function<void(const interfaces::WalEntry&)> replay_callback) {
+    if (!enabled_) return true;
+
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    discover_segments();
+
+    // The pre-segment WAL file comes first; only the old text format is replayed on its own
+    bool found = false;
+    std::vector<ReplaySource> sources;
+    std::string legacy;
+    if (read_file(wal_file_, legacy)) {
+        found = true;
+        if (legacy.size() >= 4 && get_u32(legacy.data()) == MAGIC) {
+            sources.push_back({0, wal_file_, legacy.data(), legacy.size(), nullptr, 0});
+        } else {
+            size_t before = entry_count_;
+            replay_legacy(legacy, replay_callback);
+            segment_entries_[0] += entry_count_ - before;
+        }
+    }
+
+    // Then every live segment in order, mapped rather than read where possible
+    std::vector<std::string> contents;
+    contents.reserve(active_segment_ - first_segment_);
+    for (uint64_t seq = first_segment_; seq < active_segment_; seq++) {
+        ReplaySource source{seq, segment_path(seq), nullptr, 0, nullptr, 0};
+        if (!file_ops_ && map_file(source)) {
+            found = true;
+            sources.push_back(source);
+            continue;
+        }
+        contents.emplace_back();
+        if (!read_file(source.path, contents.back())) continue;
+        found = true;
+        source.data = contents.back().data();
+        source.size = contents.back().size();
+        sources.push_back(source);
+    }
+
+    replay_binary(sources, replay_callback);
+
+    for (auto& source : sources) {
+        if (source.mapping) {
+            ::munmap(source.mapping, source.mapping_size);
+        }
+    }
+
+    // Replayed entries stay in the log until a checkpoint covers them and retires their segments
+    return found;
+}
+
+bool WalManager::map_file(ReplaySource& source) {
+    int fd = ::open(source.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    bool ok = ::fstat(fd, &st) == 0;
+    if (ok && st.st_size > 0) {
+        void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ok = false;
+        } else {
+            ::madvise(mapping, st.st_size, MADV_SEQUENTIAL | MADV_WILLNEED);
+            source.mapping = mapping;
+            source.mapping_size = st.st_size;
+            source.data = static_cast<const char*>(mapping);
+            source.size = st.st_size;
+        }
+    }
+    ::close(fd);
+    return ok;
+}
+
+void WalManager::replay_binary(const std::vector<ReplaySource>& sources,
+                               const std::function<void(const interfaces::WalEntry&)>& replay_callback) {
+    // Split every source at record boundaries; only the fixed headers are read here
+    struct Record {
+        const char* header;
+        size_t source;
+    };
+    std::vector<Record> records;
+    std::vector<size_t> source_end(sources.size());
+    for (size_t s = 0; s < sources.size(); s++) {
+        const ReplaySource& source = sources[s];
+        size_t pos = 0;
+        while (pos < source.size) {
+            const char* header = source.data + pos;
+            const size_t remaining = source.size - pos;
+
+            // A record cut short by a crash can only be the last one; stop at the first bad record
+            const char* problem = nullptr;
+            if (remaining < HEADER_SIZE) {
+                problem = "Torn WAL record header";
+            } else if (get_u32(header) != MAGIC || static_cast<uint8_t>(header[4]) != VERSION) {
+                problem = "Unknown WAL record";
+            } else if (get_u32(header + HEADER_SIZE - 8) > remaining - HEADER_SIZE) {
+                problem = "Torn WAL record";
+            }
+            if (problem) {
+                logger_.log("WalManager: " + std::string(problem) + " at offset " + std::to_string(pos) +
+                            " of " + source.path + ", ignoring the tail", interfaces::LogLevel::WARNING, __LINE__);
+                break;
+            }
+            records.push_back({header, s});
+            pos += HEADER_SIZE + get_u32(header + HEADER_SIZE - 8);
+        }
+        source_end[s] = records.size();
+    }
+
+    // Checksums and payload layouts are checked in parallel
+    ThreadPool pool(ThreadPool::default_thread_count());
+    std::vector<char> valid(records.size());
+    pool.parallel_for(records.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            valid[i] = record_valid(records[i].header);
+        }
+    });
+
+    // A bad record ends its source: drop it and everything after it in the same source
+    size_t kept = 0;
+    for (size_t s = 0, i = 0; s < sources.size(); s++) {
+        size_t count = 0;
+        for (; i < source_end[s]; i++) {
+            if (!valid[i]) {
+                logger_.log("WalManager: Damaged WAL record at offset " +
+                            std::to_string(records[i].header - sources[s].data) + " of " + sources[s].path +
+                            ", ignoring the tail", interfaces::LogLevel::WARNING, __LINE__);
+                i = source_end[s];
+                break;
+            }
+            records[kept++] = records[i];
+            count++;
+        }
+        entry_count_ += count;
+        segment_entries_[sources[s].seq] += count;
+    }
+    records.resize(kept);
+
+    // Last writer wins: only the final record of each name decides its state after replay
+    std::unordered_map<uint64_t, size_t> last;
+    last.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        last[get_u64(records[i].header + 16)] = i;
+    }
+    std::vector<size_t> winners;
+    winners.reserve(last.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        if (last[get_u64(records[i].header + 16)] == i) {
+            winners.push_back(i);
+        }
+    }
+
+    // Decode winners in parallel a chunk at a time, then hand them over in log order
+    const size_t chunk = 1024;
+    std::vector<interfaces::WalEntry> entries(std::min(chunk, winners.size()));
+    for (size_t first = 0; first < winners.size(); first += chunk) {
+        const size_t count = std::min(chunk, winners.size() - first);
+        pool.parallel_for(count, 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                decode_record(records[winners[first + i]].header, entries[i]);
+            }
+        });
+        for (size_t i = 0; i < count; i++) {
+            replay_callback(entries[i]);
+        }
+    }
+}
+
+void WalManager::replay_legacy(const std::string& content,
+                               const std::function<void(const interfaces::WalEntry&)>& replay_callback) {
+    // Text format written before the binary one: op name_hash data_hash len[:format] [pairs...]
+    std::istringstream in(content);
     std::string line;
     int op_type;
     unsigned long long name_hash, data_hash;
     int len;
+    unsigned format;
     std::vector<std::pair<double, double>> data;
 
     while (std::getline(in, line)) {
@@ -106,54 +805,61 @@ bool WalManager::load_and_replay(std::function<void(const interfaces::WalEntry&)
             continue;
         }
 
-        data.clear();
-        // Note: We need encryptor's block size here, but for now we'll use a default
-        // This will need to be passed in during full integration
-        int block_size = 16;  // Default block size
-        for (int i = 0; i < len * block_size; i++) {
-            double a, b;
-            if (!(iss >> a >> b)) {
-                logger_.log("WalManager: Invalid WAL data pair",
+        format = 0;
+        if (iss.peek() == ':') {
+            iss.get();
+            if (!(iss >> format)) {
+                logger_.log("WalManager: Invalid WAL record format",
                            interfaces::LogLevel::WARNING, __LINE__);
-                break;
+                continue;
             }
+        }
+
+        // Every entry is one line, so its pairs run to the end of the line
+        data.clear();
+        double a, b;
+        while (iss >> a >> b) {
             data.push_back(std::make_pair(a, b));
         }
+        if (!iss.eof()) {
+            logger_.log("WalManager: Invalid WAL data pair",
+                       interfaces::LogLevel::WARNING, __LINE__);
+        }
 
         interfaces::WalEntry entry;
         entry.op = static_cast<interfaces::WalOperation>(op_type);
         entry.name_hash = name_hash;
         entry.data_hash = data_hash;
         entry.len = len;
+        entry.format = format;
         entry.data = data;
 
         replay_callback(entry);
         entry_count_++;
     }
+}
 
-    if (using_file_ops) {
-        file_ops_->close_input_stream(in_ptr);
-    } else {
-        in.close();
-        delete in_ptr;
+bool WalManager::clear() {
+    // Submitted records go to the log before it is cleared, like queued ones
+    if (ring_) {
+        wait_for(ring_->pushed(), false);
+        {
+            // Cleared records need no sync any more
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            writer_failed_seq_ = 0;
+            durable_seq_ = written_seq_;
+        }
+        waiter_cv_.notify_all();
     }
 
-    // After replaying WAL, clear it
-    if (entry_count_ > 0) {
-        clear();
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    commit_through(lock, next_seq_);
+    while (committing_) {
+        commit_cv_.wait(lock);
     }
+    failed_seq_ = 0;
 
-    return true;
-}
-
-bool WalManager::clear() {
-    if (file_ops_) {
-        return file_ops_->write_file(wal_file_, "");
-    } else {
-        std::ofstream out(wal_file_, std::ios::trunc);
-        out.close();
-        return out.good();
-    }
+    return retire_locked(roll_locked());
 }
 
 bool WalManager::atomic_write(const std::string& filename, const std::string& content) {
@@ -60,6 +60,8 @@ int main() {
     // ===== Layer 3: Data Managers =====
     // FileManager must come before NodeManager
     FileManager file_manager(logger, file_manager_repo);
+    // Store revisions as deltas, with a full one every 64
+    file_manager.set_delta_revisions(64);
 
     // SaverNodeManagerRepository depends on FileManager
     SaverNodeManagerRepository node_manager_repo(saver, logger, file_manager);
@@ -97,6 +99,7 @@ int main() {
     command_interp.shutdown();
     // Note: version_manager doesn't have shutdown (no persistence)
     node_manager.shutdown();
+    file_manager.shutdown();
     saver.shutdown();
 
     return result;
@@ -31,7 +31,7 @@ public:
         return true;
     }
 
-    bool decrypt_sequence(std::vector<std::pair<double, double>>& sequence,
+    bool decrypt_sequence(const std::vector<std::pair<double, double>>& sequence,
                          std::vector<int>& res) override {
         res.clear();
         res.reserve(sequence.size());
@@ -47,6 +47,10 @@ public:
         return block_size_;
     }
 
+    unsigned get_format_tag() const override {
+        return 0;
+    }
+
     void set_block_size(int size) {
         block_size_ = size;
     }
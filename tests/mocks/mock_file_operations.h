@@ -6,12 +6,17 @@
 #include <map>
 #include <ios>
 #include <fstream>
+#include <sstream>
+#include <memory>
+#include <mutex>
 
 /**
  * @brief Mock implementation of IFileOperations for testing.
  *
  * This class stores files in memory for some operations and uses
- * real file system for stream operations.
+ * real file system for stream operations. Input streams read files
+ * written through the mock from memory, so stores saved through it
+ * can be loaded back. Safe to share with a WAL writer thread.
  */
 class MockFileOperations : public fvm::interfaces::IFileOperations {
 public:
@@ -19,21 +24,25 @@ public:
     std::map<std::string, std::ofstream*> output_streams;
 
     bool file_exists(const std::string& filepath) override {
+        std::lock_guard<std::mutex> lock(mutex_);
         return files.count(filepath) > 0;
     }
 
     bool read_file(const std::string& filepath, std::string& content) override {
-        if (!file_exists(filepath)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!files.count(filepath)) return false;
         content = files[filepath];
         return true;
     }
 
     bool write_file(const std::string& filepath, const std::string& content) override {
+        std::lock_guard<std::mutex> lock(mutex_);
         files[filepath] = content;
         return true;
     }
 
     bool append_file(const std::string& filepath, const std::string& content) override {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (files.count(filepath)) {
             files[filepath] += content;
         } else {
@@ -43,6 +52,7 @@ public:
     }
 
     bool delete_file(const std::string& filepath) override {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (files.count(filepath)) {
             files.erase(filepath);
             return true;
@@ -51,14 +61,16 @@ public:
     }
 
     bool rename_file(const std::string& old_path, const std::string& new_path) override {
-        if (!file_exists(old_path)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!files.count(old_path)) return false;
         files[new_path] = files[old_path];
         files.erase(old_path);
         return true;
     }
 
     bool file_size(const std::string& filepath, size_t& size) override {
-        if (!file_exists(filepath)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!files.count(filepath)) return false;
         size = files[filepath].size();
         return true;
     }
@@ -79,7 +91,20 @@ public:
 
     std::ifstream* get_input_stream(const std::string& filepath,
                                     std::ios_base::openmode mode) override {
-        // For testing, use real file system - tests can write temp files
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = files.find(filepath);
+            if (it != files.end()) {
+                // Read a snapshot of the in-memory file through the stream's buffer
+                auto stream = new std::ifstream();
+                auto buffer = std::make_unique<std::stringbuf>(it->second, std::ios::in);
+                static_cast<std::ios&>(*stream).rdbuf(buffer.get());
+                input_buffers_[stream] = std::move(buffer);
+                return stream;
+            }
+        }
+
+        // Otherwise use real file system - tests can write temp files
         auto stream = new std::ifstream(filepath, mode);
         if (stream->good()) {
             return stream;
@@ -90,6 +115,15 @@ public:
 
     void close_input_stream(std::ifstream* stream) override {
         if (stream) {
+            std::unique_ptr<std::stringbuf> buffer;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = input_buffers_.find(stream);
+                if (it != input_buffers_.end()) {
+                    buffer = std::move(it->second);
+                    input_buffers_.erase(it);
+                }
+            }
             stream->close();
             delete stream;
         }
@@ -97,8 +131,13 @@ public:
 
     // Helper method for testing - clear all files
     void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
         files.clear();
     }
+
+private:
+    std::mutex mutex_;
+    std::map<std::ifstream*, std::unique_ptr<std::stringbuf>> input_buffers_;
 };
 
 #endif // MOCK_FILE_OPERATIONS_H
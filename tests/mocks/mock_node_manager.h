@@ -3,7 +3,10 @@
 
 #include "fvm/interfaces/INodeManager.h"
 #include "fvm/interfaces/ISystemClock.h"
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -32,6 +35,43 @@ private:
     interfaces::ISystemClock* clock_ = nullptr;
     bool initialized_ = false;
 
+    // Reads a copy of the content taken when opened
+    class Reader : public interfaces::IContentReader {
+    private:
+        std::string content_;
+    public:
+        explicit Reader(std::string content) : content_(std::move(content)) {}
+        size_t size() const override { return content_.size(); }
+        size_t read_at(size_t offset, char* buffer, size_t length) override {
+            if (offset >= content_.size()) return 0;
+            length = std::min(length, content_.size() - offset);
+            std::memcpy(buffer, content_.data() + offset, length);
+            return length;
+        }
+    };
+
+    // Buffers the content and hands it to update_content() on commit
+    class Writer : public interfaces::IContentWriter {
+    private:
+        MockNodeManager& owner_;
+        unsigned long long idx_;
+        std::string content_;
+        bool committed_ = false;
+    public:
+        Writer(MockNodeManager& owner, unsigned long long idx) : owner_(owner), idx_(idx) {}
+        bool write(const char* data, size_t length) override {
+            if (committed_) return false;
+            content_.append(data, length);
+            return true;
+        }
+        bool commit(unsigned long long& id) override {
+            if (committed_ || !owner_.node_exist(idx_)) return false;
+            committed_ = true;
+            id = owner_.update_content(idx_, content_);
+            return true;
+        }
+    };
+
     // Helper to get current time
     std::string get_current_time() const {
         if (clock_) {
@@ -152,6 +192,18 @@ public:
         return 0;
     }
 
+    // Streaming access
+    std::unique_ptr<interfaces::IContentReader> open_reader(unsigned long long idx) override {
+        auto it = nodes_.find(idx);
+        if (it == nodes_.end()) return nullptr;
+        return std::unique_ptr<interfaces::IContentReader>(new Reader(it->second.content));
+    }
+
+    std::unique_ptr<interfaces::IContentWriter> open_writer(unsigned long long idx) override {
+        if (!node_exist(idx)) return nullptr;
+        return std::unique_ptr<interfaces::IContentWriter>(new Writer(*this, idx));
+    }
+
     // ===== Test helper methods =====
 
     // Clear all nodes
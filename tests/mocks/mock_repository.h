@@ -9,63 +9,125 @@
 #include <string>
 #include <vector>
 
-// Forward declarations
-struct fileNode;
-struct commandNode;
-
 namespace fvm {
 namespace mocks {
 
 // ===== Mock FileManager Repository =====
 class MockFileManagerRepository : public repositories::IFileManagerRepository {
 private:
-    std::map<unsigned long long, fileNode> storage_;
+    std::map<unsigned long long, unsigned long long> counters_;
+    std::map<unsigned long long, repositories::FileRecord> files_;
+    std::map<unsigned long long, repositories::ChunkInfo> chunk_index_;
+    std::map<unsigned long long, std::string> chunks_;
+    std::map<unsigned long long, std::string> contents_;
     bool fail_on_save_ = false;
     bool fail_on_load_ = false;
+    size_t chunk_writes_ = 0;
+    size_t index_saves_ = 0;
+    size_t chunk_reads_ = 0;
 
 public:
-    bool save(const std::map<unsigned long long, fileNode>& data) override {
+    bool load_index(std::map<unsigned long long, unsigned long long>& counters) override {
+        if (fail_on_load_) return false;
+        counters = counters_;
+        return true;
+    }
+
+    bool save_index(const std::map<unsigned long long, unsigned long long>& counters) override {
         if (fail_on_save_) return false;
-        storage_ = data;
+        counters_ = counters;
+        index_saves_++;
+        return true;
+    }
+
+    bool load_file(unsigned long long fid, repositories::FileRecord& file) override {
+        if (fail_on_load_ || !files_.count(fid)) return false;
+        file = files_[fid];
         return true;
     }
 
-    bool load(std::map<unsigned long long, fileNode>& data) override {
+    bool save_file(unsigned long long fid, const repositories::FileRecord& file) override {
+        if (fail_on_save_) return false;
+        files_[fid] = file;
+        return true;
+    }
+
+    bool remove_file(unsigned long long fid) override {
+        return files_.erase(fid) > 0;
+    }
+
+    bool load_chunk_index(std::map<unsigned long long, repositories::ChunkInfo>& chunks) override {
         if (fail_on_load_) return false;
-        data = storage_;
+        chunks = chunk_index_;
+        return true;
+    }
+
+    bool save_chunk_index(const std::map<unsigned long long, repositories::ChunkInfo>& chunks) override {
+        if (fail_on_save_) return false;
+        chunk_index_ = chunks;
+        return true;
+    }
+
+    bool load_chunk(unsigned long long cid, std::string& data) override {
+        if (fail_on_load_ || !chunks_.count(cid)) return false;
+        data = chunks_[cid];
+        chunk_reads_++;
+        return true;
+    }
+
+    bool save_chunk(unsigned long long cid, const std::string& data) override {
+        if (fail_on_save_) return false;
+        chunks_[cid] = data;
+        chunk_writes_++;
         return true;
     }
 
+    bool remove_chunk(unsigned long long cid) override {
+        return chunks_.erase(cid) > 0;
+    }
+
+    bool load_content(unsigned long long fid, std::string& content) override {
+        if (fail_on_load_ || !contents_.count(fid)) return false;
+        content = contents_[fid];
+        return true;
+    }
+
+    bool remove_content(unsigned long long fid) override {
+        return contents_.erase(fid) > 0;
+    }
+
     // Test control methods
     void set_save_failure(bool fail) { fail_on_save_ = fail; }
     void set_load_failure(bool fail) { fail_on_load_ = fail; }
-    void clear() { storage_.clear(); }
-    size_t size() const { return storage_.size(); }
+    void set_legacy_content(unsigned long long fid, const std::string& content) { contents_[fid] = content; }
+    void clear() { counters_.clear(); files_.clear(); chunk_index_.clear(); chunks_.clear(); contents_.clear(); }
+    size_t size() const { return counters_.size(); }
+    size_t chunk_count() const { return chunks_.size(); }
+    size_t chunk_writes() const { return chunk_writes_; }
+    size_t index_saves() const { return index_saves_; }
+    size_t chunk_reads() const { return chunk_reads_; }
+    bool has_file(unsigned long long fid) const { return files_.count(fid) > 0; }
+    const repositories::FileRecord& file(unsigned long long fid) const { return files_.at(fid); }
+    const std::map<unsigned long long, repositories::ChunkInfo>& chunk_index() const { return chunk_index_; }
+    const std::map<unsigned long long, unsigned long long>& index() const { return counters_; }
 };
 
 // ===== Mock Node Manager Repository =====
-struct NodeData {
-    std::string name;
-    std::string create_time;
-    std::string update_time;
-    unsigned long long fid;
-    unsigned long long cnt;
-};
-
+// fvm::Node is defined in node_manager.cpp, which must be included before this header
 class MockNodeManagerRepository : public repositories::INodeManagerRepository {
 private:
-    std::map<unsigned long long, NodeData> storage_;
+    std::map<unsigned long long, std::pair<unsigned long long, Node>> storage_;
     bool fail_on_save_ = false;
     bool fail_on_load_ = false;
 
 public:
-    bool save(const std::map<unsigned long long, NodeData>& data) override {
+    bool save(const std::map<unsigned long long, std::pair<unsigned long long, Node>>& data) override {
         if (fail_on_save_) return false;
         storage_ = data;
         return true;
     }
 
-    bool load(std::map<unsigned long long, NodeData>& data) override {
+    bool load(std::map<unsigned long long, std::pair<unsigned long long, Node>>& data) override {
         if (fail_on_load_) return false;
         data = storage_;
         return true;
@@ -76,62 +138,58 @@ public:
     void set_load_failure(bool fail) { fail_on_load_ = fail; }
     void clear() { storage_.clear(); }
     size_t size() const { return storage_.size(); }
-
-    // Pre-populate with test data
-    void set_node(unsigned long long id, const NodeData& data) {
-        storage_[id] = data;
-    }
+    const Node& node(unsigned long long idx) const { return storage_.at(idx).second; }
 };
 
 // ===== Mock Version Manager Repository =====
-struct VersionNode {
-    unsigned long long node_id;
-    std::string create_time;
-    std::string description;
-    unsigned long long fid;
-};
-
+// The trees belong to the VersionManager that saved them, so nothing is kept to load:
+// every VersionManager starts as on a first run
 class MockVersionManagerRepository : public repositories::IVersionManagerRepository {
 private:
-    std::map<std::pair<unsigned long long, unsigned long long>, VersionNode> storage_;
+    size_t saves_ = 0;
     bool fail_on_save_ = false;
-    bool fail_on_load_ = false;
 
 public:
-    bool save(const std::map<std::pair<unsigned long long, unsigned long long>, VersionNode>& data) override {
+    bool save_tree_nodes(const std::map<treeNode*, unsigned long long>&) override {
         if (fail_on_save_) return false;
-        storage_ = data;
+        saves_++;
         return true;
     }
 
-    bool load(std::map<std::pair<unsigned long long, unsigned long long>, VersionNode>& data) override {
-        if (fail_on_load_) return false;
-        data = storage_;
-        return true;
+    bool load_tree_nodes(std::map<unsigned long long, treeNode*>&) override {
+        return false;
+    }
+
+    bool save_versions(const std::map<unsigned long long, versionNode>&,
+                       const std::map<treeNode*, unsigned long long>&) override {
+        return !fail_on_save_;
+    }
+
+    bool load_versions(std::map<unsigned long long, versionNode>&,
+                       std::map<unsigned long long, treeNode*>&) override {
+        return false;
     }
 
     // Test control methods
     void set_save_failure(bool fail) { fail_on_save_ = fail; }
-    void set_load_failure(bool fail) { fail_on_load_ = fail; }
-    void clear() { storage_.clear(); }
-    size_t size() const { return storage_.size(); }
+    size_t saves() const { return saves_; }
 };
 
 // ===== Mock Command Repository =====
 class MockCommandRepository : public repositories::ICommandRepository {
 private:
-    std::map<unsigned long long, commandNode> storage_;
+    std::map<unsigned long long, unsigned long long> storage_;
     bool fail_on_save_ = false;
     bool fail_on_load_ = false;
 
 public:
-    bool save(const std::map<unsigned long long, commandNode>& data) override {
+    bool save(const std::map<unsigned long long, unsigned long long>& data) override {
         if (fail_on_save_) return false;
         storage_ = data;
         return true;
     }
 
-    bool load(std::map<unsigned long long, commandNode>& data) override {
+    bool load(std::map<unsigned long long, unsigned long long>& data) override {
         if (fail_on_load_) return false;
         data = storage_;
         return true;
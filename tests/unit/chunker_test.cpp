@@ -0,0 +1,78 @@
+#ifndef CHUNKER_TEST_CPP
+#define CHUNKER_TEST_CPP
+
+#include "fvm/chunker.h"
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include <set>
+
+namespace {
+
+std::string random_bytes(size_t size, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::string data(size, '\0');
+    for (auto& c : data) c = static_cast<char>(gen());
+    return data;
+}
+
+std::set<std::string> chunks_of(const fvm::Chunker& chunker, const std::string& data) {
+    std::set<std::string> chunks;
+    size_t offset = 0;
+    for (size_t length : chunker.split(data)) {
+        chunks.insert(data.substr(offset, length));
+        offset += length;
+    }
+    return chunks;
+}
+
+} // namespace
+
+TEST(ChunkerTest, AverageIsRoundedToAPowerOfTwo) {
+    fvm::Chunker chunker(5000);
+    EXPECT_EQ(chunker.get_average(), 4096u);
+    EXPECT_EQ(chunker.get_min(), 1024u);
+    EXPECT_EQ(chunker.get_max(), 32768u);
+    EXPECT_EQ(fvm::Chunker(1).get_average(), fvm::Chunker::MIN_AVERAGE);
+    EXPECT_EQ(fvm::Chunker(~size_t(0)).get_average(), fvm::Chunker::MAX_AVERAGE);
+}
+
+TEST(ChunkerTest, SplitCoversTheInputWithinBounds) {
+    fvm::Chunker chunker(1024);
+    EXPECT_TRUE(chunker.split("").empty());
+    EXPECT_EQ(chunker.split("short"), std::vector<size_t>{5});
+
+    const std::string data = random_bytes(1 << 20, 1);
+    std::vector<size_t> lengths = chunker.split(data);
+    EXPECT_EQ(std::accumulate(lengths.begin(), lengths.end(), size_t(0)), data.size());
+    for (size_t i = 0; i + 1 < lengths.size(); i++) {
+        EXPECT_GE(lengths[i], chunker.get_min());
+        EXPECT_LE(lengths[i], chunker.get_max());
+    }
+    // Normalized chunking keeps the mean near the target
+    double mean = double(data.size()) / lengths.size();
+    EXPECT_GT(mean, 0.75 * chunker.get_average());
+    EXPECT_LT(mean, 2.0 * chunker.get_average());
+
+    // Runs without content to hash are cut at the maximum size
+    EXPECT_EQ(chunker.split(std::string(3 * chunker.get_max(), '\0')),
+              std::vector<size_t>(3, chunker.get_max()));
+}
+
+TEST(ChunkerTest, EditOnlyChangesNearbyChunks) {
+    fvm::Chunker chunker(1024);
+    const std::string data = random_bytes(1 << 20, 2);
+    std::string edited = data;
+    edited.insert(data.size() / 2, "an inserted line\n");
+    edited.erase(data.size() / 4, 100);
+
+    std::set<std::string> before = chunks_of(chunker, data);
+    std::set<std::string> after = chunks_of(chunker, edited);
+    size_t changed = 0;
+    for (const auto& chunk : after) changed += !before.count(chunk);
+    // Each edit disturbs the chunk it falls in and possibly the next one
+    EXPECT_LE(changed, 4u);
+    EXPECT_GE(after.size(), 500u);
+}
+
+#endif // CHUNKER_TEST_CPP
@@ -0,0 +1,29 @@
+#ifndef CRC32C_TEST_CPP
+#define CRC32C_TEST_CPP
+
+#include "fvm/crc32c.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+TEST(Crc32cTest, MatchesStandardCheckValues) {
+    EXPECT_EQ(fvm::crc32c("123456789", 9), 0xE3069283u);
+    EXPECT_EQ(fvm::crc32c("", 0), 0u);
+
+    // RFC 3720, B.4: 32 bytes of zeros and of ones
+    std::vector<uint8_t> zeros(32, 0x00), ones(32, 0xff);
+    EXPECT_EQ(fvm::crc32c(zeros.data(), zeros.size()), 0x8A9136AAu);
+    EXPECT_EQ(fvm::crc32c(ones.data(), ones.size()), 0x62A8AB43u);
+}
+
+TEST(Crc32cTest, ExtendsAcrossSplits) {
+    std::string data(1000, '\0');
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<char>(i * 37 + 11);
+    uint32_t whole = fvm::crc32c(data.data(), data.size());
+    for (size_t split : {1, 7, 8, 500, 999}) {
+        uint32_t crc = fvm::crc32c(data.data(), split);
+        EXPECT_EQ(fvm::crc32c(data.data() + split, data.size() - split, crc), whole) << "split " << split;
+    }
+}
+
+#endif // CRC32C_TEST_CPP
@@ -13,9 +13,9 @@ TEST_F(DataSerializerTest, SerializeEmptyContent) {
     fvm::interfaces::vvs empty;
     std::vector<int> sequence;
     ASSERT_TRUE(serializer.serialize(empty, sequence));
-    // Empty content (0 blocks) still serializes to "0"
-    EXPECT_FALSE(sequence.empty());
-    EXPECT_EQ(sequence.size(), 1);  // Just the character '0'
+    // Empty content (0 blocks) is the version header and a zero count
+    EXPECT_EQ(sequence, (std::vector<int>{fvm::DataSerializer::BINARY_MAGIC,
+                                          fvm::DataSerializer::BINARY_VERSION, 0}));
 }
 
 TEST_F(DataSerializerTest, SerializeSimpleContent) {
@@ -112,4 +112,109 @@ TEST_F(DataSerializerTest, SerializeWithSpecialCharacters) {
     }
 }
 
+TEST_F(DataSerializerTest, BinaryLayoutUsesVarintLengths) {
+    fvm::interfaces::vvs content = {{std::string(200, 'x'), "ab"}};
+    std::vector<uint8_t> bytes;
+    ASSERT_TRUE(serializer.serialize(content, bytes));
+
+    // header, 1 block, 2 cells, len 200 as a two-byte varint, data, len 2, data
+    ASSERT_EQ(bytes.size(), 2u + 1 + 1 + 2 + 200 + 1 + 2);
+    EXPECT_EQ(bytes[0], fvm::DataSerializer::BINARY_MAGIC);
+    EXPECT_EQ(bytes[1], fvm::DataSerializer::BINARY_VERSION);
+    EXPECT_EQ(bytes[2], 1);
+    EXPECT_EQ(bytes[3], 2);
+    EXPECT_EQ(bytes[4], 0xc8);
+    EXPECT_EQ(bytes[5], 0x01);
+}
+
+TEST_F(DataSerializerTest, ByteAndIntegerApisAgree) {
+    fvm::interfaces::vvs original = {{"hello", "world"}, {}, {"", std::string("\0\xff\x80", 3)}};
+    std::vector<uint8_t> bytes;
+    std::vector<int> sequence;
+    ASSERT_TRUE(serializer.serialize(original, bytes));
+    ASSERT_TRUE(serializer.serialize(original, sequence));
+    EXPECT_EQ(std::vector<int>(bytes.begin(), bytes.end()), sequence);
+
+    fvm::interfaces::vvs restored;
+    ASSERT_TRUE(serializer.deserialize(bytes.data(), bytes.size(), restored));
+    EXPECT_EQ(restored, original);
+}
+
+TEST_F(DataSerializerTest, LegacyTextFormatStillReadable) {
+    std::string legacy = "2 2 5 hello 5 world 1 3 a b";
+    fvm::interfaces::vvs restored;
+    ASSERT_TRUE(serializer.deserialize(reinterpret_cast<const uint8_t*>(legacy.data()),
+                                       legacy.size(), restored));
+    EXPECT_EQ(restored, (fvm::interfaces::vvs{{"hello", "world"}, {"a b"}}));
+
+    std::vector<int> sequence(legacy.begin(), legacy.end());
+    ASSERT_TRUE(serializer.deserialize(sequence, restored));
+    EXPECT_EQ(restored, (fvm::interfaces::vvs{{"hello", "world"}, {"a b"}}));
+}
+
+TEST_F(DataSerializerTest, DeserializeRejectsCorruptBinary) {
+    fvm::interfaces::vvs original = {{"hello", "world"}};
+    std::vector<uint8_t> bytes;
+    ASSERT_TRUE(serializer.serialize(original, bytes));
+    fvm::interfaces::vvs restored;
+
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+    EXPECT_FALSE(serializer.deserialize(truncated.data(), truncated.size(), restored));
+
+    std::vector<uint8_t> trailing = bytes;
+    trailing.push_back(0);
+    EXPECT_FALSE(serializer.deserialize(trailing.data(), trailing.size(), restored));
+
+    std::vector<uint8_t> future = bytes;
+    future[1] = fvm::DataSerializer::BINARY_VERSION + 1;
+    EXPECT_FALSE(serializer.deserialize(future.data(), future.size(), restored));
+
+    // A huge block count must fail cleanly instead of allocating
+    std::vector<uint8_t> huge = {fvm::DataSerializer::BINARY_MAGIC, fvm::DataSerializer::BINARY_VERSION,
+                                 0xff, 0xff, 0xff, 0xff, 0x0f};
+    EXPECT_FALSE(serializer.deserialize(huge.data(), huge.size(), restored));
+}
+
+TEST_F(DataSerializerTest, RecordViewMatchesVvs) {
+    fvm::interfaces::vvs original = {{"1", "2", "name", ""}, {}, {"x y", std::string("\0\xff", 2)}};
+    std::vector<int> sequence;
+    ASSERT_TRUE(serializer.serialize(original, sequence));
+
+    fvm::RecordView view;
+    ASSERT_TRUE(serializer.deserialize(sequence, view));
+    ASSERT_EQ(view.size(), 3u);
+    EXPECT_EQ(view[0].size(), 4u);
+    EXPECT_EQ(view[0][2], "name");
+    EXPECT_EQ(view[1].size(), 0u);
+    EXPECT_EQ(view[2][1], std::string_view("\0\xff", 2));
+    EXPECT_EQ(view.to_vvs(), original);
+
+    std::string legacy = "2 2 5 hello 5 world 1 3 a b";
+    ASSERT_TRUE(serializer.deserialize(std::vector<int>(legacy.begin(), legacy.end()), view));
+    EXPECT_EQ(view.to_vvs(), (fvm::interfaces::vvs{{"hello", "world"}, {"a b"}}));
+}
+
+TEST_F(DataSerializerTest, RecordViewClearedOnCorruptInput) {
+    std::vector<int> sequence;
+    ASSERT_TRUE(serializer.serialize(fvm::interfaces::vvs{{"hello"}}, sequence));
+    fvm::RecordView view;
+    ASSERT_TRUE(serializer.deserialize(sequence, view));
+
+    sequence.pop_back();
+    EXPECT_FALSE(serializer.deserialize(sequence, view));
+    EXPECT_TRUE(view.empty());
+}
+
+TEST_F(DataSerializerTest, ParseUllMatchesStringUtilities) {
+    unsigned long long value;
+    EXPECT_TRUE(fvm::parse_ull("12345", value));
+    EXPECT_EQ(value, 12345ull);
+    EXPECT_TRUE(fvm::parse_ull("18446744073709551615", value));
+    EXPECT_EQ(value, 18446744073709551615ull);
+    EXPECT_TRUE(fvm::parse_ull("", value));
+    EXPECT_EQ(value, 0ull);
+    EXPECT_FALSE(fvm::parse_ull("12a", value));
+    EXPECT_FALSE(fvm::parse_ull("-1", value));
+}
+
 #endif // DATA_SERIALIZER_TEST_CPP
@@ -0,0 +1,73 @@
+#ifndef DELTA_TEST_CPP
+#define DELTA_TEST_CPP
+
+#include "fvm/delta.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+std::string random_text(size_t lines, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::string text;
+    for (size_t i = 0; i < lines; i++) text += "line " + std::to_string(gen()) + " of the file\n";
+    return text;
+}
+
+std::string round_trip(const std::string& base, const std::string& target) {
+    std::string delta = fvm::delta::encode(base, target);
+    std::string result;
+    EXPECT_TRUE(fvm::delta::decode(base, delta, result));
+    return result;
+}
+
+} // namespace
+
+TEST(DeltaTest, RoundTripsEdgeCases) {
+    const std::string text = random_text(100, 1);
+    EXPECT_EQ(round_trip("", ""), "");
+    EXPECT_EQ(round_trip("", text), text);
+    EXPECT_EQ(round_trip(text, ""), "");
+    EXPECT_EQ(round_trip(text, text), text);
+    EXPECT_EQ(round_trip("short", "shorter"), "shorter");
+    EXPECT_EQ(round_trip(text, text + text), text + text);
+}
+
+TEST(DeltaTest, SmallEditGivesSmallDelta) {
+    const std::string base = random_text(20000, 2);
+    std::string target = base;
+    target.insert(base.size() / 3, "an inserted line\n");
+    target.erase(base.size() / 2, 500);
+    target.replace(base.size() * 3 / 4, 10, "0123456789");
+    // Moved text is found as well
+    target += base.substr(1000, 4000);
+
+    std::string delta = fvm::delta::encode(base, target);
+    EXPECT_LT(delta.size(), 200u);
+    std::string result;
+    ASSERT_TRUE(fvm::delta::decode(base, delta, result));
+    EXPECT_EQ(result, target);
+}
+
+TEST(DeltaTest, RejectsAWrongBaseOrACorruptDelta) {
+    const std::string base = random_text(1000, 3);
+    std::string target = base;
+    target[100] = '#';
+    std::string delta = fvm::delta::encode(base, target);
+    std::string result;
+
+    std::string other = base;
+    other[5000] = '#';
+    EXPECT_FALSE(fvm::delta::decode(other, delta, result));
+    EXPECT_FALSE(fvm::delta::decode(base + "x", delta, result));
+
+    for (size_t cut : {size_t(1), size_t(5), delta.size() / 2}) {
+        EXPECT_FALSE(fvm::delta::decode(base, delta.substr(0, delta.size() - cut), result));
+    }
+    std::string flipped = delta;
+    flipped.back() ^= 0x40;
+    EXPECT_FALSE(fvm::delta::decode(base, flipped, result));
+    EXPECT_TRUE(result.empty());
+}
+
+#endif // DELTA_TEST_CPP
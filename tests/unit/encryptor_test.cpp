@@ -18,6 +18,8 @@
 #include <vector>
 #include <cmath>
 #include <chrono>
+#include <cstring>
+#include <thread>
 
 // ============================================================================
 // Helper Functions
@@ -339,6 +341,369 @@ TEST_F(EncryptorTest, FFTWithSingleValue) {
     EXPECT_TRUE(vectors_equal(input, result));
 }
 
+TEST_F(EncryptorTest, FFTMatchesDirectDFT) {
+    // The planned radix-4 transform must agree with the O(N^2) definition.
+    // The first block holds the length followed by the data.
+    std::vector<int> input;
+    for (int i = 0; i < 300; i++) {
+        input.push_back((i * 37 + 11) % 256);
+    }
+    std::vector<std::pair<double, double>> encrypted;
+    ASSERT_TRUE(encryptor.encrypt_sequence(input, encrypted));
+    ASSERT_EQ(encrypted.size(), 1024u);
+
+    std::vector<double> block(1024, 0.0);
+    block[0] = static_cast<double>(input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        block[i + 1] = input[i];
+    }
+
+    const double pi = std::acos(-1.0);
+    for (int k = 0; k < 1024; k += 37) {
+        double re = 0, im = 0;
+        for (int n = 0; n < 1024; n++) {
+            double ang = 2 * pi * (static_cast<long long>(k) * n % 1024) / 1024;
+            re += block[n] * std::cos(ang);
+            im += block[n] * std::sin(ang);
+        }
+        EXPECT_NEAR(encrypted[k].first, re, 1e-6);
+        EXPECT_NEAR(encrypted[k].second, im, 1e-6);
+    }
+}
+
+// ============================================================================
+// SIMD Kernel Tests
+// ============================================================================
+
+TEST_F(EncryptorTest, DefaultIsaIsSupported) {
+    EXPECT_TRUE(fvm::fft::is_supported(encryptor.get_isa()));
+    EXPECT_TRUE(fvm::fft::is_supported(fvm::fft::Isa::SCALAR));
+}
+
+TEST_F(EncryptorTest, SimdKernelsAreBitExactWithScalar) {
+    std::vector<int> input(5000);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<int>((i * 31 + 7) % 256);
+    }
+
+    Encryptor scalar;
+    ASSERT_TRUE(scalar.set_isa(fvm::fft::Isa::SCALAR));
+    std::vector<std::pair<double, double>> expected;
+    ASSERT_TRUE(scalar.encrypt_sequence(input, expected));
+    std::vector<int> expected_plain;
+    ASSERT_TRUE(scalar.decrypt_sequence(expected, expected_plain));
+
+    const fvm::fft::Isa isas[] = {fvm::fft::Isa::SSE2, fvm::fft::Isa::AVX2, fvm::fft::Isa::AVX512};
+    for (fvm::fft::Isa isa : isas) {
+        Encryptor simd;
+        if (!simd.set_isa(isa)) continue;  // Not available on this CPU
+
+        std::vector<std::pair<double, double>> encrypted;
+        ASSERT_TRUE(simd.encrypt_sequence(input, encrypted));
+        ASSERT_EQ(encrypted.size(), expected.size());
+        EXPECT_EQ(std::memcmp(encrypted.data(), expected.data(),
+                              expected.size() * sizeof(expected[0])), 0)
+            << "forward transform differs for " << fvm::fft::isa_name(isa);
+
+        std::vector<int> decrypted;
+        ASSERT_TRUE(simd.decrypt_sequence(encrypted, decrypted));
+        EXPECT_TRUE(vectors_equal(decrypted, expected_plain));
+        EXPECT_TRUE(vectors_equal(decrypted, input));
+    }
+}
+
+// ============================================================================
+// Multi-threaded Tests
+// ============================================================================
+
+TEST_F(EncryptorTest, DefaultIsSingleThreaded) {
+    EXPECT_EQ(encryptor.get_thread_count(), 1u);
+    encryptor.set_thread_count(4);
+    EXPECT_EQ(encryptor.get_thread_count(), 4u);
+    encryptor.set_thread_count(0);
+    EXPECT_EQ(encryptor.get_thread_count(), 1u);
+}
+
+TEST_F(EncryptorTest, ParallelMatchesSerial) {
+    std::vector<int> input(100 * 1024 + 17);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<int>((i * 13 + 5) % 256);
+    }
+
+    std::vector<std::pair<double, double>> serial_encrypted;
+    ASSERT_TRUE(encryptor.encrypt_sequence(input, serial_encrypted));
+
+    for (size_t threads : {2u, 3u, 8u}) {
+        Encryptor parallel;
+        parallel.set_thread_count(threads);
+
+        std::vector<std::pair<double, double>> encrypted;
+        ASSERT_TRUE(parallel.encrypt_sequence(input, encrypted));
+        ASSERT_EQ(encrypted.size(), serial_encrypted.size());
+        EXPECT_EQ(std::memcmp(encrypted.data(), serial_encrypted.data(),
+                              encrypted.size() * sizeof(encrypted[0])), 0);
+
+        std::vector<int> decrypted;
+        ASSERT_TRUE(parallel.decrypt_sequence(encrypted, decrypted));
+        EXPECT_TRUE(vectors_equal(input, decrypted));
+    }
+}
+
+TEST_F(EncryptorTest, SharedEncryptorIsReentrant) {
+    // Blocks no longer live in the Encryptor, so concurrent callers do not interfere
+    std::vector<int> a(3000, 17), b(5000, 200);
+    std::vector<int> ra, rb;
+    std::thread ta([&] {
+        std::vector<std::pair<double, double>> enc;
+        encryptor.encrypt_sequence(a, enc);
+        encryptor.decrypt_sequence(enc, ra);
+    });
+    std::thread tb([&] {
+        std::vector<std::pair<double, double>> enc;
+        encryptor.encrypt_sequence(b, enc);
+        encryptor.decrypt_sequence(enc, rb);
+    });
+    ta.join();
+    tb.join();
+    EXPECT_TRUE(vectors_equal(a, ra));
+    EXPECT_TRUE(vectors_equal(b, rb));
+}
+
+TEST_F(EncryptorTest, DecryptRejectsCorruptedLength) {
+    std::vector<int> input(10, 1);
+    std::vector<std::pair<double, double>> encrypted;
+    encryptor.encrypt_sequence(input, encrypted);
+    // Shift the length header far beyond the single block
+    for (auto &pr : encrypted) {
+        pr.first += 5000.0;
+    }
+    std::vector<int> decrypted;
+    EXPECT_FALSE(encryptor.decrypt_sequence(encrypted, decrypted));
+}
+
+// ============================================================================
+// Real-Input Transform Tests
+// ============================================================================
+
+TEST_F(EncryptorTest, FormatTagFollowsTransform) {
+    EXPECT_EQ(encryptor.get_transform(), Encryptor::Transform::COMPLEX);
+    EXPECT_EQ(encryptor.get_format_tag(), fvm::CODEC_FFT);
+    Encryptor real(Encryptor::Transform::REAL);
+    EXPECT_EQ(real.get_format_tag(), fvm::CODEC_FFT_REAL);
+    EXPECT_EQ(real.get_block_size(), encryptor.get_block_size());
+}
+
+TEST_F(EncryptorTest, RealTransformRoundTripAcrossBlockBoundaries) {
+    Encryptor real(Encryptor::Transform::REAL);
+    const int M = 2 * Encryptor::N;
+    for (int size : {0, 1, 2, M - 2, M - 1, M, 5 * M + 3}) {
+        std::vector<int> input(size);
+        for (int i = 0; i < size; i++) input[i] = (i * 37 + 11) % 256;
+
+        std::vector<std::pair<double, double>> encrypted;
+        std::vector<int> decrypted;
+        ASSERT_TRUE(real.encrypt_sequence(input, encrypted));
+        EXPECT_EQ(encrypted.size(), static_cast<size_t>(size / M + 1) * Encryptor::N);
+        ASSERT_TRUE(real.decrypt_sequence(encrypted, decrypted));
+        EXPECT_EQ(decrypted, input) << "size " << size;
+    }
+}
+
+TEST_F(EncryptorTest, RealTransformHalvesStoredSize) {
+    std::vector<int> input(20 * Encryptor::N - 1, 65);
+    std::vector<std::pair<double, double>> full, half;
+    ASSERT_TRUE(encryptor.encrypt_sequence(input, full));
+    ASSERT_TRUE(Encryptor(Encryptor::Transform::REAL).encrypt_sequence(input, half));
+    EXPECT_EQ(half.size() * 2, full.size());
+}
+
+TEST_F(EncryptorTest, RealTransformMatchesDirectDFT) {
+    // Pair k holds bin k of the 2N-point spectrum; pair 0 holds the real bins 0 and N
+    Encryptor real(Encryptor::Transform::REAL);
+    const int M = 2 * Encryptor::N;
+    std::vector<int> input;
+    for (int i = 0; i < 1500; i++) {
+        input.push_back((i * 53 + 7) % 256);
+    }
+    std::vector<std::pair<double, double>> encrypted;
+    ASSERT_TRUE(real.encrypt_sequence(input, encrypted));
+    ASSERT_EQ(encrypted.size(), static_cast<size_t>(Encryptor::N));
+
+    std::vector<double> block(M, 0.0);
+    block[0] = static_cast<double>(input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        block[i + 1] = input[i];
+    }
+
+    const double pi = std::acos(-1.0);
+    auto bin = [&](int k, double &re, double &im) {
+        re = im = 0;
+        for (int n = 0; n < M; n++) {
+            double ang = 2 * pi * (static_cast<long long>(k) * n % M) / M;
+            re += block[n] * std::cos(ang);
+            im += block[n] * std::sin(ang);
+        }
+    };
+
+    double re, im;
+    bin(0, re, im);
+    EXPECT_NEAR(encrypted[0].first, re, 1e-6);
+    bin(Encryptor::N, re, im);
+    EXPECT_NEAR(encrypted[0].second, re, 1e-6);
+    for (int k = 1; k < Encryptor::N; k += 37) {
+        bin(k, re, im);
+        EXPECT_NEAR(encrypted[k].first, re, 1e-6);
+        EXPECT_NEAR(encrypted[k].second, im, 1e-6);
+    }
+}
+
+TEST_F(EncryptorTest, RealTransformParallelMatchesSerial) {
+    std::vector<int> input(40 * Encryptor::N + 5);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<int>((i * 29 + 3) % 256);
+    }
+    Encryptor serial(Encryptor::Transform::REAL);
+    std::vector<std::pair<double, double>> expected;
+    ASSERT_TRUE(serial.encrypt_sequence(input, expected));
+
+    Encryptor parallel(Encryptor::Transform::REAL);
+    parallel.set_thread_count(3);
+    std::vector<std::pair<double, double>> encrypted;
+    std::vector<int> decrypted;
+    ASSERT_TRUE(parallel.encrypt_sequence(input, encrypted));
+    EXPECT_EQ(encrypted, expected);
+    ASSERT_TRUE(parallel.decrypt_sequence(encrypted, decrypted));
+    EXPECT_EQ(decrypted, input);
+}
+
+TEST_F(EncryptorTest, BytesMatchTheirSequence) {
+    std::string bytes(9 * Encryptor::N + 17, '\0');
+    for (size_t i = 0; i < bytes.size(); i++) bytes[i] = static_cast<char>((i * 31 + 7) % 256);
+    const std::vector<int> input(reinterpret_cast<const uint8_t *>(bytes.data()),
+                                 reinterpret_cast<const uint8_t *>(bytes.data()) + bytes.size());
+
+    for (Encryptor::Transform transform : {Encryptor::Transform::COMPLEX, Encryptor::Transform::REAL}) {
+        for (size_t threads : {1u, 3u}) {
+            Encryptor codec(transform);
+            codec.set_thread_count(threads);
+            std::vector<std::pair<double, double>> expected, encrypted;
+            ASSERT_TRUE(codec.encrypt_sequence(input, expected));
+            ASSERT_TRUE(codec.encrypt_bytes(bytes, encrypted));
+            EXPECT_EQ(encrypted, expected);
+
+            std::vector<uint8_t> decrypted;
+            ASSERT_TRUE(codec.decrypt_bytes(encrypted, decrypted));
+            EXPECT_EQ(std::string(decrypted.begin(), decrypted.end()), bytes);
+        }
+    }
+}
+
+// ============================================================================
+// Streaming Tests
+// ============================================================================
+
+namespace {
+    // Encrypt input through an Encoder, pushing it in pieces of the given size
+    std::vector<std::pair<double, double>> stream_encrypt(const Encryptor &encryptor,
+                                                          const std::vector<int> &input,
+                                                          size_t piece) {
+        Encryptor::Encoder encoder(encryptor, input.size());
+        std::vector<std::pair<double, double>> out(encoder.blocks() * Encryptor::N);
+        size_t consumed = 0, pulled = 0;
+        while (!encoder.done()) {
+            consumed += encoder.push(input.data() + consumed,
+                                     std::min(piece, input.size() - consumed));
+            if (encoder.ready()) {
+                EXPECT_TRUE(encoder.pull(out.data() + pulled * Encryptor::N));
+                pulled++;
+            }
+        }
+        EXPECT_EQ(consumed, input.size());
+        EXPECT_EQ(pulled, encoder.blocks());
+        return out;
+    }
+
+    // Decrypt blocks through a Decoder, pulling values in pieces of the given size
+    bool stream_decrypt(const Encryptor &encryptor,
+                        const std::vector<std::pair<double, double>> &data,
+                        size_t piece, std::vector<int> &res) {
+        Encryptor::Decoder decoder(encryptor, data.size() / Encryptor::N);
+        res.clear();
+        std::vector<int> buffer(piece);
+        for (size_t b = 0; !decoder.done(); b++) {
+            if (b * Encryptor::N >= data.size() || !decoder.push(data.data() + b * Encryptor::N)) {
+                return false;
+            }
+            size_t count;
+            while ((count = decoder.pull(buffer.data(), piece)) > 0) {
+                res.insert(res.end(), buffer.begin(), buffer.begin() + count);
+            }
+        }
+        return true;
+    }
+}
+
+TEST_F(EncryptorTest, StreamingMatchesWholeSequence) {
+    for (Encryptor::Transform transform : {Encryptor::Transform::COMPLEX, Encryptor::Transform::REAL}) {
+        Encryptor codec(transform);
+        for (int size : {0, 1, 1023, 1024, 2047, 2048, 5000}) {
+            std::vector<int> input(size);
+            for (int i = 0; i < size; i++) input[i] = (i * 13 + 5) % 256;
+
+            std::vector<std::pair<double, double>> expected;
+            ASSERT_TRUE(codec.encrypt_sequence(input, expected));
+            for (size_t piece : {1u, 7u, 1000u, 100000u}) {
+                EXPECT_EQ(stream_encrypt(codec, input, piece), expected) << "size " << size;
+
+                std::vector<int> decrypted;
+                ASSERT_TRUE(stream_decrypt(codec, expected, piece, decrypted));
+                EXPECT_EQ(decrypted, input) << "size " << size;
+            }
+        }
+    }
+}
+
+TEST_F(EncryptorTest, EncoderRefusesExtraValuesAndUnpulledBlocks) {
+    std::vector<int> input(3000, 9);
+    Encryptor::Encoder encoder(encryptor, 1500);
+    // The first block has room for N - 1 values after the header
+    EXPECT_EQ(encoder.push(input.data(), input.size()), static_cast<size_t>(Encryptor::N - 1));
+    EXPECT_EQ(encoder.push(input.data(), input.size()), 0u);
+
+    std::vector<std::pair<double, double>> out(Encryptor::N);
+    ASSERT_TRUE(encoder.pull(out.data()));
+    EXPECT_FALSE(encoder.ready());
+    EXPECT_EQ(encoder.push(input.data(), input.size()), 1500u - (Encryptor::N - 1));
+    ASSERT_TRUE(encoder.pull(out.data()));
+    EXPECT_TRUE(encoder.done());
+    EXPECT_FALSE(encoder.pull(out.data()));
+}
+
+TEST_F(EncryptorTest, DecoderRejectsCorruptedLength) {
+    std::vector<int> input(10, 1);
+    std::vector<std::pair<double, double>> encrypted;
+    encryptor.encrypt_sequence(input, encrypted);
+    for (auto &pr : encrypted) {
+        pr.first -= 5000.0;
+    }
+    Encryptor::Decoder decoder(encryptor, encrypted.size() / Encryptor::N);
+    EXPECT_FALSE(decoder.push(encrypted.data()));
+}
+
+TEST_F(EncryptorTest, DecoderRejectsLengthPastItsBlocks) {
+    // A header announcing a second block, with only the first one there
+    std::vector<int> input(Encryptor::N, 1);
+    std::vector<std::pair<double, double>> encrypted;
+    ASSERT_TRUE(encryptor.encrypt_sequence(input, encrypted));
+    ASSERT_EQ(encrypted.size(), 2u * Encryptor::N);
+
+    Encryptor::Decoder truncated(encryptor, 1);
+    EXPECT_FALSE(truncated.push(encrypted.data()));
+    Encryptor::Decoder whole(encryptor, 2);
+    EXPECT_TRUE(whole.push(encrypted.data()));
+    EXPECT_EQ(whole.length(), static_cast<long long>(Encryptor::N));
+}
+
 // ============================================================================
 // Precision and Rounding Tests
 // ============================================================================
@@ -0,0 +1,406 @@
+#ifndef FILE_SYSTEM_TEST_CPP
+#define FILE_SYSTEM_TEST_CPP
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+// FileManager, NodeManager and FileSystem are only built by including their sources,
+// so their tests share this translation unit. Saver and Logger are linked from saver.o;
+// the managers only need their interfaces
+#define LOGGER_CPP
+#define SAVER_CPP
+#include "../../lib/file_system.cpp"
+#include "../mocks/mock_logger.h"
+#include "../mocks/mock_repository.h"
+
+namespace {
+
+std::string random_text(size_t lines, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::string text;
+    for (size_t i = 0; i < lines; i++) text += "line " + std::to_string(gen()) + " of the file\n";
+    return text;
+}
+
+std::string read_range(fvm::interfaces::IContentReader& reader, size_t offset, size_t length) {
+    std::string buffer(length, '\0');
+    buffer.resize(reader.read_at(offset, &buffer[0], length));
+    return buffer;
+}
+
+std::string read_all(fvm::interfaces::IContentReader& reader, size_t step) {
+    std::string content;
+    for (size_t offset = 0; offset < reader.size(); offset += step) {
+        content += read_range(reader, offset, step);
+    }
+    return content;
+}
+
+bool write_in_pieces(fvm::interfaces::IContentWriter& writer, const std::string& content) {
+    const size_t pieces[] = {1, 7, 300, 4096};
+    for (size_t offset = 0, i = 0; offset < content.size(); offset += pieces[i++ % 4]) {
+        if (!writer.write(content.data() + offset, std::min(pieces[i % 4], content.size() - offset))) return false;
+    }
+    return true;
+}
+
+std::map<unsigned long long, unsigned long long> chunk_refs(const fvm::mocks::MockFileManagerRepository& repository) {
+    std::map<unsigned long long, unsigned long long> refs;
+    for (const auto& it : repository.chunk_index()) refs[it.first] = it.second.refs;
+    return refs;
+}
+
+} // namespace
+
+// Small chunks, so a few kilobytes already span many of them
+class FileManagerTest : public ::testing::Test {
+protected:
+    static constexpr size_t AVERAGE_CHUNK = 64;
+
+    fvm::mocks::MockLogger logger;
+    fvm::mocks::MockFileManagerRepository repository;
+    FileManager file_manager{logger, repository, AVERAGE_CHUNK};
+    const std::string text = random_text(1000, 1);
+};
+
+TEST_F(FileManagerTest, ReadAtChunkBoundariesMatchesGetContent) {
+    unsigned long long fid = file_manager.create_file(text);
+    ASSERT_TRUE(file_manager.shutdown());
+    std::string content;
+    ASSERT_TRUE(file_manager.get_content(fid, content));
+    ASSERT_EQ(content, text);
+
+    std::vector<size_t> boundaries;
+    size_t end = 0;
+    for (unsigned long long cid : repository.file(fid).chunks) {
+        end += repository.chunk_index().at(cid).size;
+        boundaries.push_back(end);
+    }
+    ASSERT_EQ(end, content.size());
+    ASSERT_GT(boundaries.size(), 10u);
+
+    // A FileManager that has not loaded any chunk yet reads them from the repository
+    FileManager fresh(logger, repository, AVERAGE_CHUNK);
+    for (FileManager* manager : {&file_manager, &fresh}) {
+        auto reader = manager->open_reader(fid);
+        ASSERT_NE(reader, nullptr);
+        ASSERT_EQ(reader->size(), content.size());
+        for (size_t boundary : boundaries) {
+            for (size_t offset : {boundary - 1, boundary, boundary + 1}) {
+                if (offset > content.size()) continue;
+                for (size_t length : {size_t(1), size_t(10), size_t(700)}) {
+                    EXPECT_EQ(read_range(*reader, offset, length), content.substr(offset, length))
+                        << "offset " << offset << " length " << length;
+                }
+            }
+        }
+        EXPECT_EQ(read_all(*reader, 97), content);
+        EXPECT_EQ(read_range(*reader, content.size(), 10), "");
+    }
+}
+
+TEST_F(FileManagerTest, GetContentDoesNotKeepChunksInMemory) {
+    unsigned long long fid = file_manager.create_file(text);
+    ASSERT_TRUE(file_manager.shutdown());
+    const size_t chunks = repository.file(fid).chunks.size();
+
+    FileManager fresh(logger, repository, AVERAGE_CHUNK);
+    for (int i = 1; i <= 2; i++) {
+        const size_t reads = repository.chunk_reads();
+        std::string content;
+        ASSERT_TRUE(fresh.get_content(fid, content));
+        EXPECT_EQ(content, text);
+        EXPECT_EQ(repository.chunk_reads() - reads, chunks) << "read " << i;
+    }
+}
+
+TEST_F(FileManagerTest, StreamedWriteMatchesCreateFile) {
+    unsigned long long created = file_manager.create_file(text);
+    ASSERT_TRUE(file_manager.shutdown());
+
+    fvm::mocks::MockFileManagerRepository other_repository;
+    FileManager other(logger, other_repository, AVERAGE_CHUNK);
+    auto writer = other.open_writer();
+    ASSERT_TRUE(write_in_pieces(*writer, text));
+    unsigned long long streamed;
+    ASSERT_TRUE(writer->commit(streamed));
+    EXPECT_FALSE(writer->write("x", 1));
+    ASSERT_TRUE(other.shutdown());
+    EXPECT_EQ(streamed, created);
+    EXPECT_EQ(other_repository.file(streamed).chunks, repository.file(created).chunks);
+
+    // The same bytes streamed into the same FileManager share the file
+    writer = file_manager.open_writer();
+    ASSERT_TRUE(write_in_pieces(*writer, text));
+    ASSERT_TRUE(writer->commit(streamed));
+    EXPECT_EQ(streamed, created);
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_EQ(repository.index().at(created), 2u);
+    EXPECT_EQ(repository.size(), 1u);
+}
+
+TEST_F(FileManagerTest, DroppedWriterLeavesChunkRefcountsUnchanged) {
+    file_manager.create_file(text);
+    ASSERT_TRUE(file_manager.shutdown());
+    const auto refs = chunk_refs(repository);
+    const size_t chunks = repository.chunk_count();
+
+    {
+        // Shares the chunks of the stored file, then spills new ones
+        auto writer = file_manager.open_writer();
+        ASSERT_TRUE(write_in_pieces(*writer, text + random_text(1000, 2)));
+        EXPECT_GT(repository.chunk_count(), chunks);
+    }
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_EQ(chunk_refs(repository), refs);
+    EXPECT_EQ(repository.chunk_count(), chunks);
+}
+
+TEST_F(FileManagerTest, WriterSpillsNewChunksBeforeCommit) {
+    const size_t writes = repository.chunk_writes();
+    auto writer = file_manager.open_writer();
+    ASSERT_TRUE(write_in_pieces(*writer, text));
+    EXPECT_GT(repository.chunk_writes(), writes);
+
+    unsigned long long fid;
+    ASSERT_TRUE(writer->commit(fid));
+    std::string content;
+    ASSERT_TRUE(file_manager.get_content(fid, content));
+    EXPECT_EQ(content, text);
+}
+
+TEST_F(FileManagerTest, RewritingAStoredFileKeepsItsChunksOnDisk) {
+    unsigned long long fid = file_manager.create_file(text);
+    ASSERT_TRUE(file_manager.shutdown());
+    const size_t chunks = repository.file(fid).chunks.size();
+
+    // Every chunk is compared against the stored one, read again each time
+    FileManager fresh(logger, repository, AVERAGE_CHUNK);
+    for (int i = 1; i <= 2; i++) {
+        const size_t reads = repository.chunk_reads();
+        auto writer = fresh.open_writer();
+        ASSERT_TRUE(write_in_pieces(*writer, text));
+        unsigned long long streamed;
+        ASSERT_TRUE(writer->commit(streamed));
+        EXPECT_EQ(streamed, fid);
+        EXPECT_GE(repository.chunk_reads() - reads, chunks) << "write " << i;
+    }
+}
+
+TEST_F(FileManagerTest, ReaderKeepsReleasedFileReadable) {
+    unsigned long long fid = file_manager.create_file(text);
+    auto reader = file_manager.open_reader(fid);
+    ASSERT_NE(reader, nullptr);
+    ASSERT_TRUE(file_manager.decrease_counter(fid));
+    EXPECT_EQ(read_all(*reader, 1000), text);
+
+    reader.reset();
+    logger.set_silent(true);
+    EXPECT_FALSE(file_manager.file_exist(fid));
+    EXPECT_EQ(file_manager.open_reader(fid), nullptr);
+}
+
+TEST_F(FileManagerTest, ReadersDoNotRewriteTheIndex) {
+    unsigned long long fid = file_manager.create_file(text);
+    ASSERT_TRUE(file_manager.shutdown());
+    const size_t saves = repository.index_saves();
+
+    for (int i = 0; i < 3; i++) {
+        auto reader = file_manager.open_reader(fid);
+        ASSERT_NE(reader, nullptr);
+        EXPECT_EQ(read_all(*reader, 4096), text);
+    }
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_EQ(repository.index_saves(), saves);
+
+    // Saved while a reader is open, the pin is not persisted
+    auto reader = file_manager.open_reader(fid);
+    ASSERT_TRUE(file_manager.increase_counter(fid));
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_EQ(repository.index().at(fid), 2u);
+
+    // A file only a reader still holds is saved unreferenced
+    ASSERT_TRUE(file_manager.decrease_counter(fid));
+    ASSERT_TRUE(file_manager.decrease_counter(fid));
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_EQ(repository.index().at(fid), 0u);
+    reader.reset();
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_FALSE(repository.has_file(fid));
+    EXPECT_EQ(repository.chunk_count(), 0u);
+}
+
+TEST_F(FileManagerTest, LoadCollectsFilesOnlyReadersHeld) {
+    unsigned long long base = file_manager.create_file(text);
+    file_manager.set_delta_revisions(64);
+    unsigned long long fid;
+    ASSERT_TRUE(file_manager.update_content(base, fid, text + "appended\n"));
+    ASSERT_TRUE(file_manager.shutdown());
+    ASSERT_TRUE(repository.file(fid).delta);
+
+    // Saved while a reader holds the last reference, then never unpinned
+    auto reader = file_manager.open_reader(fid);
+    ASSERT_TRUE(file_manager.decrease_counter(fid));
+    ASSERT_TRUE(file_manager.shutdown());
+
+    {
+        FileManager fresh(logger, repository, AVERAGE_CHUNK);
+        logger.set_silent(true);
+        EXPECT_FALSE(fresh.file_exist(fid));
+        EXPECT_FALSE(fresh.file_exist(base));
+        ASSERT_TRUE(fresh.shutdown());
+    }
+    EXPECT_TRUE(repository.index().empty());
+    EXPECT_FALSE(repository.has_file(fid));
+    EXPECT_FALSE(repository.has_file(base));
+    EXPECT_TRUE(repository.chunk_index().empty());
+    EXPECT_EQ(repository.chunk_count(), 0u);
+}
+
+class NodeManagerTest : public ::testing::Test {
+protected:
+    fvm::mocks::MockLogger logger;
+    fvm::mocks::MockFileManagerRepository file_repository;
+    fvm::mocks::MockNodeManagerRepository node_repository;
+    FileManager file_manager{logger, file_repository};
+    fvm::NodeManager node_manager{logger, file_manager, node_repository};
+};
+
+TEST_F(NodeManagerTest, UpdateContentStoresADeltaAgainstTheCurrentRevision) {
+    file_manager.set_delta_revisions(64);
+    const std::string first = random_text(1000, 4);
+    std::string second = first;
+    second.replace(second.size() / 2, 4, "edit");
+
+    unsigned long long v1 = node_manager.update_content(node_manager.get_new_node("a"), first);
+    // Keep the first revision, as a version of the tree would
+    node_manager.increase_counter(v1);
+    unsigned long long v2 = node_manager.update_content(v1, second);
+    ASSERT_NE(v2, (unsigned long long)-1);
+    ASSERT_TRUE(node_manager.shutdown());
+    ASSERT_TRUE(file_manager.shutdown());
+
+    unsigned long long old_fid = node_repository.node(v1).fid;
+    unsigned long long new_fid = node_repository.node(v2).fid;
+    ASSERT_NE(old_fid, new_fid);
+    EXPECT_FALSE(file_repository.file(old_fid).delta);
+    EXPECT_TRUE(file_repository.file(new_fid).delta);
+    EXPECT_EQ(file_repository.file(new_fid).base, old_fid);
+
+    FileManager fresh(logger, file_repository);
+    std::string content;
+    ASSERT_TRUE(fresh.get_content(new_fid, content));
+    EXPECT_EQ(content, second);
+    EXPECT_EQ(node_manager.get_content(v1), first);
+    EXPECT_EQ(node_manager.get_content(v2), second);
+}
+
+TEST_F(NodeManagerTest, LargeFilesAreStoredInFull) {
+    file_manager.set_delta_revisions(64);
+    std::string first = random_text(1, 5);
+    while (first.size() <= FileManager::MAX_DELTA_CONTENT) first += random_text(1000, first.size());
+    std::string second = first;
+    second.replace(second.size() / 2, 4, "edit");
+
+    unsigned long long v1 = node_manager.update_content(node_manager.get_new_node("a"), first);
+    unsigned long long v2 = node_manager.update_content(v1, second);
+    ASSERT_TRUE(node_manager.shutdown());
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_FALSE(file_repository.file(node_repository.node(v2).fid).delta);
+
+    // Nor is a small update of a large file a delta against it
+    unsigned long long v3 = node_manager.update_content(v2, second.substr(0, FileManager::MAX_DELTA_CONTENT / 2));
+    ASSERT_TRUE(node_manager.shutdown());
+    ASSERT_TRUE(file_manager.shutdown());
+    EXPECT_FALSE(file_repository.file(node_repository.node(v3).fid).delta);
+}
+
+class FileSystemTest : public ::testing::Test {
+protected:
+    fvm::mocks::MockLogger logger;
+    fvm::mocks::MockFileManagerRepository file_repository;
+    fvm::mocks::MockNodeManagerRepository node_repository;
+    fvm::mocks::MockVersionManagerRepository version_repository;
+    FileManager file_manager{logger, file_repository};
+    fvm::NodeManager node_manager{logger, file_manager, node_repository};
+    VersionManager version_manager{logger, node_manager, version_repository};
+    FileSystem file_system{logger, node_manager, version_manager};
+
+    std::string content_of(const std::string& name) {
+        std::string content;
+        EXPECT_TRUE(file_system.get_content(name, content)) << name;
+        return content;
+    }
+
+    std::vector<std::string> listing() {
+        std::vector<std::string> names;
+        EXPECT_TRUE(file_system.list_directory_contents(names));
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+};
+
+TEST_F(FileSystemTest, UpdatesFileAfterTheFirstInDirectory) {
+    ASSERT_TRUE(file_system.make_file("a"));
+    ASSERT_TRUE(file_system.make_file("b"));
+    ASSERT_TRUE(file_system.make_file("c"));
+    ASSERT_TRUE(file_system.update_content("a", "first"));
+
+    ASSERT_TRUE(file_system.update_content("b", "second"));
+    ASSERT_TRUE(file_system.update_content("b", "second again"));
+    ASSERT_TRUE(file_system.update_content("c", "third"));
+
+    EXPECT_EQ(content_of("a"), "first");
+    EXPECT_EQ(content_of("b"), "second again");
+    EXPECT_EQ(content_of("c"), "third");
+    EXPECT_EQ(listing(), (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST_F(FileSystemTest, FindsEntriesMadeAfterADirectory) {
+    ASSERT_TRUE(file_system.make_file("a"));
+    ASSERT_TRUE(file_system.make_dir("d"));
+    ASSERT_TRUE(file_system.make_file("b"));
+
+    EXPECT_EQ(listing(), (std::vector<std::string>{"a", "b", "d"}));
+    ASSERT_TRUE(file_system.update_content("b", "content"));
+    EXPECT_EQ(content_of("b"), "content");
+    EXPECT_EQ(content_of("a"), "");
+    EXPECT_EQ(listing(), (std::vector<std::string>{"a", "b", "d"}));
+}
+
+TEST_F(FileSystemTest, StreamsContentInAndOut) {
+    const std::string text = random_text(2000, 3);
+    ASSERT_TRUE(file_system.make_file("a"));
+    ASSERT_TRUE(file_system.make_file("b"));
+    auto writer = file_system.open_writer("b");
+    ASSERT_NE(writer, nullptr);
+    ASSERT_TRUE(write_in_pieces(*writer, text));
+    unsigned long long idx;
+    ASSERT_TRUE(writer->commit(idx));
+
+    EXPECT_EQ(content_of("b"), text);
+    auto reader = file_system.open_reader("b");
+    ASSERT_NE(reader, nullptr);
+    EXPECT_EQ(read_all(*reader, 4096), text);
+    EXPECT_EQ(file_system.open_reader("missing"), nullptr);
+}
+
+TEST_F(FileSystemTest, WriterCommitFailsAfterFileChanged) {
+    ASSERT_TRUE(file_system.make_file("a"));
+    ASSERT_TRUE(file_system.update_content("a", "before"));
+    auto writer = file_system.open_writer("a");
+    ASSERT_NE(writer, nullptr);
+    ASSERT_TRUE(writer->write("streamed", 8));
+    ASSERT_TRUE(file_system.update_content("a", "changed"));
+
+    unsigned long long idx;
+    EXPECT_FALSE(writer->commit(idx));
+    EXPECT_EQ(content_of("a"), "changed");
+
+    ASSERT_TRUE(file_system.remove_file("a"));
+    EXPECT_EQ(file_system.open_writer("a"), nullptr);
+}
+
+#endif // FILE_SYSTEM_TEST_CPP
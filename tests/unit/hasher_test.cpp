@@ -0,0 +1,82 @@
+#ifndef HASHER_TEST_CPP
+#define HASHER_TEST_CPP
+
+#include "fvm/hasher.h"
+#include "fvm/record_format.h"
+#include "fvm/saver_constants.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+class HasherTest : public ::testing::Test {
+protected:
+    static std::vector<uint8_t> pattern(size_t size) {
+        std::vector<uint8_t> res(size);
+        for (size_t i = 0; i < size; i++) res[i] = static_cast<uint8_t>(i * 31 + 7);
+        return res;
+    }
+
+    fvm::Xxh3Hasher xxh3;
+    fvm::PolynomialHasher polynomial;
+};
+
+TEST_F(HasherTest, Xxh3MatchesReferenceVectors) {
+    // Expected values from the reference XXH3_64bits(), covering every length class
+    const struct {
+        size_t size;
+        unsigned long long hash;
+    } cases[] = {
+        {0, 0x2d06800538d394c2ull},    {3, 0x15f7093b173d005cull},    {8, 0xdec6a9a43575982eull},
+        {16, 0x7e484c18d74895d0ull},   {100, 0x8c97158042fbf926ull},  {200, 0x12fdb864685f344dull},
+        {240, 0xccc7375172c41f03ull},  {241, 0x0b3b630948ce4a00ull},  {1024, 0x23bc880ebf0d29c6ull},
+        {1025, 0xc09fdfbc398c7d82ull}, {4096, 0xa3c19f8174cde0bbull},
+    };
+    std::vector<uint8_t> data = pattern(4096);
+    for (const auto& c : cases) {
+        EXPECT_EQ(xxh3.hash(data.data(), c.size), c.hash) << "size " << c.size;
+    }
+    EXPECT_EQ(xxh3.hash(std::string("NodeManager::map_relation")), 0x8cd3df154e683ee8ull);
+}
+
+TEST_F(HasherTest, IntegerSequenceHashesLikeItsBytes) {
+    for (size_t size : {0, 5, 17, 129, 241, 1000, 1024, 1025, 3000}) {
+        std::vector<uint8_t> bytes = pattern(size);
+        std::vector<int> sequence(bytes.begin(), bytes.end());
+        EXPECT_EQ(xxh3.hash(sequence), xxh3.hash(bytes.data(), bytes.size())) << "size " << size;
+        EXPECT_EQ(polynomial.hash(sequence), polynomial.hash(bytes.data(), bytes.size())) << "size " << size;
+    }
+}
+
+TEST_F(HasherTest, PolynomialMatchesOriginalRollingHash) {
+    std::string name = "FileManager::map_relation";
+    unsigned long long expected = 0;
+    for (unsigned char ch : name) {
+        expected = expected * fvm::DEFAULT_HASH_SEED + ch;
+    }
+    EXPECT_EQ(polynomial.hash(name), expected);
+}
+
+TEST_F(HasherTest, SingleByteChangeChangesHash) {
+    std::vector<uint8_t> data = pattern(5000);
+    unsigned long long original = xxh3.hash(data.data(), data.size());
+    for (size_t pos : {0, 1023, 1024, 4935, 4999}) {
+        data[pos] ^= 1;
+        EXPECT_NE(xxh3.hash(data.data(), data.size()), original) << "position " << pos;
+        data[pos] ^= 1;
+    }
+}
+
+TEST_F(HasherTest, VersionsResolveToTheirHasher) {
+    ASSERT_NE(fvm::get_hasher(fvm::HASH_POLYNOMIAL), nullptr);
+    ASSERT_NE(fvm::get_hasher(fvm::HASH_XXH3), nullptr);
+    EXPECT_EQ(fvm::get_hasher(fvm::HASH_POLYNOMIAL)->get_version(), fvm::HASH_POLYNOMIAL);
+    EXPECT_EQ(fvm::get_hasher(fvm::HASH_XXH3)->get_version(), fvm::HASH_XXH3);
+    EXPECT_EQ(fvm::get_hasher(7), nullptr);
+    EXPECT_EQ(fvm::default_hasher().get_version(), fvm::HASH_XXH3);
+
+    unsigned format = fvm::CODEC_NTT | fvm::RECORD_FLOAT32 | (fvm::HASH_XXH3 << fvm::RECORD_HASH_SHIFT);
+    EXPECT_EQ(fvm::record_hash_version(format), fvm::HASH_XXH3);
+    EXPECT_EQ(fvm::record_codec(format), fvm::CODEC_NTT);
+    EXPECT_EQ(fvm::record_hash_version(fvm::CODEC_FFT_REAL), fvm::HASH_POLYNOMIAL);
+}
+
+#endif // HASHER_TEST_CPP
@@ -0,0 +1,77 @@
+#ifndef LOAD_CACHE_TEST_CPP
+#define LOAD_CACHE_TEST_CPP
+
+#include "fvm/load_cache.h"
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace {
+
+fvm::LoadCache::Value make_record(const std::string& cell, size_t rows = 1) {
+    return std::make_shared<const fvm::interfaces::vvs>(rows, std::vector<std::string>{cell, cell});
+}
+
+} // namespace
+
+TEST(LoadCacheTest, HitsOnlyForTheSameDataHash) {
+    fvm::LoadCache cache(1 << 20);
+    cache.put(1, 100, make_record("a"));
+
+    fvm::LoadCache::Value value = cache.get(1, 100);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ((*value)[0][1], "a");
+    EXPECT_EQ(cache.get(2, 100), nullptr);
+
+    // An entry decoded from an older version of the record is dropped on sight
+    EXPECT_EQ(cache.get(1, 101), nullptr);
+    EXPECT_EQ(cache.get(1, 100), nullptr);
+
+    fvm::interfaces::LoadCacheStats stats = cache.get_stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
+
+TEST(LoadCacheTest, EvictsLeastRecentlyUsedOverCapacity) {
+    const std::string cell(100, 'x');
+    const size_t size = fvm::LoadCache::footprint(*make_record(cell));
+    fvm::LoadCache cache(3 * size);
+    cache.put(1, 10, make_record(cell));
+    cache.put(2, 20, make_record(cell));
+    cache.put(3, 30, make_record(cell));
+    ASSERT_NE(cache.get(1, 10), nullptr);
+
+    // 2 is now the least recently used
+    cache.put(4, 40, make_record(cell));
+    EXPECT_EQ(cache.get(2, 20), nullptr);
+    EXPECT_NE(cache.get(1, 10), nullptr);
+    EXPECT_NE(cache.get(3, 30), nullptr);
+    EXPECT_NE(cache.get(4, 40), nullptr);
+    EXPECT_EQ(cache.get_stats().evictions, 1u);
+    EXPECT_EQ(cache.get_stats().bytes, 3 * size);
+
+    // Shrinking evicts down to the new budget; a record bigger than all of it is not kept
+    cache.set_capacity(size);
+    EXPECT_EQ(cache.get_stats().entries, 1u);
+    EXPECT_NE(cache.get(4, 40), nullptr);
+    cache.put(5, 50, make_record(cell, 10));
+    EXPECT_EQ(cache.get(5, 50), nullptr);
+}
+
+TEST(LoadCacheTest, InvalidateAndDisabled) {
+    fvm::LoadCache cache(1 << 20);
+    cache.put(1, 10, make_record("a"));
+    cache.put(2, 20, make_record("b"));
+    cache.invalidate(1);
+    EXPECT_EQ(cache.get(1, 10), nullptr);
+    EXPECT_NE(cache.get(2, 20), nullptr);
+
+    // Capacity 0 holds nothing
+    cache.set_capacity(0);
+    EXPECT_EQ(cache.get_stats().entries, 0u);
+    cache.put(3, 30, make_record("c"));
+    EXPECT_EQ(cache.get(3, 30), nullptr);
+}
+
+#endif // LOAD_CACHE_TEST_CPP
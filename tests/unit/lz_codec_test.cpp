@@ -0,0 +1,73 @@
+#ifndef LZ_CODEC_TEST_CPP
+#define LZ_CODEC_TEST_CPP
+
+#include "fvm/lz_codec.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+const uint8_t* bytes(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+std::string source_text(size_t lines) {
+    std::mt19937 gen(1);
+    std::string text;
+    for (size_t i = 0; i < lines; i++) {
+        text += "    if (value_" + std::to_string(gen() % 50) + " > limit) return " + std::to_string(gen() % 1000) + ";\n";
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(LzCodecTest, RoundTripsCompressibleData) {
+    const std::string inputs[] = {
+        source_text(5000),
+        std::string(100000, 'a'),                 // Matches overlapping their own output
+        std::string(40, 'x') + std::string(70000, '\0') + "tail",
+        "abcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcd",
+    };
+    for (const std::string& input : inputs) {
+        std::string packed, unpacked;
+        ASSERT_TRUE(fvm::lz::compress(bytes(input), input.size(), packed));
+        EXPECT_LT(packed.size(), input.size());
+        ASSERT_TRUE(fvm::lz::decompress(bytes(packed), packed.size(), unpacked));
+        EXPECT_EQ(unpacked, input);
+    }
+
+    const std::string text = source_text(5000);
+    std::string packed;
+    ASSERT_TRUE(fvm::lz::compress(bytes(text), text.size(), packed));
+    EXPECT_LT(packed.size() * 3, text.size());
+}
+
+TEST(LzCodecTest, SkipsIncompressibleAndTinyData) {
+    std::mt19937 gen(2);
+    std::string noise(1 << 16, '\0');
+    for (auto& c : noise) c = static_cast<char>(gen());
+    std::string packed;
+    EXPECT_FALSE(fvm::lz::compress(bytes(noise), noise.size(), packed));
+    EXPECT_FALSE(fvm::lz::compress(bytes(std::string("aaaa")), 4, packed));
+}
+
+TEST(LzCodecTest, RejectsMalformedBlocks) {
+    const std::string text = source_text(200);
+    std::string packed, unpacked;
+    ASSERT_TRUE(fvm::lz::compress(bytes(text), text.size(), packed));
+
+    for (size_t cut : {size_t(1), size_t(3), packed.size() / 2, packed.size() - 2}) {
+        EXPECT_FALSE(fvm::lz::decompress(bytes(packed), packed.size() - cut, unpacked));
+    }
+    // A size that does not match what the sequences produce
+    std::string resized = packed;
+    resized[0] = static_cast<char>(resized[0] + 1);
+    EXPECT_FALSE(fvm::lz::decompress(bytes(resized), resized.size(), unpacked));
+    // An offset reaching before the start of the output
+    const std::string bad = std::string("\x08\0\0\0\x10" "a" "\x05\0", 8);
+    EXPECT_FALSE(fvm::lz::decompress(bytes(bad), bad.size(), unpacked));
+    EXPECT_TRUE(unpacked.empty());
+}
+
+#endif // LZ_CODEC_TEST_CPP
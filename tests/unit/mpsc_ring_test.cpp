@@ -0,0 +1,97 @@
+#ifndef MPSC_RING_TEST_CPP
+#define MPSC_RING_TEST_CPP
+
+#include "fvm/mpsc_ring.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MpscRingTest, CapacityRoundsUpAndFillsUp) {
+    fvm::MpscRing<int> ring(5);
+    EXPECT_EQ(ring.capacity(), 8u);
+
+    uint64_t position;
+    for (int i = 0; i < 8; i++) {
+        int value = i;
+        ASSERT_TRUE(ring.try_push(value, position));
+        EXPECT_EQ(position, static_cast<uint64_t>(i));
+    }
+    int extra = 8;
+    EXPECT_FALSE(ring.try_push(extra, position));
+    EXPECT_EQ(extra, 8);
+
+    int value;
+    ASSERT_TRUE(ring.try_pop(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(ring.try_push(extra, position));
+    EXPECT_EQ(position, 8u);
+}
+
+TEST(MpscRingTest, PopsInPositionOrder) {
+    fvm::MpscRing<std::string> ring(4);
+    EXPECT_TRUE(ring.empty());
+    std::string value;
+    EXPECT_FALSE(ring.try_pop(value));
+
+    uint64_t position;
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 3; i++) {
+            std::string s = std::to_string(round * 3 + i);
+            ASSERT_TRUE(ring.try_push(s, position));
+        }
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(ring.try_pop(value));
+            EXPECT_EQ(value, std::to_string(round * 3 + i));
+        }
+    }
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.popped(), 15u);
+    EXPECT_EQ(ring.pushed(), 15u);
+}
+
+TEST(MpscRingTest, ConcurrentProducersKeepTheirOrder) {
+    fvm::MpscRing<std::pair<int, int>> ring(64);
+    const int producers = 4, per_producer = 20000;
+    std::vector<uint64_t> positions[producers];
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < per_producer; i++) {
+                std::pair<int, int> item(p, i);
+                uint64_t position;
+                while (!ring.try_push(item, position)) {
+                    std::this_thread::yield();
+                }
+                positions[p].push_back(position);
+            }
+        });
+    }
+
+    // Items come out by position, so each producer's items stay in order
+    std::vector<int> next(producers, 0);
+    std::vector<uint64_t> popped_at[producers];
+    std::pair<int, int> item;
+    for (int received = 0; received < producers * per_producer;) {
+        uint64_t position = ring.popped();
+        if (!ring.try_pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(item.second, next[item.first]);
+        popped_at[item.first].push_back(position);
+        next[item.first]++;
+        received++;
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_TRUE(ring.empty());
+
+    // The position a push claimed is the position it was popped at
+    for (int p = 0; p < producers; p++) {
+        EXPECT_EQ(next[p], per_producer);
+        EXPECT_EQ(popped_at[p], positions[p]);
+    }
+}
+
+#endif // MPSC_RING_TEST_CPP
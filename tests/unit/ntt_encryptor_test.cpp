@@ -0,0 +1,97 @@
+#ifndef NTT_ENCRYPTOR_TEST_CPP
+#define NTT_ENCRYPTOR_TEST_CPP
+
+#include "fvm/ntt_encryptor.h"
+#include "fvm/encryptor.h"
+#include <gtest/gtest.h>
+#include <climits>
+#include <random>
+#include <vector>
+
+class NttEncryptorTest : public ::testing::Test {
+protected:
+    fvm::NttEncryptor encryptor;
+
+    void expect_round_trip(const std::vector<int>& input) {
+        std::vector<std::pair<double, double>> encrypted;
+        ASSERT_TRUE(encryptor.encrypt_sequence(input, encrypted));
+        ASSERT_EQ(encrypted.size() % encryptor.get_block_size(), 0u);
+
+        std::vector<int> decrypted;
+        ASSERT_TRUE(encryptor.decrypt_sequence(encrypted, decrypted));
+        EXPECT_EQ(decrypted, input);
+    }
+};
+
+TEST_F(NttEncryptorTest, FormatTag) {
+    EXPECT_EQ(encryptor.get_format_tag(), fvm::CODEC_NTT);
+    EXPECT_NE(encryptor.get_format_tag(), Encryptor().get_format_tag());
+}
+
+TEST_F(NttEncryptorTest, EmptyRoundTrip) {
+    expect_round_trip({});
+}
+
+TEST_F(NttEncryptorTest, RoundTripAcrossBlockBoundaries) {
+    const int M = fvm::NttEncryptor::M;
+    for (int size : {1, 255, M - 1, M, M + 1, 3 * M + 17}) {
+        std::vector<int> input(size);
+        for (int i = 0; i < size; i++) input[i] = (i * 37) % 256;
+        expect_round_trip(input);
+    }
+}
+
+TEST_F(NttEncryptorTest, RoundTripIsExactForLargeAndNegativeValues) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> dist(-static_cast<int>(fvm::NttEncryptor::P / 2),
+                                            static_cast<int>(fvm::NttEncryptor::P / 2));
+    std::vector<int> input(5000);
+    for (auto& v : input) v = dist(rng);
+    expect_round_trip(input);
+}
+
+TEST_F(NttEncryptorTest, RejectsValuesThatWouldNotDecodeBack) {
+    const int max = fvm::NttEncryptor::MAX_VALUE;
+    expect_round_trip({max, -max, max - 1, -max + 1, 0});
+
+    for (int value : {max + 1, -max - 1, INT_MAX, INT_MIN}) {
+        std::vector<std::pair<double, double>> encrypted;
+        EXPECT_FALSE(encryptor.encrypt_sequence({1, value, 2}, encrypted)) << value;
+    }
+}
+
+TEST_F(NttEncryptorTest, HalvesStoredSize) {
+    std::vector<int> input(10 * fvm::NttEncryptor::M - 1, 42);
+    std::vector<std::pair<double, double>> ntt_encrypted, fft_encrypted;
+    ASSERT_TRUE(encryptor.encrypt_sequence(input, ntt_encrypted));
+
+    Encryptor fft;
+    ASSERT_TRUE(fft.encrypt_sequence(input, fft_encrypted));
+    EXPECT_EQ(ntt_encrypted.size() * 2, fft_encrypted.size());
+}
+
+TEST_F(NttEncryptorTest, CoefficientsAreExactIntegers) {
+    std::vector<int> input(100, 200);
+    std::vector<std::pair<double, double>> encrypted;
+    ASSERT_TRUE(encryptor.encrypt_sequence(input, encrypted));
+    for (const auto& pr : encrypted) {
+        EXPECT_EQ(pr.first, static_cast<double>(static_cast<long long>(pr.first)));
+        EXPECT_LT(pr.first, fvm::NttEncryptor::P);
+        EXPECT_LT(pr.second, fvm::NttEncryptor::P);
+    }
+}
+
+TEST_F(NttEncryptorTest, DecryptRejectsForeignData) {
+    // Output of the FFT codec is not made of integer residues
+    std::vector<int> input(100, 5);
+    std::vector<std::pair<double, double>> encrypted;
+    ASSERT_TRUE(Encryptor().encrypt_sequence(input, encrypted));
+
+    std::vector<int> decrypted;
+    EXPECT_FALSE(encryptor.decrypt_sequence(encrypted, decrypted));
+
+    std::vector<std::pair<double, double>> partial(encryptor.get_block_size() - 1);
+    EXPECT_FALSE(encryptor.decrypt_sequence(partial, decrypted));
+}
+
+#endif // NTT_ENCRYPTOR_TEST_CPP
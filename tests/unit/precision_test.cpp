@@ -0,0 +1,73 @@
+#ifndef PRECISION_TEST_CPP
+#define PRECISION_TEST_CPP
+
+#include "fvm/precision.h"
+#include "fvm/record_format.h"
+#include "fvm/encryptor.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+class PrecisionTest : public ::testing::Test {
+protected:
+    static std::vector<int> text(size_t size) {
+        const std::string sample = "int main() { return 0; }\nThe quick brown fox.\n";
+        std::vector<int> res(size);
+        for (size_t i = 0; i < size; i++) res[i] = sample[i % sample.size()];
+        return res;
+    }
+
+    static std::vector<std::pair<double, double>> narrowed(const std::vector<std::pair<double, double>>& data) {
+        std::vector<std::pair<double, double>> res;
+        for (const auto& pr : data) {
+            res.push_back({static_cast<float>(pr.first), static_cast<float>(pr.second)});
+        }
+        return res;
+    }
+};
+
+TEST_F(PrecisionTest, BlocksThatFitDecodeUnchanged) {
+    for (Encryptor::Transform transform : {Encryptor::Transform::COMPLEX, Encryptor::Transform::REAL}) {
+        Encryptor encryptor(transform);
+        std::vector<int> input = text(1500);
+        std::vector<std::pair<double, double>> encrypted;
+        ASSERT_TRUE(encryptor.encrypt_sequence(input, encrypted));
+
+        const int n = encryptor.get_block_size();
+        for (size_t b = 0; b < encrypted.size() / n; b++) {
+            ASSERT_TRUE(fvm::fits_float32(encrypted.data() + b * n, n, encryptor.get_format_tag()));
+        }
+
+        std::vector<std::pair<double, double>> narrow = narrowed(encrypted);
+        std::vector<int> decrypted;
+        ASSERT_TRUE(encryptor.decrypt_sequence(narrow, decrypted));
+        EXPECT_EQ(decrypted, input);
+    }
+}
+
+TEST_F(PrecisionTest, NarrowedBlocksStillFit) {
+    Encryptor encryptor;
+    std::vector<std::pair<double, double>> encrypted;
+    ASSERT_TRUE(encryptor.encrypt_sequence(text(500), encrypted));
+    std::vector<std::pair<double, double>> narrow = narrowed(encrypted);
+    EXPECT_TRUE(fvm::fits_float32(narrow.data(), encryptor.get_block_size(), fvm::CODEC_FFT));
+}
+
+TEST_F(PrecisionTest, LargeCoefficientsDoNotFit) {
+    // Error of about 1 per coefficient is far beyond the bound
+    std::vector<std::pair<double, double>> block(16, {123456789.123, 0.0});
+    EXPECT_FALSE(fvm::fits_float32(block.data(), 16, fvm::CODEC_FFT));
+}
+
+TEST_F(PrecisionTest, NttNeedsExactValues) {
+    std::vector<std::pair<double, double>> exact(16, {4096.0, 3.0});
+    std::vector<std::pair<double, double>> residues(16, {998244351.0, 3.0});
+    EXPECT_TRUE(fvm::fits_float32(exact.data(), 16, fvm::CODEC_NTT));
+    EXPECT_FALSE(fvm::fits_float32(residues.data(), 16, fvm::CODEC_NTT));
+}
+
+TEST_F(PrecisionTest, UnknownCodecDoesNotFit) {
+    std::vector<std::pair<double, double>> block(16, {1.0, 0.0});
+    EXPECT_FALSE(fvm::fits_float32(block.data(), 16, 0x7f));
+}
+
+#endif // PRECISION_TEST_CPP
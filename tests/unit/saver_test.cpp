@@ -1,26 +1,17 @@
 #ifndef SAVER_TEST_CPP
 #define SAVER_TEST_CPP
 
+#include "../../lib/saver.cpp"
 #include "fvm/interfaces/ISaver.h"
 #include "fvm/interfaces/IEncryptor.h"
+#include "fvm/record_format.h"
+#include "fvm/storage_manager.h"
+#include "fvm/data_serializer.h"
 #include "../mocks/mock_logger.h"
 #include "../mocks/mock_file_operations.h"
 #include "../mocks/mock_encryptor.h"
 #include <gtest/gtest.h>
-
-// Factory function to create Saver instances
-extern "C" {
-    struct Saver;
-    Saver* create_test_saver(fvm::interfaces::ILogger&, fvm::interfaces::IEncryptor*, fvm::interfaces::IFileOperations*);
-    void destroy_test_saver(Saver* s);
-}
-
-// Helper to create ISaver from Saver*
-inline fvm::interfaces::ISaver* make_saver(fvm::interfaces::ILogger& logger,
-                                           fvm::interfaces::IEncryptor* encryptor,
-                                           fvm::interfaces::IFileOperations* file_ops) {
-    return create_test_saver(logger, encryptor, file_ops);
-}
+#include <memory>
 
 class SaverTest : public ::testing::Test {
 protected:
@@ -30,14 +21,14 @@ protected:
     fvm::interfaces::ISaver* saver;
 
     void SetUp() override {
-        saver = make_saver(mock_logger, &mock_encryptor, &mock_file_ops);
+        saver = new Saver(mock_logger, &mock_encryptor, &mock_file_ops);
         saver->initialize();
     }
 
     void TearDown() override {
         if (saver) {
             saver->shutdown();
-            destroy_test_saver(static_cast<Saver*>(saver));
+            delete saver;
             saver = nullptr;
         }
     }
@@ -46,9 +37,8 @@ protected:
 // ========== Lifecycle Tests ==========
 
 TEST_F(SaverTest, InitializeReturnsTrue) {
-    Saver* saver2 = make_saver(mock_logger, &mock_encryptor, &mock_file_ops);
-    EXPECT_TRUE(saver2->initialize());
-    destroy_test_saver(saver2);
+    Saver saver2(mock_logger, &mock_encryptor, &mock_file_ops);
+    EXPECT_TRUE(saver2.initialize());
 }
 
 TEST_F(SaverTest, ShutdownReturnsTrue) {
@@ -169,4 +159,156 @@ TEST_F(SaverTest, StrToUllWithNonDigitsReturnsZero) {
     EXPECT_EQ(saver->str_to_ull(invalid), 0ULL);
 }
 
+// ========== Round Trip Tests ==========
+
+/**
+ * Stores written by one Saver and read back by another over the same in-memory
+ * files, with the real codecs.
+ */
+class SaverRoundTripTest : public ::testing::Test {
+protected:
+    MockFileOperations mock_file_ops;
+    fvm::mocks::MockLogger mock_logger;
+
+    std::unique_ptr<Saver> open_saver(unsigned codec = fvm::CODEC_FFT_REAL) {
+        auto s = std::make_unique<Saver>(mock_logger, nullptr, &mock_file_ops, codec);
+        s->initialize();
+        return s;
+    }
+
+    // Format word of the record checkpointed under name
+    unsigned stored_format(const std::string& name, int block_size) {
+        fvm::StorageManager storage(mock_logger, &mock_file_ops);
+        EXPECT_TRUE(storage.load_from_file(fvm::DEFAULT_DATA_FILE, block_size));
+        fvm::DataSerializer serializer;
+        fvm::interfaces::DataHandle node = storage.retrieve(serializer.calculate_hash(name));
+        EXPECT_TRUE(node);
+        return node ? node->format : ~0u;
+    }
+
+    static fvm::interfaces::vvs repetitive_content() {
+        return {{std::string(400, 'a'), "abcabcabcabcabcabcabcabc"}, {std::string(300, 'z')}};
+    }
+
+    std::vector<std::string> wal_segments() {
+        std::vector<std::string> segments;
+        for (const auto& file : mock_file_ops.files) {
+            if (file.first.rfind(fvm::DEFAULT_WAL_FILE + std::string("."), 0) == 0) {
+                segments.push_back(file.first);
+            }
+        }
+        return segments;
+    }
+};
+
+TEST_F(SaverRoundTripTest, CompressedRecordsAreTaggedAndDecompressedOnLoad) {
+    fvm::interfaces::vvs original = repetitive_content();
+    int block_size;
+    {
+        auto writer = open_saver();
+        block_size = Encryptor(Encryptor::Transform::REAL).get_block_size();
+        ASSERT_TRUE(writer->save("key", original));
+        ASSERT_TRUE(writer->shutdown());
+    }
+
+    unsigned format = stored_format("key", block_size);
+    EXPECT_EQ(fvm::record_compression(format), fvm::COMPRESSION_LZ);
+    EXPECT_EQ(fvm::record_codec(format), fvm::CODEC_FFT_REAL);
+
+    auto reader = open_saver();
+    fvm::interfaces::vvs loaded;
+    ASSERT_TRUE(reader->load("key", loaded));
+    EXPECT_EQ(loaded, original);
+}
+
+TEST_F(SaverRoundTripTest, UncompressedRecordsLoadWithCompressionOn) {
+    fvm::interfaces::vvs original = repetitive_content();
+    int block_size;
+    {
+        auto writer = open_saver();
+        block_size = Encryptor(Encryptor::Transform::REAL).get_block_size();
+        writer->set_compression(false);
+        ASSERT_TRUE(writer->save("key", original));
+        ASSERT_TRUE(writer->shutdown());
+    }
+
+    EXPECT_EQ(fvm::record_compression(stored_format("key", block_size)), fvm::COMPRESSION_NONE);
+
+    auto reader = open_saver();
+    fvm::interfaces::vvs loaded;
+    ASSERT_TRUE(reader->load("key", loaded));
+    EXPECT_EQ(loaded, original);
+}
+
+TEST_F(SaverRoundTripTest, RecordsDecodeWithTheCodecTheyWereWrittenWith) {
+    const unsigned codecs[] = {fvm::CODEC_FFT, fvm::CODEC_NTT, fvm::CODEC_FFT_REAL};
+    for (unsigned written : codecs) {
+        for (unsigned reading : codecs) {
+            if (written == reading) continue;
+            SCOPED_TRACE("written with codec " + std::to_string(written) +
+                         ", read with codec " + std::to_string(reading));
+            mock_file_ops.clear();
+
+            fvm::interfaces::vvs original = {{"hello", "world"}, {"codec", std::to_string(written)}};
+            {
+                auto writer = open_saver(written);
+                ASSERT_TRUE(writer->save("key", original));
+                ASSERT_TRUE(writer->shutdown());
+            }
+
+            auto reader = open_saver(reading);
+            fvm::interfaces::vvs loaded;
+            ASSERT_TRUE(reader->load("key", loaded));
+            EXPECT_EQ(loaded, original);
+        }
+    }
+}
+
+TEST_F(SaverRoundTripTest, SaveAndRemoveInvalidateTheLoadCache) {
+    auto s = open_saver();
+    s->set_load_cache_capacity(1 << 20);
+
+    fvm::interfaces::vvs v1 = {{"version1"}};
+    fvm::interfaces::vvs v2 = {{"version2"}};
+    fvm::interfaces::vvs loaded;
+    ASSERT_TRUE(s->save("key", v1));
+    ASSERT_TRUE(s->load("key", loaded));
+    ASSERT_TRUE(s->load("key", loaded));
+    EXPECT_EQ(s->get_load_cache_stats().hits, 1u);
+    EXPECT_EQ(s->get_load_cache_stats().entries, 1u);
+
+    ASSERT_TRUE(s->save("key", v2));
+    EXPECT_EQ(s->get_load_cache_stats().entries, 0u);
+    ASSERT_TRUE(s->load("key", loaded));
+    EXPECT_EQ(loaded, v2);
+
+    ASSERT_TRUE(s->remove("key"));
+    EXPECT_EQ(s->get_load_cache_stats().entries, 0u);
+    EXPECT_FALSE(s->load("key", loaded));
+}
+
+TEST_F(SaverRoundTripTest, CheckpointRetiresTheWalSegmentsItCovers) {
+    fvm::interfaces::vvs original = {{"durable"}};
+    {
+        auto writer = open_saver();
+        ASSERT_TRUE(writer->save("key", original));
+        ASSERT_TRUE(writer->flush());
+
+        std::vector<std::string> logged = wal_segments();
+        ASSERT_FALSE(logged.empty());
+
+        ASSERT_TRUE(writer->checkpoint());
+        for (const auto& segment : logged) {
+            EXPECT_FALSE(mock_file_ops.file_exists(segment)) << segment;
+        }
+        EXPECT_EQ(writer->get_wal_size(), 0u);
+    }
+
+    // The checkpoint alone carries the record now
+    auto reader = open_saver();
+    fvm::interfaces::vvs loaded;
+    ASSERT_TRUE(reader->load("key", loaded));
+    EXPECT_EQ(loaded, original);
+}
+
 #endif // SAVER_TEST_CPP
@@ -2,9 +2,15 @@
 #define STORAGE_MANAGER_TEST_CPP
 
 #include "fvm/storage_manager.h"
+#include "fvm/encryptor.h"
+#include "fvm/record_format.h"
 #include "../mocks/mock_logger.h"
 #include <gtest/gtest.h>
 #include <cstdio>
+#include <filesystem>
+#include <atomic>
+#include <random>
+#include <thread>
 #include <fstream>
 
 class StorageManagerTest : public ::testing::Test {
@@ -124,6 +130,90 @@ TEST_F(StorageManagerTest, SaveAndLoadFromFile) {
     EXPECT_EQ(node.data.size(), 16);
 }
 
+TEST_F(StorageManagerTest, SaveAndLoadKeepsFormatAndExactValues) {
+    std::vector<std::pair<double, double>> data;
+    for (int i = 0; i < 16; i++) {
+        data.push_back({998244352.0 - i, 0.1 * i + 1e-9});
+    }
+    storage_manager->store(123, 456, data, 1, 1);
+    storage_manager->store(789, 456, data, 1);
+
+    ASSERT_TRUE(storage_manager->save_to_file(test_data_file));
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 16));
+
+    fvm::interfaces::DataNode node;
+    ASSERT_TRUE(storage_manager->retrieve(123, node));
+    EXPECT_EQ(node.format, 1u);
+    EXPECT_EQ(node.data, data);
+    ASSERT_TRUE(storage_manager->retrieve(789, node));
+    EXPECT_EQ(node.format, 0u);
+}
+
+TEST_F(StorageManagerTest, LoadLegacyFileWithoutFormat) {
+    std::ofstream out(test_data_file);
+    out << "123 456 1 1 2 3 4\n";
+    out.close();
+
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    fvm::interfaces::DataNode node;
+    ASSERT_TRUE(storage_manager->retrieve(123, node));
+    EXPECT_EQ(node.format, 0u);
+    EXPECT_EQ(node.data.size(), 2u);
+}
+
+TEST_F(StorageManagerTest, Float32StorageKeepsDecodedDataAndSurvivesFile) {
+    Encryptor encryptor(Encryptor::Transform::REAL);
+    std::vector<int> input(20000);
+    for (size_t i = 0; i < input.size(); i++) input[i] = "fvm storage\n"[i % 12];
+    std::vector<std::pair<double, double>> encrypted;
+    ASSERT_TRUE(encryptor.encrypt_sequence(input, encrypted));
+    const int n = encryptor.get_block_size();
+
+    storage_manager->set_float32_storage(true, n);
+    storage_manager->store(123, 456, encrypted, encrypted.size() / n, encryptor.get_format_tag());
+
+    // Held narrowed, handed out whole
+    auto raw = storage_manager->get_all_data();
+    fvm::interfaces::DataNode node;
+    ASSERT_TRUE(storage_manager->retrieve(123, node));
+    EXPECT_TRUE(node.format & fvm::RECORD_FLOAT32);
+    EXPECT_EQ(fvm::record_codec(node.format), fvm::CODEC_FFT_REAL);
+    EXPECT_EQ(node.data.size(), encrypted.size());
+    EXPECT_TRUE(node.data32.empty());
+    std::vector<int> decrypted;
+    ASSERT_TRUE(encryptor.decrypt_sequence(node.data, decrypted));
+    EXPECT_EQ(decrypted, input);
+
+    // Flagged records are narrowed again on load even with the mode off
+    ASSERT_TRUE(storage_manager->save_to_file(test_data_file));
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, n));
+    fvm::interfaces::DataNode loaded;
+    ASSERT_TRUE(storage_manager->retrieve(123, loaded));
+    EXPECT_EQ(loaded.format, node.format);
+    EXPECT_EQ(loaded.data, node.data);
+}
+
+TEST_F(StorageManagerTest, Float32StorageKeepsFailingBlocksDouble) {
+    std::vector<std::pair<double, double>> data(32, {1.0, 0.0});
+    data[3] = {123456789.123, 0.0};  // Only the first block of 16 fails the bound
+
+    storage_manager->set_float32_storage(true, 16);
+    storage_manager->store(1, 2, data, 2);
+
+    fvm::interfaces::DataNode node;
+    ASSERT_TRUE(storage_manager->retrieve(1, node));
+    EXPECT_TRUE(node.format & fvm::RECORD_FLOAT32);
+    EXPECT_EQ(node.data, data);
+
+    std::vector<std::pair<double, double>> wide(16, {123456789.123, 0.0});
+    storage_manager->store(2, 2, wide, 1);
+    ASSERT_TRUE(storage_manager->retrieve(2, node));
+    EXPECT_EQ(node.format, 0u);
+    EXPECT_EQ(node.data, wide);
+}
+
 TEST_F(StorageManagerTest, LoadFromNonExistentFileReturnsFalse) {
     // Try to load from a file that doesn't exist
     EXPECT_FALSE(storage_manager->load_from_file("nonexistent_file.chm", 16));
@@ -163,4 +253,235 @@ TEST_F(StorageManagerTest, SaveEmptyDataToFile) {
     EXPECT_EQ(storage_manager->get_all_data().size(), 0);
 }
 
+TEST_F(StorageManagerTest, CheckpointAppendsOnlyChangedRecords) {
+    std::vector<std::pair<double, double>> data = {{1.0, 2.0}, {3.0, 4.0}};
+    for (unsigned long long name = 1; name <= 50; name++) {
+        storage_manager->store(name, name * 10, data, 1);
+    }
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 1));
+    EXPECT_EQ(storage_manager->get_dirty_count(), 0u);
+    const std::streamoff base_size = std::ifstream(test_data_file, std::ios::ate).tellg();
+
+    // One update and one removal append a small section, not the whole store
+    storage_manager->store(7, 777, {{5.0, 6.0}, {7.0, 8.0}}, 1);
+    ASSERT_TRUE(storage_manager->remove(9));
+    EXPECT_EQ(storage_manager->get_dirty_count(), 2u);
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 4));
+    const std::streamoff size = std::ifstream(test_data_file, std::ios::ate).tellg();
+    EXPECT_LT(size - base_size, base_size / 10);
+
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    EXPECT_EQ(storage_manager->get_checkpoint_position(), 4u);
+    EXPECT_EQ(storage_manager->get_dirty_count(), 0u);
+    EXPECT_EQ(storage_manager->get_all_data().size(), 49u);
+    EXPECT_FALSE(storage_manager->exists(9));
+    fvm::interfaces::DataNode node;
+    ASSERT_TRUE(storage_manager->retrieve(7, node));
+    EXPECT_EQ(node.data_hash, 777u);
+    EXPECT_EQ(node.data[1].second, 8.0);
+
+    // A full checkpoint leaves one index entry per live record
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 5, true));
+    EXPECT_LT(std::ifstream(test_data_file, std::ios::ate).tellg(), size);
+}
+
+TEST_F(StorageManagerTest, UnfinishedCheckpointIsIgnored) {
+    std::vector<std::pair<double, double>> data = {{1.0, 2.0}};
+    storage_manager->store(1, 10, data, 1);
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 2));
+    const auto base_size = std::filesystem::file_size(test_data_file);
+    storage_manager->store(2, 20, data, 1);
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 3));
+
+    // A crash part way through the second checkpoint: its section without the whole footer
+    std::filesystem::resize_file(test_data_file, std::filesystem::file_size(test_data_file) - 5);
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 1));
+    EXPECT_TRUE(storage_manager->exists(1));
+    EXPECT_FALSE(storage_manager->exists(2));
+    EXPECT_EQ(storage_manager->get_checkpoint_position(), 2u);
+
+    // The next checkpoint is written over the torn tail
+    storage_manager->store(3, 30, data, 1);
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 4));
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 1));
+    EXPECT_TRUE(storage_manager->exists(1));
+    EXPECT_FALSE(storage_manager->exists(2));
+    EXPECT_TRUE(storage_manager->exists(3));
+    EXPECT_EQ(storage_manager->get_checkpoint_position(), 4u);
+    EXPECT_LT(std::filesystem::file_size(test_data_file), 3 * base_size);
+}
+
+TEST_F(StorageManagerTest, LoadDecodesRecordsOnFirstAccess) {
+    std::vector<std::pair<double, double>> data = {{1.0, 2.0}, {3.0, 4.0}};
+    storage_manager->store(1, 10, data, 1);
+    storage_manager->store(2, 20, {{5.0, 6.0}, {7.0, 8.0}}, 1);
+    ASSERT_TRUE(storage_manager->save_to_file(test_data_file));
+
+    // Flip a byte in the payload of record 1, the first one in the file
+    {
+        std::fstream file(test_data_file, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(fvm::StorageManager::FILE_HEADER_SIZE);
+        file.put('\x7f');
+    }
+
+    // Only the index is read at load time, so the damage shows up on access
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    EXPECT_TRUE(storage_manager->exists(1));
+    EXPECT_TRUE(storage_manager->exists(2));
+    fvm::interfaces::DataNode node;
+    ASSERT_TRUE(storage_manager->retrieve(2, node));
+    EXPECT_EQ(node.data_hash, 20u);
+    EXPECT_EQ(node.data[1].first, 7.0);
+    EXPECT_FALSE(storage_manager->retrieve(1, node));
+    EXPECT_EQ(mock_logger.count_at_level(fvm::interfaces::LogLevel::FATAL), 1u);
+
+    // The damaged record is still stored, so a checkpoint does not drop it behind the lookups' back
+    EXPECT_TRUE(storage_manager->exists(1));
+    EXPECT_EQ(storage_manager->get_all_data().size(), 1u);
+    storage_manager->store(3, 30, data, 1);
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 2));
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    EXPECT_TRUE(storage_manager->exists(1));
+    EXPECT_FALSE(storage_manager->retrieve(1, node));
+    EXPECT_TRUE(storage_manager->retrieve(3, node));
+
+    // Until it is removed for good
+    ASSERT_TRUE(storage_manager->remove(1));
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 3));
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    EXPECT_FALSE(storage_manager->exists(1));
+}
+
+TEST_F(StorageManagerTest, TextFileIsRewrittenAsBinary) {
+    {
+        std::ofstream out(test_data_file);
+        out << "1 10 1 1 2 3 4\n2 20 1 5 6 7 8\n#3\n~2\n";
+    }
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    EXPECT_EQ(storage_manager->get_checkpoint_position(), 3u);
+    EXPECT_TRUE(storage_manager->exists(2));
+
+    storage_manager->store(3, 30, {{9.0, 10.0}}, 1);
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, 5));
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    EXPECT_EQ(storage_manager->get_checkpoint_position(), 5u);
+    EXPECT_EQ(storage_manager->get_all_data().size(), 3u);
+    fvm::interfaces::DataNode node;
+    ASSERT_TRUE(storage_manager->retrieve(1, node));
+    EXPECT_EQ(node.data[1].second, 4.0);
+}
+
+TEST_F(StorageManagerTest, RetrieveHandleSharesTheStoredRecord) {
+    std::vector<std::pair<double, double>> data = {{1.0, 2.0}, {3.0, 4.0}};
+    fvm::interfaces::DataNode node(1, 10, data, 1);
+    const std::pair<double, double>* buffer = node.data.data();
+    storage_manager->store(std::move(node));
+
+    // The moved-in data is what the handle points at; no copy was made on either side
+    fvm::interfaces::DataHandle handle = storage_manager->retrieve(1);
+    ASSERT_NE(handle, nullptr);
+    EXPECT_EQ(handle->data.data(), buffer);
+    EXPECT_EQ(storage_manager->retrieve(1), handle);
+    EXPECT_EQ(storage_manager->retrieve(2), nullptr);
+
+    // Replacing or removing the record leaves a handle already given out unchanged
+    storage_manager->store(1, 11, {{5.0, 6.0}}, 1);
+    ASSERT_TRUE(storage_manager->remove(1));
+    EXPECT_EQ(handle->data_hash, 10u);
+    EXPECT_EQ(handle->data, data);
+}
+
+TEST_F(StorageManagerTest, ForEachVisitsEveryRecordInOrder) {
+    storage_manager->set_float32_storage(true, 2);
+    std::vector<std::pair<double, double>> data = {{1.0, 2.0}, {3.0, 4.0}};
+    for (unsigned long long name = 1; name <= 6; name++) {
+        storage_manager->store(name, name * 10, data, 1);
+    }
+    ASSERT_TRUE(storage_manager->save_to_file(test_data_file));
+
+    // Some records decoded again, some changed, the rest still on disk
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 2));
+    ASSERT_NE(storage_manager->retrieve(4), nullptr);
+    storage_manager->store(2, 22, {{5.0, 6.0}, {7.0, 8.0}}, 1);
+    storage_manager->store(7, 70, data, 1);
+
+    std::vector<unsigned long long> names;
+    storage_manager->for_each([&](const fvm::interfaces::DataNode& node) {
+        names.push_back(node.name_hash);
+        EXPECT_EQ(node.data.size(), 2u);
+        EXPECT_TRUE(node.float_blocks.empty());
+        EXPECT_EQ(node.data_hash, node.name_hash == 2 ? 22u : node.name_hash * 10);
+    });
+    EXPECT_EQ(names, std::vector<unsigned long long>({1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST_F(StorageManagerTest, ConcurrentStoreRetrieveRemoveAndCheckpoint) {
+    // Every record carries its data hash as its first value, so a torn record shows
+    auto record = [](unsigned long long data_hash) {
+        return std::vector<std::pair<double, double>>{{static_cast<double>(data_hash), 1.0}};
+    };
+    for (unsigned long long name = 1; name <= 200; name++) {
+        storage_manager->store(name, name * 10, record(name * 10), 1);
+    }
+    ASSERT_TRUE(storage_manager->save_to_file(test_data_file));
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 1));
+
+    std::atomic<int> torn{0};
+    std::atomic<int> running{8};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            for (int i = 0; i < 4000; i++) {
+                unsigned long long name = rng() % 256 + 1;
+                switch (rng() % 4) {
+                    case 0: {
+                        unsigned long long data_hash = (static_cast<unsigned long long>(t) << 20) | i;
+                        storage_manager->store(name, data_hash, record(data_hash), 1);
+                        break;
+                    }
+                    case 1:
+                        storage_manager->remove(name);
+                        break;
+                    default: {
+                        fvm::interfaces::DataHandle node = storage_manager->retrieve(name);
+                        if (node && node->data[0].first != static_cast<double>(node->data_hash)) torn++;
+                        storage_manager->exists(name);
+                    }
+                }
+            }
+            running--;
+        });
+    }
+    // Checkpoints run against the same store while it changes
+    unsigned long long position = 1;
+    while (running > 0) {
+        ASSERT_TRUE(storage_manager->checkpoint(test_data_file, ++position));
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(torn, 0);
+
+    ASSERT_TRUE(storage_manager->checkpoint(test_data_file, ++position));
+    EXPECT_EQ(storage_manager->get_dirty_count(), 0u);
+    auto expected = storage_manager->get_all_data();
+    storage_manager = std::make_unique<fvm::StorageManager>(mock_logger);
+    ASSERT_TRUE(storage_manager->load_from_file(test_data_file, 1));
+    auto loaded = storage_manager->get_all_data();
+    ASSERT_EQ(loaded.size(), expected.size());
+    for (const auto& item : expected) {
+        ASSERT_EQ(loaded.count(item.first), 1u);
+        EXPECT_EQ(loaded[item.first].data_hash, item.second.data_hash);
+        EXPECT_EQ(loaded[item.first].data, item.second.data);
+    }
+}
+
 #endif // STORAGE_MANAGER_TEST_CPP
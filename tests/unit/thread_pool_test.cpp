@@ -0,0 +1,85 @@
+#ifndef THREAD_POOL_TEST_CPP
+#define THREAD_POOL_TEST_CPP
+
+#include "fvm/thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+    fvm::ThreadPool pool{4};
+};
+
+TEST_F(ThreadPoolTest, SizeCountsCaller) {
+    EXPECT_EQ(pool.size(), 4u);
+    fvm::ThreadPool inline_pool(1);
+    EXPECT_EQ(inline_pool.size(), 1u);
+}
+
+TEST_F(ThreadPoolTest, EveryIndexVisitedOnce) {
+    std::vector<int> hits(1000, 0);
+    pool.parallel_for(hits.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) hits[i]++;
+    });
+    for (int h : hits) {
+        EXPECT_EQ(h, 1);
+    }
+}
+
+TEST_F(ThreadPoolTest, GrainKeepsSmallLoopsInline) {
+    std::atomic<int> calls{0};
+    pool.parallel_for(10, 100, [&](size_t begin, size_t end) {
+        EXPECT_EQ(begin, 0u);
+        EXPECT_EQ(end, 10u);
+        calls++;
+    });
+    EXPECT_EQ(calls.load(), 1);
+}
+
+TEST_F(ThreadPoolTest, EmptyLoopDoesNothing) {
+    bool called = false;
+    pool.parallel_for(0, 1, [&](size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST_F(ThreadPoolTest, ConcurrentCallers) {
+    std::atomic<long long> total{0};
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 4; t++) {
+        callers.emplace_back([&] {
+            pool.parallel_for(500, 10, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) total += static_cast<long long>(i);
+            });
+        });
+    }
+    for (auto &c : callers) c.join();
+    EXPECT_EQ(total.load(), 4LL * (499LL * 500 / 2));
+}
+
+TEST_F(ThreadPoolTest, ExceptionReachesCallerAfterAllRanges) {
+    std::atomic<size_t> finished{0};
+    EXPECT_THROW(pool.parallel_for(1000, 1, [&](size_t begin, size_t end) {
+        if (begin <= 700 && 700 < end) throw std::runtime_error("range failed");
+        finished += end - begin;
+    }), std::runtime_error);
+    EXPECT_GT(finished.load(), 0u);
+    EXPECT_LT(finished.load(), 1000u);
+
+    // Nor does one from the range the caller runs itself
+    EXPECT_THROW(pool.parallel_for(1000, 1, [&](size_t begin, size_t) {
+        if (begin == 0) throw std::runtime_error("range failed");
+    }), std::runtime_error);
+
+    // The pool stays usable
+    std::atomic<size_t> visited{0};
+    pool.parallel_for(1000, 1, [&](size_t begin, size_t end) { visited += end - begin; });
+    EXPECT_EQ(visited.load(), 1000u);
+}
+
+TEST_F(ThreadPoolTest, DefaultThreadCountIsPositive) {
+    EXPECT_GE(fvm::ThreadPool::default_thread_count(), 1u);
+}
+
+#endif // THREAD_POOL_TEST_CPP
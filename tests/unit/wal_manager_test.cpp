@@ -2,10 +2,15 @@
 #define WAL_MANAGER_TEST_CPP
 
 #include "fvm/wal_manager.h"
+#include "fvm/record_format.h"
 #include "../mocks/mock_file_operations.h"
 #include "../mocks/mock_logger.h"
 #include <gtest/gtest.h>
 #include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <thread>
 
 class WalManagerTest : public ::testing::Test {
 protected:
@@ -21,8 +26,12 @@ protected:
 
     void TearDown() override {
         wal_manager.reset();
-        // Clean up test file
+        // Clean up test files
         std::remove(test_wal_file.c_str());
+        std::remove((test_wal_file + ".head").c_str());
+        for (uint64_t seq = 1; seq <= 32; seq++) {
+            std::remove(fvm::WalManager(test_wal_file, mock_logger).segment_path(seq).c_str());
+        }
     }
 };
 
@@ -78,6 +87,57 @@ TEST_F(WalManagerTest, LoadAndReplayInvokesCallback) {
     EXPECT_EQ(captured_hash, 789);
 }
 
+TEST_F(WalManagerTest, ReplayKeepsFormatAndAllPairs) {
+    // Use the real file system so the appended entry can be read back
+    wal_manager = std::make_unique<fvm::WalManager>(test_wal_file, mock_logger);
+
+    fvm::interfaces::WalEntry entry;
+    entry.op = fvm::interfaces::WalOperation::INSERT;
+    entry.name_hash = 321;
+    entry.data_hash = 654;
+    entry.len = 1;
+    entry.format = 1;
+    for (int i = 0; i < 40; i++) {
+        entry.data.push_back({998244352.0 - i, 0.1 * i});
+    }
+    ASSERT_TRUE(wal_manager->append_entry(entry));
+
+    wal_manager = std::make_unique<fvm::WalManager>(test_wal_file, mock_logger);
+
+    fvm::interfaces::WalEntry replayed;
+    ASSERT_TRUE(wal_manager->load_and_replay([&](const fvm::interfaces::WalEntry& e) {
+        replayed = e;
+    }));
+    EXPECT_EQ(replayed.name_hash, 321);
+    EXPECT_EQ(replayed.format, 1u);
+    EXPECT_EQ(replayed.data, entry.data);
+}
+
+TEST_F(WalManagerTest, Float32EntriesReplayAsNarrowedValues) {
+    wal_manager = std::make_unique<fvm::WalManager>(test_wal_file, mock_logger);
+    wal_manager->set_float32_storage(true, 4);
+
+    fvm::interfaces::WalEntry entry;
+    entry.op = fvm::interfaces::WalOperation::INSERT;
+    entry.name_hash = 5;
+    entry.data_hash = 6;
+    entry.len = 2;
+    entry.data = {{0.1, 0.2}, {0.3, 0.4}, {1, 2}, {3, 4},                              // Fits
+                  {123456789.123, 0}, {0, 0}, {0, 0}, {0, 0}};  // Does not
+    ASSERT_TRUE(wal_manager->append_entry(entry));
+
+    wal_manager = std::make_unique<fvm::WalManager>(test_wal_file, mock_logger);
+    fvm::interfaces::WalEntry replayed;
+    ASSERT_TRUE(wal_manager->load_and_replay([&](const fvm::interfaces::WalEntry& e) {
+        replayed = e;
+    }));
+    EXPECT_EQ(replayed.format, fvm::RECORD_FLOAT32);
+    ASSERT_EQ(replayed.data.size(), entry.data.size());
+    // Written with float precision: narrowing gives back exactly the stored float
+    EXPECT_EQ(static_cast<float>(replayed.data[0].first), 0.1f);
+    EXPECT_EQ(replayed.data[4].first, 123456789.123);
+}
+
 TEST_F(WalManagerTest, ClearWAL) {
     fvm::interfaces::WalEntry entry;
     entry.op = fvm::interfaces::WalOperation::INSERT;
@@ -155,4 +215,297 @@ TEST_F(WalManagerTest, WALOperations) {
     EXPECT_EQ(wal_manager->get_entry_count(), 3);
 }
 
+class WalManagerFileTest : public WalManagerTest {
+protected:
+    void SetUp() override {
+        // Use the real file system so appended records can be read back
+        wal_manager = std::make_unique<fvm::WalManager>(test_wal_file, mock_logger);
+    }
+
+    static fvm::interfaces::WalEntry make_entry(unsigned long long name_hash, size_t pairs) {
+        fvm::interfaces::WalEntry entry;
+        entry.op = fvm::interfaces::WalOperation::UPDATE;
+        entry.name_hash = name_hash;
+        entry.data_hash = name_hash * 7;
+        entry.len = 1;
+        for (size_t i = 0; i < pairs; i++) {
+            entry.data.push_back({i * 1.5, -0.25 * i});
+        }
+        return entry;
+    }
+
+    std::string read_wal(uint64_t segment = 1) {
+        std::ifstream in(wal_manager->segment_path(segment), std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    void write_wal(const std::string& content, uint64_t segment = 1) {
+        std::ofstream out(wal_manager->segment_path(segment), std::ios::binary | std::ios::trunc);
+        out << content;
+    }
+
+    bool segment_exists(uint64_t segment) {
+        return std::ifstream(wal_manager->segment_path(segment)).good();
+    }
+
+    std::vector<unsigned long long> replay() {
+        wal_manager = std::make_unique<fvm::WalManager>(test_wal_file, mock_logger);
+        std::vector<unsigned long long> names;
+        wal_manager->load_and_replay([&](const fvm::interfaces::WalEntry& e) {
+            names.push_back(e.name_hash);
+        });
+        return names;
+    }
+};
+
+TEST_F(WalManagerFileTest, RecordsAreRawBinary) {
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(1, 40)));
+    EXPECT_EQ(read_wal().size(), fvm::WalManager::HEADER_SIZE + 40 * 2 * sizeof(double));
+
+    fvm::interfaces::WalEntry removal;
+    removal.op = fvm::interfaces::WalOperation::DELETE;
+    removal.name_hash = 2;
+    ASSERT_TRUE(wal_manager->append_entry(removal));
+    EXPECT_EQ(read_wal().size(), 2 * fvm::WalManager::HEADER_SIZE + 40 * 2 * sizeof(double));
+}
+
+TEST_F(WalManagerFileTest, ReplayStopsAtTornRecord) {
+    for (unsigned long long i = 1; i <= 3; i++) {
+        ASSERT_TRUE(wal_manager->append_entry(make_entry(i, 10)));
+    }
+    std::string content = read_wal();
+
+    // Cut inside the payload, then inside the header, of the last record
+    write_wal(content.substr(0, content.size() - 5));
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{1, 2}));
+
+    write_wal(content.substr(0, content.size() * 2 / 3 + 10));
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{1, 2}));
+}
+
+TEST_F(WalManagerFileTest, ReplayStopsAtChecksumMismatch) {
+    for (unsigned long long i = 1; i <= 3; i++) {
+        ASSERT_TRUE(wal_manager->append_entry(make_entry(i, 10)));
+    }
+    std::string content = read_wal();
+    const size_t record_size = content.size() / 3;
+    content[record_size + fvm::WalManager::HEADER_SIZE + 3] ^= 0x10;  // Payload of the second record
+    write_wal(content);
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{1}));
+}
+
+TEST_F(WalManagerFileTest, DamagedTailDoesNotHideLaterAppends) {
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(1, 10)));
+    std::string content = read_wal();
+    write_wal(content.substr(0, 20));
+    EXPECT_TRUE(replay().empty());
+
+    // New records go to a new segment, so they are not hidden behind the torn bytes
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(4, 10)));
+    EXPECT_EQ(read_wal(2).size(), fvm::WalManager::HEADER_SIZE + 10 * 2 * sizeof(double));
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{4}));
+}
+
+TEST_F(WalManagerFileTest, ConcurrentAppendsAreAllCommitted) {
+    wal_manager->set_sync_policy(fvm::interfaces::WalSyncPolicy::PER_COMMIT);
+    const int threads = 8, per_thread = 50;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; i++) {
+                EXPECT_TRUE(wal_manager->append_entry(make_entry(t * 1000 + i, 4)));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    EXPECT_EQ(wal_manager->get_entry_count(), static_cast<size_t>(threads * per_thread));
+
+    // Every record replays, and each thread's records keep their order
+    std::vector<unsigned long long> names = replay();
+    ASSERT_EQ(names.size(), static_cast<size_t>(threads * per_thread));
+    std::vector<int> next(threads, 0);
+    for (unsigned long long name : names) {
+        int t = static_cast<int>(name / 1000);
+        EXPECT_EQ(static_cast<int>(name % 1000), next[t]++);
+    }
+}
+
+TEST_F(WalManagerFileTest, SyncPolicyAndExplicitSync) {
+    EXPECT_EQ(wal_manager->get_sync_policy(), fvm::interfaces::WalSyncPolicy::NONE);
+    wal_manager->set_sync_policy(fvm::interfaces::WalSyncPolicy::INTERVAL, 50);
+    EXPECT_EQ(wal_manager->get_sync_policy(), fvm::interfaces::WalSyncPolicy::INTERVAL);
+
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(1, 4)));
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(2, 4)));
+    EXPECT_TRUE(wal_manager->sync());
+
+    // Appends reach the file as they commit, without closing it
+    EXPECT_EQ(read_wal().size(), 2 * (fvm::WalManager::HEADER_SIZE + 4 * 2 * sizeof(double)));
+}
+
+TEST_F(WalManagerFileTest, ClearRetiresOpenSegment) {
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(1, 4)));
+    ASSERT_TRUE(wal_manager->clear());
+    EXPECT_FALSE(segment_exists(1));
+    EXPECT_EQ(wal_manager->get_entry_count(), 0u);
+
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(2, 4)));
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{2}));
+}
+TEST_F(WalManagerFileTest, WriterThreadReplaysEverySubmission) {
+    ASSERT_TRUE(wal_manager->start_writer());
+    const int threads = 4, per_thread = 200;
+    std::vector<std::thread> workers;
+    std::vector<uint64_t> last_seq(threads, 0);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; i++) {
+                uint64_t seq = wal_manager->submit(make_entry(t * 1000 + i, 4));
+                EXPECT_GT(seq, last_seq[t]);
+                last_seq[t] = seq;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    EXPECT_EQ(wal_manager->get_entry_count(), static_cast<size_t>(threads * per_thread));
+
+    // Waiting on the last sequence number makes every submission before it durable
+    uint64_t last = *std::max_element(last_seq.begin(), last_seq.end());
+    EXPECT_EQ(last, static_cast<uint64_t>(threads * per_thread));
+    EXPECT_TRUE(wal_manager->wait(last));
+    EXPECT_EQ(read_wal().size(), threads * per_thread * (fvm::WalManager::HEADER_SIZE + 4 * 2 * sizeof(double)));
+
+    std::vector<unsigned long long> names = replay();
+    ASSERT_EQ(names.size(), static_cast<size_t>(threads * per_thread));
+    std::vector<int> next(threads, 0);
+    for (unsigned long long name : names) {
+        int t = static_cast<int>(name / 1000);
+        EXPECT_EQ(static_cast<int>(name % 1000), next[t]++);
+    }
+}
+
+TEST_F(WalManagerFileTest, WriterThreadMixesWithAppendsAndClear) {
+    ASSERT_TRUE(wal_manager->start_writer());
+    uint64_t seq = wal_manager->submit(make_entry(1, 4));
+    EXPECT_EQ(seq, 1u);
+    // append_entry queues behind the submission and returns once both are written
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(2, 4)));
+    EXPECT_EQ(read_wal().size(), 2 * (fvm::WalManager::HEADER_SIZE + 4 * 2 * sizeof(double)));
+
+    // clear() drains the queue before truncating
+    wal_manager->submit(make_entry(3, 4));
+    ASSERT_TRUE(wal_manager->clear());
+    EXPECT_TRUE(read_wal().empty());
+
+    // Stopping writes out whatever is still queued
+    wal_manager->submit(make_entry(4, 4));
+    wal_manager->stop_writer();
+    EXPECT_TRUE(wal_manager->sync());
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{4}));
+}
+
+TEST_F(WalManagerFileTest, SubmitWithoutWriterAppendsSynchronously) {
+    uint64_t seq = wal_manager->submit(make_entry(1, 4));
+    EXPECT_GT(seq, 0u);
+    EXPECT_EQ(wal_manager->get_entry_count(), 1u);
+    EXPECT_TRUE(wal_manager->wait(seq));
+
+    wal_manager->set_enabled(false);
+    EXPECT_EQ(wal_manager->submit(make_entry(1, 4)), 0u);
+    EXPECT_TRUE(wal_manager->wait(0));
+}
+
+TEST_F(WalManagerFileTest, SegmentsRollAndRetire) {
+    // Every batch fills a segment, so each append lands in a segment of its own
+    wal_manager->set_segment_size(1);
+    for (unsigned long long i = 1; i <= 3; i++) {
+        ASSERT_TRUE(wal_manager->append_entry(make_entry(i, 4)));
+        EXPECT_TRUE(segment_exists(i));
+    }
+    EXPECT_EQ(wal_manager->roll_segment(), 4u);
+    EXPECT_EQ(wal_manager->roll_segment(), 4u);  // Nothing was written to segment 4 yet
+
+    ASSERT_TRUE(wal_manager->retire_segments(3));
+    EXPECT_FALSE(segment_exists(1));
+    EXPECT_FALSE(segment_exists(2));
+    EXPECT_TRUE(segment_exists(3));
+    EXPECT_EQ(wal_manager->get_entry_count(), 1u);
+
+    // A restart finds the live segments from the head file and appends after them
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{3}));
+    EXPECT_EQ(wal_manager->get_entry_count(), 1u);
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(5, 4)));
+    EXPECT_TRUE(segment_exists(4));
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{3, 5}));
+}
+
+TEST_F(WalManagerFileTest, PreSegmentFileReplaysFirstAndRetires) {
+    std::ofstream(test_wal_file) << "1 7 70 1 3 4\n";
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(8, 4)));
+    EXPECT_EQ(replay(), (std::vector<unsigned long long>{7, 8}));
+
+    ASSERT_TRUE(wal_manager->retire_segments(wal_manager->roll_segment()));
+    EXPECT_FALSE(std::ifstream(test_wal_file).good());
+    EXPECT_TRUE(replay().empty());
+}
+
+TEST_F(WalManagerFileTest, ReplayKeepsLastEntryOfEachName) {
+    fvm::interfaces::WalEntry removal;
+    removal.op = fvm::interfaces::WalOperation::DELETE;
+    removal.name_hash = 2;
+    for (int round = 0; round < 3; round++) {
+        for (unsigned long long name = 1; name <= 3; name++) {
+            fvm::interfaces::WalEntry entry = make_entry(name, 4);
+            entry.data_hash = round;
+            ASSERT_TRUE(wal_manager->append_entry(entry));
+        }
+    }
+    ASSERT_TRUE(wal_manager->append_entry(removal));
+    ASSERT_TRUE(wal_manager->append_entry(make_entry(1, 4)));
+
+    wal_manager = std::make_unique<fvm::WalManager>(test_wal_file, mock_logger);
+    std::vector<fvm::interfaces::WalEntry> replayed;
+    wal_manager->load_and_replay([&](const fvm::interfaces::WalEntry& e) {
+        replayed.push_back(e);
+    });
+
+    // One entry per name, ordered by where each name was last written
+    ASSERT_EQ(replayed.size(), 3u);
+    EXPECT_EQ(replayed[0].name_hash, 3u);
+    EXPECT_EQ(replayed[0].data_hash, 2u);
+    EXPECT_EQ(replayed[1].name_hash, 2u);
+    EXPECT_EQ(replayed[1].op, fvm::interfaces::WalOperation::DELETE);
+    EXPECT_EQ(replayed[2].name_hash, 1u);
+    EXPECT_EQ(replayed[2].data, make_entry(1, 4).data);
+
+    // Superseded entries still count towards the log
+    EXPECT_EQ(wal_manager->get_entry_count(), 11u);
+}
+
+TEST_F(WalManagerFileTest, ParallelReplayAcrossSegments) {
+    // Enough records to spread over the replay threads, in several segments
+    wal_manager->set_segment_size(64 * 1024);
+    const unsigned long long names = 3000;
+    for (unsigned long long name = 0; name < names; name++) {
+        ASSERT_TRUE(wal_manager->append_entry(make_entry(name, 8)));
+    }
+    ASSERT_TRUE(segment_exists(3));
+
+    // Damage a record in the middle of segment 2: the rest of that segment is dropped
+    std::string content = read_wal(2);
+    const size_t record_size = fvm::WalManager::HEADER_SIZE + 8 * 2 * sizeof(double);
+    const size_t damaged = content.size() / record_size / 2;
+    content[damaged * record_size + fvm::WalManager::HEADER_SIZE] ^= 1;
+    write_wal(content, 2);
+    const size_t first_segment = read_wal(1).size() / record_size;
+    const size_t second_segment = content.size() / record_size;
+
+    std::vector<unsigned long long> replayed = replay();
+    ASSERT_EQ(replayed.size(), names - (second_segment - damaged));
+    for (size_t i = 0; i < replayed.size(); i++) {
+        size_t expected = i < first_segment + damaged ? i : i + (second_segment - damaged);
+        ASSERT_EQ(replayed[i], expected);
+    }
+}
+
 #endif // WAL_MANAGER_TEST_CPP